@@ -0,0 +1,192 @@
+#ifndef ESP_DATE_TIME_BENCH_HARNESS_H
+#define ESP_DATE_TIME_BENCH_HARNESS_H
+
+/**
+ * @file BenchHarness.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime benchmark runner, one CSV row per benchmark
+ *
+ */
+
+#include <Arduino.h>
+#include <string.h>
+#include <atomic>
+#if !defined(ARDUINO) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief Times an operation and writes a CSV row to a Print sink:
+ *
+ * name,ops,ns_per_op,cycles_per_op,allocs_per_op,stack_bytes,heap_lost
+ *
+ * cycles_per_op is from ESP.getCycleCount() on device and the TSC on x86
+ * hosts. allocs_per_op counts operator new, only on the host where the
+ * benchmark replaces it. stack_bytes is the deepest stack one call touched,
+ * by painting the stack below the caller. heap_lost is the free heap drop
+ * over all calls on device, not 0 is a leak. Empty columns are not
+ * measured on the target.
+ *
+ */
+class BenchHarness {
+ public:
+  /**
+   * @brief Stack painted below the caller, deeper use reads as this size
+   *
+   */
+#ifdef ARDUINO
+  constexpr static size_t STACK_PROBE = 2048;
+#else
+  constexpr static size_t STACK_PROBE = 8192;
+#endif
+  /**
+   * @brief Allocations counted by the replaced operator new
+   *
+   */
+  static std::atomic<uint32_t> allocs;
+
+  explicit BenchHarness(Print& _out) : out(_out) {}
+  /**
+   * @brief Write the CSV header and a comment with the target
+   *
+   */
+  void begin() {
+#if defined(ESP32)
+    out.println("# ESPDateTime benchmark, ESP32");
+#elif defined(ESP8266)
+    out.println("# ESPDateTime benchmark, ESP8266");
+#else
+    out.println("# ESPDateTime benchmark, host");
+#endif
+    out.println(
+        "name,ops,ns_per_op,cycles_per_op,allocs_per_op,stack_bytes,"
+        "heap_lost");
+  }
+  /**
+   * @brief Run op(i) for i in [0, calls), each call does opsPerCall ops
+   *
+   * @param name benchmark name, no commas
+   * @param calls number of calls
+   * @param opsPerCall operations in one call, like 8 getters
+   * @param op operation, called with the call index
+   */
+  template <typename Op>
+  void run(const char* name, const uint32_t calls, const uint32_t opsPerCall,
+           Op op) {
+    // warm up, first calls load the time zone or bind symbols
+    op(0);
+    const size_t stack = stackOf(op);
+    const uint32_t heapBefore = freeHeap();
+    const uint32_t allocsBefore = allocs.load();
+    const uint64_t cyclesStart = cycles();
+    const uint32_t startUs = micros();
+    for (uint32_t i = 0; i < calls; i++) {
+      op(i);
+    }
+    const uint32_t elapsedUs = micros() - startUs;
+    const uint64_t cyclesUsed = cycles() - cyclesStart;
+    const uint32_t allocCount = allocs.load() - allocsBefore;
+    const uint32_t heapAfter = freeHeap();
+    const double ops = (double)calls * opsPerCall;
+    char row[160];
+    int len = snprintf(row, sizeof(row), "%s,%lu,%.1f,", name,
+                       (unsigned long)(calls * opsPerCall),
+                       elapsedUs * 1000.0 / ops);
+    len += hasCycles()
+               ? snprintf(row + len, sizeof(row) - len, "%.1f,",
+                          (double)cyclesUsed / ops)
+               : snprintf(row + len, sizeof(row) - len, ",");
+    len += hasAllocs()
+               ? snprintf(row + len, sizeof(row) - len, "%.2f,",
+                          allocCount / ops)
+               : snprintf(row + len, sizeof(row) - len, ",");
+    len += snprintf(row + len, sizeof(row) - len, "%u,", (unsigned)stack);
+    if (hasHeap()) {
+      snprintf(row + len, sizeof(row) - len, "%ld",
+               (long)heapBefore - (long)heapAfter);
+    }
+    out.println(row);
+  }
+
+ private:
+  Print& out;
+
+  static bool hasCycles() {
+#if defined(ARDUINO) || defined(__x86_64__) || defined(__i386__)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  static uint64_t cycles() {
+#if defined(ARDUINO)
+    // 32 bits wrap in ~18 seconds at 240 MHz, one benchmark is shorter
+    static uint32_t last = 0;
+    static uint64_t high = 0;
+    const uint32_t now = ESP.getCycleCount();
+    high += (uint32_t)(now - last);
+    last = now;
+    return high;
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  static bool hasAllocs() {
+#ifdef ARDUINO
+    return false;
+#else
+    return true;
+#endif
+  }
+
+  static bool hasHeap() {
+#ifdef ARDUINO
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  static uint32_t freeHeap() {
+#ifdef ARDUINO
+    return ESP.getFreeHeap();
+#else
+    return 0;
+#endif
+  }
+
+  // fills the stack below the caller with a pattern, returns its low end
+  static __attribute__((noinline)) uintptr_t paintStack() {
+    volatile uint8_t buf[STACK_PROBE];
+    for (size_t i = 0; i < STACK_PROBE; i++) {
+      buf[i] = 0xA5;
+    }
+    return (uintptr_t)buf;
+  }
+
+  // a frame of its own in the painted area, even if op is inlined
+  template <typename Op>
+  static __attribute__((noinline)) void callOnce(Op& op) {
+    op(0);
+  }
+
+  // the stack grows down on all targets
+  template <typename Op>
+  static __attribute__((noinline)) size_t stackOf(Op& op) {
+    volatile uint8_t top = 0;
+    const uintptr_t low = paintStack();
+    callOnce(op);
+    const volatile uint8_t* p = (const volatile uint8_t*)low;
+    size_t clean = 0;
+    while (clean < STACK_PROBE && p[clean] == 0xA5) {
+      clean++;
+    }
+    return (size_t)((uintptr_t)&top - (low + clean));
+  }
+};
+
+#endif
@@ -0,0 +1,299 @@
+#include <Arduino.h>
+#include <vector>
+#include "BenchHarness.h"
+#include "ESPDateTime.h"
+
+constexpr char FILE_PATTERN[] = "%Y%m%d-%H";
+
+/**
+ * Micro benchmarks for the formatting, conversion and timestamp hot paths,
+ * no network needed. Runs on device, results go to Serial, and on the host
+ * with pio run -e benchnative, which builds against the minimal Arduino core
+ * in extras/native. One CSV row per benchmark, see BenchHarness.
+ *
+ * Compares reading all eight calendar fields from a cached DateTimeParts
+ * against the old behaviour of calling localtime() for every field, and
+ * the precompiled DateFormatter writers against strftime.
+ *
+ */
+
+static const time_t T_BASE = 1574985600;  // 2019-11-29 00:00:00 UTC
+#ifdef ARDUINO
+static const uint32_t ITERATIONS = 2000;
+#else
+static const uint32_t ITERATIONS = 20000;
+#endif
+static const char* TZ_CET = "CET-1CEST,M3.5.0,M10.5.0/3";
+static const TimeZoneRule ZONE_CET(TZ_CET);
+typedef FixedZone<8 * 3600> ZoneCST;
+static const TimeZoneRule ZONE_CST(ZoneCST::TIME_ZONE);
+
+volatile int sink = 0;
+
+// use the output, the formatters are inline and their stores would be
+// dropped if only the length was read
+static inline void consume(const char* buf, const size_t len) {
+  asm volatile("" : : "r"(buf) : "memory");
+  sink += (int)len;
+}
+
+std::atomic<uint32_t> BenchHarness::allocs(0);
+
+#ifndef ARDUINO
+// count heap allocations, String and std::function included
+void* operator new(size_t size) {
+  BenchHarness::allocs++;
+  void* p = malloc(size ? size : 1);
+  if (!p) {
+    abort();
+  }
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#endif
+
+static BenchHarness bench(Serial);
+
+// previous implementation: every getter converted the timestamp again
+static void benchLegacyGetters() {
+  bench.run("getters (localtime/field)", ITERATIONS, 8, [](uint32_t i) {
+    time_t ts = T_BASE + i * 37;
+    int acc = 0;
+    acc += localtime(&ts)->tm_year + 1900;
+    acc += localtime(&ts)->tm_mon;
+    acc += localtime(&ts)->tm_mday;
+    acc += localtime(&ts)->tm_hour;
+    acc += localtime(&ts)->tm_min;
+    acc += localtime(&ts)->tm_sec;
+    acc += localtime(&ts)->tm_wday;
+    acc += localtime(&ts)->tm_yday;
+    sink += acc;
+  });
+}
+
+static void benchCachedGetters() {
+  bench.run("getters (cached parts)", ITERATIONS, 8, [](uint32_t i) {
+    auto p = DateTimeParts::from(T_BASE + i * 37, ZONE_CET);
+    int acc = 0;
+    acc += p.getYear();
+    acc += p.getMonth();
+    acc += p.getMonthDay();
+    acc += p.getHours();
+    acc += p.getMinutes();
+    acc += p.getSeconds();
+    acc += p.getWeekDay();
+    acc += p.getYearDay();
+    sink += acc;
+  });
+}
+
+// converted ahead, the format rows measure only the formatting, and each
+// call gets other fields so nothing is hoisted out of the loop
+static const uint32_t SAMPLES = 64;
+static std::vector<DateTimeParts> sampleParts;
+static struct tm sampleTm[SAMPLES];
+
+static void makeSamples() {
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    sampleParts.push_back(DateTimeParts::from(T_BASE + i * 86413, ZONE_CET));
+    sampleTm[i] = sampleParts[i]._fields.toTm();
+  }
+}
+
+static void benchStrftime(const char* name, const char* fmt) {
+  bench.run(name, ITERATIONS, 1, [fmt](uint32_t i) {
+    char buf[64];
+    consume(buf, strftime(buf, sizeof(buf), fmt, &sampleTm[i % SAMPLES]));
+  });
+}
+
+template <typename F>
+static void benchBuiltin(const char* name) {
+  bench.run(name, ITERATIONS, 1, [](uint32_t i) {
+    char buf[64];
+    consume(buf, sampleParts[i % SAMPLES].formatTo<F>(buf, sizeof(buf)));
+  });
+}
+
+static void benchPartsFormat() {
+  bench.run("DateTimeParts::format", ITERATIONS, 1, [](uint32_t i) {
+    sink += sampleParts[i % SAMPLES].format(DateFormatter::ISO8601).length();
+  });
+  bench.run("DateTimeParts::formatTo", ITERATIONS, 1, [](uint32_t i) {
+    char buf[64];
+    consume(buf, sampleParts[i % SAMPLES].formatTo(buf, sizeof(buf),
+                                                   DateFormatter::ISO8601));
+  });
+}
+
+static void benchDateFormatter() {
+  bench.run("DateFormatter::format", ITERATIONS, 1, [](uint32_t i) {
+    sink += DateFormatter::format(DateFormatter::SIMPLE, T_BASE + i * 37,
+                                  TZ_CET)
+                .length();
+  });
+  bench.run("DateFormatter::format<F>", ITERATIONS, 1, [](uint32_t i) {
+    sink += DateFormatter::format<FormatSimple>(T_BASE + i * 37, TZ_CET)
+                .length();
+  });
+}
+
+static void benchGmtime() {
+  bench.run("utc fields (gmtime_r)", ITERATIONS, 1, [](uint32_t i) {
+    struct tm t;
+    time_t ts = T_BASE + i * 86413;
+    gmtime_r(&ts, &t);
+    sink += t.tm_mday;
+  });
+}
+
+static void benchCivil() {
+  bench.run("utc fields (civil)", ITERATIONS, 1, [](uint32_t i) {
+    sink += DateTimeFields::fromTime(T_BASE + i * 86413).mday;
+  });
+}
+
+static void benchLocaltime() {
+  bench.run("local fields (localtime_r)", ITERATIONS, 1, [](uint32_t i) {
+    struct tm t;
+    time_t ts = T_BASE + i * 86413;
+    localtime_r(&ts, &t);
+    sink += t.tm_hour;
+  });
+}
+
+static void benchTimeZoneRule() {
+  bench.run("local fields (TimeZoneRule)", ITERATIONS, 1, [](uint32_t i) {
+    sink += DateTimeParts::from(T_BASE + i * 86413, ZONE_CET).getHours();
+  });
+}
+
+static void benchFixedZone() {
+  bench.run("local fields (fixed TimeZoneRule)", ITERATIONS, 1,
+            [](uint32_t i) {
+              sink += DateTimeParts::from(T_BASE + i * 86413, ZONE_CST)
+                          .getHours();
+            });
+  bench.run("local fields (FixedZone)", ITERATIONS, 1, [](uint32_t i) {
+    sink += DateTimeParts::from(T_BASE + i * 86413, ZoneCST()).getHours();
+  });
+  char buf[32];
+  bench.run("ISO8601 (fixed TimeZoneRule)", ITERATIONS, 1, [&](uint32_t i) {
+    consume(buf, DateTimeParts::from(T_BASE + i * 37, ZONE_CST)
+                     .formatTo<FormatISO8601>(buf, sizeof(buf)));
+  });
+  bench.run("ISO8601 (FixedZone)", ITERATIONS, 1, [&](uint32_t i) {
+    consume(buf, DateFormatter::formatTo<FormatISO8601>(
+                     buf, sizeof(buf), T_BASE + i * 37, ZoneCST()));
+  });
+}
+
+// flushing a buffer of log records, ops are records
+static const size_t BATCH = 100;
+static time_t batchStamps[BATCH];
+static DateTimeFields batchFields[BATCH];
+static char batchRecords[BATCH * 32];
+
+static void benchBatch() {
+  for (size_t i = 0; i < BATCH; i++) {
+    batchStamps[i] = T_BASE + i * 7;
+  }
+  const uint32_t calls = ITERATIONS / BATCH;
+  bench.run("local fields (per record)", calls, BATCH, [](uint32_t) {
+    for (size_t i = 0; i < BATCH; i++) {
+      batchFields[i] = DateTimeParts::from(batchStamps[i], ZONE_CET)._fields;
+    }
+    sink += batchFields[BATCH - 1].hour;
+  });
+  bench.run("DateFormatter::toPartsBatch", calls, BATCH, [](uint32_t) {
+    DateFormatter::toPartsBatch(batchStamps, BATCH, batchFields, ZONE_CET);
+    sink += batchFields[BATCH - 1].hour;
+  });
+  // same parsed rule as the batch rows, only the batching differs
+  bench.run("ISO8601 (formatTo per record)", calls, BATCH, [](uint32_t) {
+    for (size_t i = 0; i < BATCH; i++) {
+      sink += DateTimeParts::from(batchStamps[i], ZONE_CET)
+                  .formatTo(batchRecords + i * 32, 32, DateFormatter::ISO8601);
+    }
+  });
+  bench.run("ISO8601 (formatBatch)", calls, BATCH, [](uint32_t) {
+    sink += DateFormatter::formatBatch(batchStamps, BATCH, batchRecords, 32,
+                                       DateFormatter::ISO8601, ZONE_CET);
+  });
+  bench.run("ISO8601 (formatBatch<F>)", calls, BATCH, [](uint32_t) {
+    sink += DateFormatter::formatBatch<FormatISO8601>(
+        batchStamps, BATCH, batchRecords, 32, ZONE_CET);
+  });
+}
+
+static void benchTimeZoneParse() {
+  bench.run("local fields (parse TZ)", ITERATIONS, 1, [](uint32_t i) {
+    sink += DateTimeParts::from(T_BASE + i * 86413, TZ_CET).getHours();
+  });
+}
+
+static void benchClock() {
+  bench.run("time us (gettimeofday)", ITERATIONS, 1, [](uint32_t) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    sink += (int)tv.tv_usec;
+  });
+  DateTimeClass dt(T_BASE, TZ_CET);
+  bench.run("DateTimeClass::osTime", ITERATIONS, 1,
+            [&](uint32_t) { sink += (int)dt.osTime(); });
+  bench.run("DateTimeClass::nowUs", ITERATIONS, 1,
+            [&](uint32_t) { sink += (int)dt.nowUs(); });
+  bench.run("DateTimeClass::getParts", ITERATIONS, 1,
+            [&](uint32_t) { sink += dt.getParts().getHours(); });
+}
+
+void runBenchmarks() {
+  setenv("TZ", TZ_CET, 1);
+  tzset();
+  makeSamples();
+  bench.begin();
+  benchLegacyGetters();
+  benchCachedGetters();
+  benchGmtime();
+  benchCivil();
+  benchLocaltime();
+  benchTimeZoneRule();
+  benchFixedZone();
+  benchBatch();
+  benchTimeZoneParse();
+  benchClock();
+  benchPartsFormat();
+  benchDateFormatter();
+  benchStrftime("ISO8601 (strftime)", DateFormatter::ISO8601);
+  benchBuiltin<FormatISO8601>("ISO8601 (precompiled)");
+  benchStrftime("ISO8601_MS (strftime)", DateFormatter::ISO8601_MS);
+  benchBuiltin<FormatISO8601Ms>("ISO8601_MS (precompiled)");
+  benchStrftime("HTTP (strftime)", DateFormatter::HTTP);
+  benchBuiltin<FormatHTTP>("HTTP (precompiled)");
+  benchStrftime("SIMPLE (strftime)", DateFormatter::SIMPLE);
+  benchBuiltin<FormatSimple>("SIMPLE (precompiled)");
+  benchStrftime("COMPAT (strftime)", DateFormatter::COMPAT);
+  benchBuiltin<FormatCompat>("COMPAT (precompiled)");
+  benchStrftime("DATE_ONLY (strftime)", DateFormatter::DATE_ONLY);
+  benchBuiltin<FormatDateOnly>("DATE_ONLY (precompiled)");
+  benchStrftime("TIME_ONLY (strftime)", DateFormatter::TIME_ONLY);
+  benchBuiltin<FormatTimeOnly>("TIME_ONLY (precompiled)");
+  benchStrftime("%Y%m%d-%H (strftime)", FILE_PATTERN);
+  benchBuiltin<CompiledFormat<FILE_PATTERN>>("%Y%m%d-%H (compiled)");
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(1000);
+  Serial.begin(115200);
+  runBenchmarks();
+}
+
+void loop() {}
+#else
+int main() {
+  runBenchmarks();
+  return 0;
+}
+#endif
@@ -40,6 +40,8 @@ void setupDateTime() {
   DateTime.setServer("time.pool.aliyun.com");
   DateTime.setTimeZone("CST-8");
   DateTime.begin();
+  // resync from poll(), keep the clock within 100 ms
+  DateTime.setAutoSync(true, 100);
   if (!DateTime.isTimeValid()) {
     Serial.println("Failed to get time from server.");
   } else {
@@ -62,7 +64,7 @@ void showTime() {
                 DateTime.getBootTime() + millis() / 1000);
   Serial.printf("Now    Time:   %ld\n", DateTime.now());
   Serial.printf("OS     Time:   %ld\n", DateTime.osTime());
-  Serial.printf("NTP    Time:   %ld\n", DateTime.ntpTime(2 * 1000L));
+  Serial.printf("NTP    Time:   %ld\n", DateTime.ntpTime(2 * 1000L).time);
   // Serial.println();
   Serial.printf("Local  Time:   %s\n",
                 DateTime.format(DateFormatter::SIMPLE).c_str());
@@ -102,14 +104,19 @@ void setup() {
 }
 
 void loop() {
+  // non-blocking, starts the scheduled syncs and retries with backoff
+  DateTime.poll();
   if (millis() - ms > 15 * 1000L) {
     ms = millis();
     Serial.println("--------------------");
     if (!DateTime.isTimeValid()) {
-      Serial.println("Failed to get time from server, retry.");
-      DateTime.begin();
+      Serial.printf("Failed to get time from server, retry in %lu ms.\n",
+                    DateTime.getScheduler().dueIn(millis()));
     } else {
       showTime();
+      Serial.printf("Drift:         %.2f ppm, next sync in %lu s\n",
+                    DateTime.getDriftPpm(),
+                    DateTime.getScheduler().dueIn(millis()) / 1000);
     }
   }
 }
\ No newline at end of file
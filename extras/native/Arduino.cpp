@@ -0,0 +1,108 @@
+#include "Arduino.h"
+#include <sched.h>
+#include <atomic>
+
+HardwareSerial Serial;
+
+// set up by the test before other threads run
+static NativeClock::Source source = nullptr;
+static int64_t shiftUs = 0;
+static std::atomic<bool> frozen(false);
+static std::atomic<uint64_t> frozenUs(0);
+// keeps the clock monotonic across freeze(), release() and setSource()
+static std::atomic<uint64_t> lastUs(0);
+
+static uint64_t hostMicros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  static const uint64_t startUs =
+      (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000 -
+         startUs;
+}
+
+static uint64_t sourceMicros() {
+  return source ? source() : hostMicros();
+}
+
+uint64_t NativeClock::micros64() {
+  const uint64_t us = frozen ? frozenUs.load() : sourceMicros() + shiftUs;
+  uint64_t last = lastUs.load();
+  while (us > last && !lastUs.compare_exchange_weak(last, us)) {
+  }
+  return us > last ? us : last;
+}
+
+void NativeClock::setSource(const Source _source) {
+  const uint64_t nowUs = micros64();
+  source = _source;
+  shiftUs = (int64_t)(nowUs - sourceMicros());
+}
+
+void NativeClock::freeze() {
+  frozenUs = micros64();
+  frozen = true;
+}
+
+void NativeClock::advance(const uint64_t us) {
+  if (frozen) {
+    frozenUs += us;
+  }
+}
+
+void NativeClock::release() {
+  const uint64_t nowUs = micros64();
+  frozen = false;
+  shiftUs = (int64_t)(nowUs - sourceMicros());
+}
+
+bool NativeClock::isFrozen() { return frozen; }
+
+static void sleepMicros(const uint64_t us) {
+  if (frozen) {
+    frozenUs += us;
+    return;
+  }
+  struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+  nanosleep(&ts, nullptr);
+}
+
+void delay(const unsigned long ms) { sleepMicros((uint64_t)ms * 1000); }
+
+void delayMicroseconds(const unsigned int us) { sleepMicros(us); }
+
+void yield() {
+  if (!frozen) {
+    sched_yield();
+  }
+}
+
+void configTime(const char* tz, const char*, const char*, const char*) {
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+void configTzTime(const char* tz, const char*, const char*, const char*) {
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+size_t Print::printf(const char* fmt, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, fmt);
+  const int len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len < 0) {
+    return 0;
+  }
+  return write(buf, (size_t)len < sizeof(buf) ? (size_t)len : sizeof(buf) - 1);
+}
+
+size_t HardwareSerial::write(const uint8_t c) {
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, const size_t len) {
+  return fwrite(buf, 1, len, stdout);
+}
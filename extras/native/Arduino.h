@@ -0,0 +1,113 @@
+#ifndef ESP_DATE_TIME_NATIVE_ARDUINO_H
+#define ESP_DATE_TIME_NATIVE_ARDUINO_H
+
+/**
+ * @file Arduino.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime minimal Arduino core for host builds, only the parts
+ * the library and its tests use
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <string>
+#include "NativeClock.h"
+
+// the library reads the 64-bit clock below instead of extending micros()
+#define ESP_DATE_TIME_NATIVE 1
+
+// flash strings are plain strings on the host
+#define PROGMEM
+#define PSTR(s) (s)
+#define IRAM_ATTR
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_ptr(p) (*(void* const*)(p))
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strlen_P strlen
+
+// 64-bit microseconds like the ESP8266 core, never wraps
+inline uint64_t micros64() { return NativeClock::micros64(); }
+inline unsigned long micros() { return (uint32_t)NativeClock::micros64(); }
+inline unsigned long millis() {
+  return (uint32_t)(NativeClock::micros64() / 1000);
+}
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// no sntp on the host, only the time zone is applied
+void configTime(const char* tz, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+void configTzTime(const char* tz, const char* server1,
+                  const char* server2 = nullptr,
+                  const char* server3 = nullptr);
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (len--) {
+      n += write(*buf++);
+    }
+    return n;
+  }
+  size_t write(const char* buf, size_t len) {
+    return write((const uint8_t*)buf, len);
+  }
+  size_t print(const char* s) { return write(s, strlen(s)); }
+  size_t println(const char* s = "") { return print(s) + print("\n"); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class String {
+ public:
+  String(const char* s = "") : str(s ? s : "") {}
+  bool reserve(unsigned int size) {
+    str.reserve(size);
+    return true;
+  }
+  unsigned int length() const { return (unsigned int)str.size(); }
+  const char* c_str() const { return str.c_str(); }
+  String& operator+=(const char* s) {
+    str += s;
+    return *this;
+  }
+  String& operator+=(const String& s) {
+    str += s.str;
+    return *this;
+  }
+  bool operator==(const char* s) const { return str == s; }
+  bool operator==(const String& s) const { return str == s.str; }
+  bool operator!=(const char* s) const { return str != s; }
+
+ private:
+  std::string str;
+};
+
+// writes to stdout
+class HardwareSerial : public Print {
+ public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t len) override;
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef ESP_DATE_TIME_NATIVE_CLOCK_H
+#define ESP_DATE_TIME_NATIVE_CLOCK_H
+
+/**
+ * @file NativeClock.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime clock behind millis() and micros() of host builds
+ *
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief Time since the program started, behind millis(), micros() and
+ * delay() of the native Arduino shim. Reads the host monotonic clock by
+ * default. A frozen clock only moves by advance() and delay(), so tests of
+ * timeouts and schedules run in no time and give the same result on every
+ * run. The clock never goes backwards, like the one on the chip.
+ *
+ */
+class NativeClock {
+ public:
+  /**
+   * @brief Clock function, microseconds since start
+   *
+   */
+  typedef uint64_t (*Source)();
+  /**
+   * @brief Microseconds since the program started
+   *
+   * @return uint64_t microseconds
+   */
+  static uint64_t micros64();
+  /**
+   * @brief Read the time from another function, like a simulation
+   *
+   * @param source clock function, nullptr for the host clock
+   */
+  static void setSource(Source source);
+  /**
+   * @brief Stop the clock at the current time
+   *
+   */
+  static void freeze();
+  /**
+   * @brief Move a frozen clock forward
+   *
+   * @param us microseconds
+   */
+  static void advance(const uint64_t us);
+  /**
+   * @brief Back to the host clock, which continues from the frozen time
+   *
+   */
+  static void release();
+  /**
+   * @brief Check the clock is frozen
+   *
+   * @return true if only advance() and delay() move it
+   */
+  static bool isFrozen();
+};
+
+#endif
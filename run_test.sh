@@ -1,3 +1,5 @@
 #!/bin/sh
+pio test -e native
+pio test -e nativesim
 pio test -e testnodemcuv2
 # pio test -e testnodemcu-32s
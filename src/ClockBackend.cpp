@@ -0,0 +1,206 @@
+#include "ClockBackend.h"
+#include <math.h>
+#include <stdlib.h>
+
+#if defined(ESP32) && __has_include(<esp_sntp.h>)
+#include <esp_sntp.h>
+#define ESP_DATE_TIME_SYNC_NOTIFY
+#elif defined(ESP8266) && __has_include(<coredecls.h>)
+#include <coredecls.h>
+#define ESP_DATE_TIME_SYNC_NOTIFY
+#endif
+
+#ifdef ESP_DATE_TIME_SYNC_NOTIFY
+static ClockSyncHandler systemSyncHandler = nullptr;
+static ClockSyncHandler systemChainHandler = nullptr;
+static bool systemSyncHooked = false;
+// settimeofday() of setUtcUs() in progress, not an sntp update
+static volatile bool systemSettingTime = false;
+
+static void onSystemSync() {
+  if (systemSettingTime) {
+    return;
+  }
+  if (systemSyncHandler) {
+    systemSyncHandler();
+  }
+  if (systemChainHandler) {
+    systemChainHandler();
+  }
+}
+#endif
+
+void SystemClock::setUtcUs(const int64_t utcUs) {
+#ifdef ARDUINO
+  struct timeval tv;
+  tv.tv_sec = (time_t)(utcUs / 1000000);
+  tv.tv_usec = (suseconds_t)(utcUs % 1000000);
+#ifdef ESP_DATE_TIME_SYNC_NOTIFY
+  systemSettingTime = true;
+  settimeofday(&tv, nullptr);
+  systemSettingTime = false;
+#else
+  settimeofday(&tv, nullptr);
+#endif
+#else
+  (void)utcUs;
+#endif
+}
+
+void SystemClock::configTime(const char* timeZone, const char* server1,
+                             const char* server2, const char* server3) {
+// esp8266 not support time_zone, just add seconds
+// so strftime %z always +0000
+#if defined(ESP8266)
+  ::configTime(timeZone, server1, server2, server3);
+#elif defined(ESP32)
+  configTzTime(timeZone, server1, server2, server3);
+#else
+  (void)timeZone;
+  (void)server1;
+  (void)server2;
+  (void)server3;
+#endif
+}
+
+bool SystemClock::watchSync(const ClockSyncHandler handler) {
+#ifdef ESP_DATE_TIME_SYNC_NOTIFY
+  systemSyncHandler = handler;
+  if (!systemSyncHooked) {
+    // once, configTime() runs again on every resync
+    systemSyncHooked = true;
+#if defined(ESP32)
+    sntp_set_time_sync_notification_cb(
+        [](struct timeval*) { onSystemSync(); });
+#else
+    settimeofday_cb([]() { onSystemSync(); });
+#endif
+  }
+  return true;
+#else
+  (void)handler;
+  return false;
+#endif
+}
+
+void SystemClock::chainSync(const ClockSyncHandler handler) {
+#ifdef ESP_DATE_TIME_SYNC_NOTIFY
+  systemChainHandler = handler;
+#else
+  (void)handler;
+#endif
+}
+
+// simulated device, all times in microseconds
+static int64_t simTrueUs = 0;
+static uint64_t simMonoUs = 0;
+static double simFracUs = 0;  // local clock error not yet in simMonoUs
+static double simPpm = 0;
+static bool simWallSet = false;
+static int64_t simWallUs = 0;  // system time at simWallMonoUs
+static uint64_t simWallMonoUs = 0;
+static bool simSntpReachable = true;
+static uint32_t simSntpDelayMs = 100;
+static int64_t simSntpDueUs = -1;  // true time of the next update, -1 none
+static uint32_t simSntpCount = 0;
+static ClockSyncHandler simSyncHandler = nullptr;
+static ClockSyncHandler simChainHandler = nullptr;
+
+// true time forward, the local clock runs at its own rate
+static void simStep(const uint64_t us) {
+  simTrueUs += (int64_t)us;
+  simFracUs += (double)us * simPpm * 1e-6;
+  const double whole = floor(simFracUs);
+  simFracUs -= whole;
+  simMonoUs += us + (int64_t)whole;
+}
+
+void SimulatedClock::reset(const int64_t trueUs) {
+  simTrueUs = trueUs;
+  simMonoUs = 0;
+  simFracUs = 0;
+  simPpm = 0;
+  simWallSet = false;
+  simWallUs = 0;
+  simWallMonoUs = 0;
+  simSntpReachable = true;
+  simSntpDelayMs = 100;
+  simSntpDueUs = -1;
+  simSntpCount = 0;
+}
+
+void SimulatedClock::advance(const uint64_t us) {
+  const int64_t endUs = simTrueUs + (int64_t)us;
+  while (simSntpReachable && simSntpDueUs >= 0 && simSntpDueUs <= endUs) {
+    simStep((uint64_t)(simSntpDueUs - simTrueUs));
+    setUtcUs(simTrueUs);
+    simSntpCount++;
+    simSntpDueUs = simTrueUs + (int64_t)SNTP_INTERVAL_MS * 1000;
+    if (simSyncHandler) {
+      simSyncHandler();
+    }
+    if (simChainHandler) {
+      simChainHandler();
+    }
+  }
+  simStep((uint64_t)(endUs - simTrueUs));
+}
+
+void SimulatedClock::setDriftPpm(const double ppm) { simPpm = ppm; }
+
+void SimulatedClock::setSntpReachable(const bool reachable) {
+  simSntpReachable = reachable;
+  if (reachable && simSntpDueUs >= 0 && simSntpDueUs < simTrueUs) {
+    // the waiting update goes out now
+    simSntpDueUs = simTrueUs;
+  }
+}
+
+void SimulatedClock::setSntpDelay(const uint32_t ms) { simSntpDelayMs = ms; }
+
+int64_t SimulatedClock::trueUs() { return simTrueUs; }
+
+uint32_t SimulatedClock::getSntpCount() { return simSntpCount; }
+
+uint32_t SimulatedClock::millis() { return (uint32_t)(simMonoUs / 1000); }
+
+uint32_t SimulatedClock::micros() { return (uint32_t)simMonoUs; }
+
+uint64_t SimulatedClock::millis64() { return simMonoUs / 1000; }
+
+uint64_t SimulatedClock::micros64() { return simMonoUs; }
+
+time_t SimulatedClock::time() { return (time_t)(utcUs() / 1000000); }
+
+int64_t SimulatedClock::utcUs() {
+  // counts from 0 at boot until set, like the chip
+  return simWallSet ? simWallUs + (int64_t)(simMonoUs - simWallMonoUs)
+                    : (int64_t)simMonoUs;
+}
+
+void SimulatedClock::delay(const uint32_t ms) {
+  advance((uint64_t)(ms * 1000.0 / (1 + simPpm * 1e-6) + 0.5));
+}
+
+void SimulatedClock::setUtcUs(const int64_t utcUs) {
+  simWallSet = true;
+  simWallUs = utcUs;
+  simWallMonoUs = simMonoUs;
+}
+
+void SimulatedClock::configTime(const char* timeZone, const char*,
+                                const char*, const char*) {
+  setenv("TZ", timeZone, 1);
+  tzset();
+  // the core sntp sends a request at once
+  simSntpDueUs = simTrueUs + (int64_t)simSntpDelayMs * 1000;
+}
+
+bool SimulatedClock::watchSync(const ClockSyncHandler handler) {
+  simSyncHandler = handler;
+  return true;
+}
+
+void SimulatedClock::chainSync(const ClockSyncHandler handler) {
+  simChainHandler = handler;
+}
@@ -0,0 +1,174 @@
+#ifndef ESP_DATE_TIME_CLOCK_BACKEND_H
+#define ESP_DATE_TIME_CLOCK_BACKEND_H
+
+/**
+ * @file ClockBackend.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime clocks behind DateTimeClass, selected at compile time
+ *
+ */
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <time.h>
+#include "MonoClock.h"
+
+/**
+ * @brief Function called when the system clock was set by sntp
+ *
+ */
+typedef void (*ClockSyncHandler)();
+
+/**
+ * @brief Platform clocks: millis(), micros(), the system time and the core
+ * sntp. The default ClockBackend, the inline calls compile to the same code
+ * as calling the platform directly.
+ *
+ */
+class SystemClock {
+ public:
+  static inline uint32_t millis() { return ::millis(); }
+  static inline uint32_t micros() { return ::micros(); }
+  static inline uint64_t millis64() { return MonoClock::millis64(); }
+  static inline uint64_t micros64() { return MonoClock::micros64(); }
+  static inline time_t time() { return ::time(nullptr); }
+  /**
+   * @brief System time, what sntp and settimeofday() set
+   *
+   * @return int64_t microseconds since 1970
+   */
+  static inline int64_t utcUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+  }
+  static inline void delay(const uint32_t ms) { ::delay(ms); }
+  /**
+   * @brief Set the system time, host builds never touch the system clock
+   *
+   * @param utcUs microseconds since 1970
+   */
+  static void setUtcUs(const int64_t utcUs);
+  /**
+   * @brief Start the core sntp and set the TZ rule of the libc
+   *
+   */
+  static void configTime(const char* timeZone, const char* server1,
+                         const char* server2, const char* server3);
+  /**
+   * @brief Call handler when sntp sets the system time. The core keeps one
+   * notification callback: this takes over
+   * sntp_set_time_sync_notification_cb() on ESP32 and settimeofday_cb() on
+   * ESP8266, set on the first call only. Register own callbacks with
+   * chainSync(). Updates done by setUtcUs() are not reported.
+   *
+   * @param handler sync handler
+   * @return true if the core can report it
+   */
+  static bool watchSync(ClockSyncHandler handler);
+  /**
+   * @brief Call handler after the watchSync() handler, for sketches that
+   * need the core sntp notification too
+   *
+   * @param handler sync handler, nullptr to remove
+   */
+  static void chainSync(ClockSyncHandler handler);
+};
+
+/**
+ * @brief Simulated device for soak tests on the host, build the library with
+ * -DESP_DATE_TIME_SIMULATED_CLOCK. Time only moves by advance() and
+ * delay(), so months of uptime run in seconds. The local oscillator can
+ * drift, and a simulated sntp sets the system time to the true time after
+ * configTime() and then every hour, like the core sntp. One simulated clock
+ * is shared by the whole program.
+ *
+ * Drivers of real hardware, like TimeSource and GPSTimeSource, still use
+ * micros().
+ *
+ */
+class SimulatedClock {
+ public:
+  /**
+   * @brief Interval of the sntp updates after the first one: 1 hour
+   *
+   */
+  constexpr static uint32_t SNTP_INTERVAL_MS = 3600UL * 1000;
+  /**
+   * @brief Power on: uptime 0, system time not set, no drift, sntp
+   * reachable with a 100 ms delay
+   *
+   * @param trueUs true time at power on, microseconds since 1970
+   */
+  static void reset(const int64_t trueUs);
+  /**
+   * @brief Move the true time forward, sntp updates in between happen at
+   * their time
+   *
+   * @param us microseconds of true time
+   */
+  static void advance(const uint64_t us);
+  /**
+   * @brief Frequency error of the local oscillator, from now on
+   *
+   * @param ppm parts per million, positive if the local clock runs fast
+   */
+  static void setDriftPpm(const double ppm);
+  /**
+   * @brief Make the sntp server unreachable, a pending update waits
+   *
+   * @param reachable false to drop sntp updates
+   */
+  static void setSntpReachable(const bool reachable);
+  /**
+   * @brief Time from configTime() to the sntp update
+   *
+   * @param ms milliseconds of true time
+   */
+  static void setSntpDelay(const uint32_t ms);
+  /**
+   * @brief True time, what a perfect clock shows
+   *
+   * @return int64_t microseconds since 1970
+   */
+  static int64_t trueUs();
+  /**
+   * @brief System time updates done by the simulated sntp
+   *
+   * @return uint32_t update count
+   */
+  static uint32_t getSntpCount();
+
+  // ClockBackend functions
+  static uint32_t millis();
+  static uint32_t micros();
+  static uint64_t millis64();
+  static uint64_t micros64();
+  static time_t time();
+  static int64_t utcUs();
+  /**
+   * @brief Busy waits and delays move the time
+   *
+   * @param ms milliseconds of local time
+   */
+  static void delay(const uint32_t ms);
+  static void setUtcUs(const int64_t utcUs);
+  static void configTime(const char* timeZone, const char* server1,
+                         const char* server2, const char* server3);
+  static bool watchSync(ClockSyncHandler handler);
+  static void chainSync(ClockSyncHandler handler);
+};
+
+/**
+ * @brief Clocks used by DateTimeClass, SystemClock unless the library is
+ * built with -DESP_DATE_TIME_SIMULATED_CLOCK
+ *
+ */
+#ifdef ESP_DATE_TIME_SIMULATED_CLOCK
+typedef SimulatedClock ClockBackend;
+#else
+typedef SystemClock ClockBackend;
+#endif
+
+#endif
@@ -0,0 +1,148 @@
+#include "ClockDrift.h"
+#include <math.h>
+
+static int64_t absUs(const int64_t v) { return v < 0 ? -v : v; }
+
+int64_t ClockModel::utcAt(const int64_t mono) const {
+  const int64_t elapsed = mono - monoUs;
+  int64_t remaining = slewUs;
+  if (elapsed > 0 && slewUs != 0) {
+    const int64_t done = elapsed * SLEW_PPM / 1000000;
+    if (absUs(slewUs) <= done) {
+      remaining = 0;
+    } else {
+      remaining = slewUs > 0 ? slewUs - done : slewUs + done;
+    }
+  }
+  return utcUs + elapsed + (int64_t)((double)elapsed * freq) + remaining;
+}
+
+void ClockDrift::reset() {
+  first = 0;
+  count = 0;
+  meanMono = 0;
+  meanOffset = 0;
+  spread = 0;
+  model = {0, 0, 0, 0, false};
+}
+
+const ClockDrift::Sample& ClockDrift::at(const size_t index) const {
+  return samples[(first + index) % MAX_SAMPLES];
+}
+
+int64_t ClockDrift::fittedOffset(const int64_t monoUs) const {
+  return (int64_t)(meanOffset + (double)(monoUs - meanMono) * model.freq);
+}
+
+void ClockDrift::fit() {
+  // center on the means, the products stay well inside double precision
+  const int64_t base = at(0).monoUs;
+  const int64_t baseOffset = at(0).offsetUs;
+  double sumMono = 0;
+  double sumOffset = 0;
+  for (size_t i = 0; i < count; i++) {
+    sumMono += (double)(at(i).monoUs - base);
+    sumOffset += (double)(at(i).offsetUs - baseOffset);
+  }
+  meanMono = base + (int64_t)(sumMono / count);
+  meanOffset = baseOffset + sumOffset / count;
+  spread = 0;
+  if (count < 2) {
+    // one sample gives no slope, keep the last estimate
+    return;
+  }
+  double sxx = 0;
+  double sxy = 0;
+  for (size_t i = 0; i < count; i++) {
+    const double dx = (double)(at(i).monoUs - meanMono);
+    sxx += dx * dx;
+    sxy += dx * ((double)at(i).offsetUs - meanOffset);
+  }
+  spread = sxx;
+  double freq = sxx > 0 ? sxy / sxx : 0;
+  if (freq > MAX_FREQ) {
+    freq = MAX_FREQ;
+  } else if (freq < -MAX_FREQ) {
+    freq = -MAX_FREQ;
+  }
+  model.freq = freq;
+}
+
+bool ClockDrift::addSample(const int64_t monoUs, const int64_t utcUs) {
+  const bool hadModel = model.valid;
+  const int64_t before = hadModel ? model.utcAt(monoUs) : 0;
+  const int64_t offsetUs = utcUs - monoUs;
+  if (count > 0) {
+    // reboot, or the reference moved far off the fitted line
+    const bool backwards = monoUs <= at(count - 1).monoUs;
+    const bool jumped =
+        count >= 2 && absUs(offsetUs - fittedOffset(monoUs)) >
+                           RESET_THRESHOLD_US;
+    if (backwards || jumped) {
+      first = 0;
+      count = 0;
+    }
+  }
+  if (count == MAX_SAMPLES) {
+    first = (first + 1) % MAX_SAMPLES;
+    count--;
+  }
+  samples[(first + count) % MAX_SAMPLES] = {monoUs, offsetUs};
+  count++;
+  fit();
+  const int64_t fitted = monoUs + fittedOffset(monoUs);
+  const bool step =
+      !hadModel || absUs(fitted - before) > STEP_THRESHOLD_US;
+  model.monoUs = monoUs;
+  model.utcUs = fitted;
+  // start from the old mapping and slew towards the new one
+  model.slewUs = step ? 0 : before - fitted;
+  model.valid = true;
+  return step;
+}
+
+void ClockDrift::restore(const int64_t monoUs, const int64_t utcUs,
+                         const double freq) {
+  reset();
+  double f = freq;
+  if (f > MAX_FREQ) {
+    f = MAX_FREQ;
+  } else if (f < -MAX_FREQ) {
+    f = -MAX_FREQ;
+  }
+  // a single sample keeps the frequency, so the prior survives the next sync
+  model = {monoUs, utcUs, f, 0, true};
+}
+
+int64_t ClockDrift::getResidual(const size_t index) const {
+  if (index >= count) {
+    return 0;
+  }
+  return at(index).offsetUs - fittedOffset(at(index).monoUs);
+}
+
+int64_t ClockDrift::getRmsResidual() const {
+  if (count < 3) {
+    return 0;
+  }
+  double sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    const double r = (double)getResidual(i);
+    sum += r * r;
+  }
+  return (int64_t)sqrt(sum / count);
+}
+
+double ClockDrift::getUncertaintyPpm() const {
+  if (count < 3 || spread <= 0) {
+    return UNKNOWN_PPM;
+  }
+  double sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    const double r = (double)getResidual(i);
+    sum += r * r;
+  }
+  // standard error of the slope of a least squares fit
+  const double ppm = sqrt(sum / (count - 2) / spread) * 1e6;
+  return ppm < MIN_PPM ? MIN_PPM : ppm;
+}
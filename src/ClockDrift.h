@@ -0,0 +1,169 @@
+#ifndef ESP_DATE_TIME_CLOCK_DRIFT_H
+#define ESP_DATE_TIME_CLOCK_DRIFT_H
+
+/**
+ * @file ClockDrift.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime clock drift estimation and slewing
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Maps the local monotonic clock to UTC:
+ *
+ * utc(mono) = utcUs + (mono - monoUs) * (1 + freq) + remaining slew
+ *
+ * The slew starts at slewUs and shrinks by SLEW_PPM of the elapsed time, so
+ * the mapping is continuous and strictly increasing across model updates.
+ *
+ */
+struct ClockModel {
+  /**
+   * @brief Max slew rate, like adjtime(): 500 microseconds per second
+   *
+   */
+  constexpr static int32_t SLEW_PPM = 500;
+
+  int64_t monoUs; /**< local monotonic time of the base point */
+  int64_t utcUs;  /**< fitted utc at monoUs, microseconds since 1970 */
+  double freq;    /**< local oscillator frequency error, 1e-6 is 1 ppm */
+  int64_t slewUs; /**< correction still to apply at monoUs */
+  bool valid;     /**< false until the first sample */
+
+  /**
+   * @brief UTC at a local monotonic time
+   *
+   * @param mono local monotonic time, microseconds
+   * @return int64_t microseconds since 1970
+   */
+  int64_t utcAt(const int64_t mono) const;
+};
+
+/**
+ * @brief Estimates the local oscillator frequency error from sync samples
+ * with a least squares fit of offset over time, and keeps a ClockModel that
+ * slews small corrections and steps large ones.
+ *
+ */
+class ClockDrift {
+ public:
+  /**
+   * @brief Samples kept for the fit
+   *
+   */
+  constexpr static size_t MAX_SAMPLES = 8;
+  /**
+   * @brief Corrections larger than this are stepped, like ntpd: 128 ms
+   *
+   */
+  constexpr static int64_t STEP_THRESHOLD_US = 128 * 1000;
+  /**
+   * @brief A sample this far from the prediction restarts the fit, the clock
+   * was set by other means: 1 second
+   *
+   */
+  constexpr static int64_t RESET_THRESHOLD_US = 1000 * 1000;
+  /**
+   * @brief Fitted frequency error is clamped to this: 500 ppm
+   *
+   */
+  constexpr static double MAX_FREQ = 500e-6;
+  /**
+   * @brief Frequency uncertainty before the fit has enough samples, typical
+   * crystal tolerance: 50 ppm
+   *
+   */
+  constexpr static double UNKNOWN_PPM = 50;
+  /**
+   * @brief Lower bound of the frequency uncertainty, temperature wander of
+   * a corrected crystal: 0.1 ppm
+   *
+   */
+  constexpr static double MIN_PPM = 0.1;
+
+  ClockDrift() { reset(); }
+  /**
+   * @brief Drop all samples and the model
+   *
+   */
+  void reset();
+  /**
+   * @brief Add a sync sample and refit
+   *
+   * @param monoUs local monotonic time of the sample, microseconds
+   * @param utcUs reference time at monoUs, microseconds since 1970
+   * @return true if the model was stepped, false if slewed
+   */
+  bool addSample(const int64_t monoUs, const int64_t utcUs);
+  /**
+   * @brief Drop all samples and start from a saved model, the frequency is
+   * kept as a prior until the next samples refit it
+   *
+   * @param monoUs local monotonic time, microseconds
+   * @param utcUs restored time at monoUs, microseconds since 1970
+   * @param freq saved frequency error, 1e-6 is 1 ppm
+   */
+  void restore(const int64_t monoUs, const int64_t utcUs, const double freq);
+  /**
+   * @brief Current model
+   *
+   * @return const ClockModel& model, not valid before the first sample
+   */
+  inline const ClockModel& getModel() const { return model; }
+  /**
+   * @brief Estimated frequency error in ppm, positive if the local clock is
+   * slow
+   *
+   * @return double parts per million
+   */
+  inline double getPpm() const { return model.freq * 1e6; }
+  /**
+   * @brief Number of samples in the fit
+   *
+   * @return size_t samples
+   */
+  inline size_t getCount() const { return count; }
+  /**
+   * @brief Fit residual of a sample
+   *
+   * @param index sample index, 0 is the oldest
+   * @return int64_t reference minus fitted time, microseconds
+   */
+  int64_t getResidual(const size_t index) const;
+  /**
+   * @brief Root mean square of the fit residuals
+   *
+   * @return int64_t microseconds, 0 with less than 3 samples
+   */
+  int64_t getRmsResidual() const;
+  /**
+   * @brief Standard error of the estimated frequency, how fast the corrected
+   * clock may still drift away
+   *
+   * @return double parts per million, UNKNOWN_PPM with less than 3 samples
+   */
+  double getUncertaintyPpm() const;
+
+ private:
+  struct Sample {
+    int64_t monoUs;
+    int64_t offsetUs;  // utc - mono
+  };
+  Sample samples[MAX_SAMPLES];
+  size_t first;
+  size_t count;
+  // fitted offset(mono) = meanOffset + freq * (mono - meanMono)
+  int64_t meanMono;
+  double meanOffset;
+  double spread;  // sum of squared mono deviations
+  ClockModel model;
+
+  const Sample& at(const size_t index) const;
+  int64_t fittedOffset(const int64_t monoUs) const;
+  void fit();
+};
+
+#endif
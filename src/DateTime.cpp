@@ -1,4 +1,15 @@
 #include "DateTime.h"
+#include <atomic>
+#include "DateTimeCivil.h"
+#include "DateTimeFormat.h"
+
+#if defined(ARDUINO) && defined(ESP32)
+#include <esp_sleep.h>
+#elif defined(ARDUINO) && defined(ESP8266)
+extern "C" {
+#include <user_interface.h>
+}
+#endif
 
 // static time_t getCurrentTime() {
 // need #include <chrono>
@@ -8,49 +19,345 @@
 // }
 
 static time_t validateTime(const time_t timeSecs) {
-  auto bootSecs = timeSecs - (time_t)(millis() / 1000);
+  auto bootSecs = timeSecs - (time_t)(ClockBackend::millis64() / 1000);
   return bootSecs > DateTimeClass::SECS_START_POINT ? bootSecs
                                                     : DateTimeClass::TIME_ZERO;
 }
 
+// readers use sharedOffsetAt(), prime the cache before publishing a rule
+static TimeZoneRule primedRule(const char* timeZone, const time_t timeSecs) {
+  TimeZoneRule rule(timeZone);
+  rule.offsetAt(timeSecs);
+  return rule;
+}
+
+DateTimeFields DateTimeFields::fromTm(const struct tm& t,
+                                      const int32_t offset) {
+  DateTimeFields f;
+  f.offset = offset;
+  f.year = (int16_t)(t.tm_year + 1900);
+  f.yday = (uint16_t)t.tm_yday;
+  f.month = (uint8_t)t.tm_mon;
+  f.mday = (uint8_t)t.tm_mday;
+  f.hour = (uint8_t)t.tm_hour;
+  f.minute = (uint8_t)t.tm_min;
+  f.second = (uint8_t)t.tm_sec;
+  f.wday = (uint8_t)t.tm_wday;
+  f.isdst = (int8_t)t.tm_isdst;
+  f.usec = 0;
+  return f;
+}
+
+DateTimeFields DateTimeFields::fromTime(const time_t ts, const int32_t offset,
+                                        const int8_t isdst,
+                                        const uint32_t usec) {
+  int32_t secs;
+  const int32_t days = DateTimeCivil::splitDays((int64_t)ts + offset, &secs);
+  const CivilDate date = DateTimeCivil::civilFromDays(days);
+  DateTimeFields f;
+  f.offset = offset;
+  f.year = (int16_t)date.year;
+  f.yday = (uint16_t)(days - DateTimeCivil::daysFromCivil(date.year, 1, 1));
+  f.month = (uint8_t)(date.month - 1);
+  f.mday = date.day;
+  f.hour = (uint8_t)(secs / 3600);
+  f.minute = (uint8_t)(secs / 60 % 60);
+  f.second = (uint8_t)(secs % 60);
+  f.wday = DateTimeCivil::weekDayFromDays(days);
+  f.isdst = isdst;
+  f.usec = usec;
+  return f;
+}
+
+// fields of the next local day, at the same time of day
+static void nextDay(DateTimeFields* f) {
+  f->wday = f->wday == 6 ? 0 : f->wday + 1;
+  f->yday++;
+  if (++f->mday > DateTimeCivil::daysInMonth(f->year, f->month + 1)) {
+    f->mday = 1;
+    if (++f->month == 12) {
+      f->month = 0;
+      f->year++;
+      f->yday = 0;
+    }
+  }
+}
+
+// time of day of records on one local day, no calls or branches so the
+// compiler can vectorize it
+static void splitDayBatch(const time_t* ts, const size_t n,
+                          DateTimeFields* out, const DateTimeFields& day,
+                          const int64_t midnight) {
+  for (size_t i = 0; i < n; i++) {
+    const uint32_t secs = (uint32_t)((int64_t)ts[i] - midnight);
+    DateTimeFields f = day;
+    f.hour = (uint8_t)(secs / 3600);
+    f.minute = (uint8_t)(secs / 60 % 60);
+    f.second = (uint8_t)(secs % 60);
+    out[i] = f;
+  }
+}
+
+void DateTimeFields::fromTimeBatch(const time_t* ts, const size_t n,
+                                   DateTimeFields* out, const int32_t offset,
+                                   const int8_t isdst) {
+  if (n == 0) {
+    return;
+  }
+  DateTimeFields day = fromTime(ts[0], offset, isdst);
+  // utc of the local midnight of day
+  int64_t midnight =
+      (int64_t)ts[0] - (day.hour * 3600 + day.minute * 60 + day.second);
+  size_t i = 0;
+  while (i < n) {
+    const int64_t t = (int64_t)ts[i];
+    if (t < midnight ||
+        t >= midnight + 2 * DateTimeCivil::SECS_PER_DAY) {
+      day = fromTime(ts[i], offset, isdst);
+      midnight = t - (day.hour * 3600 + day.minute * 60 + day.second);
+    } else if (t >= midnight + DateTimeCivil::SECS_PER_DAY) {
+      nextDay(&day);
+      midnight += DateTimeCivil::SECS_PER_DAY;
+    }
+    const int64_t next = midnight + DateTimeCivil::SECS_PER_DAY;
+    size_t end = i + 1;
+    while (end < n && (int64_t)ts[end] >= midnight &&
+           (int64_t)ts[end] < next) {
+      end++;
+    }
+    splitDayBatch(ts + i, end - i, out + i, day, midnight);
+    i = end;
+  }
+}
+
+struct tm DateTimeFields::toTm() const {
+  struct tm t;
+  memset(&t, 0, sizeof(t));
+  t.tm_year = year - 1900;
+  t.tm_yday = yday;
+  t.tm_mon = month;
+  t.tm_mday = mday;
+  t.tm_hour = hour;
+  t.tm_min = minute;
+  t.tm_sec = second;
+  t.tm_wday = wday;
+  t.tm_isdst = isdst;
+#if defined(__GLIBC__)
+  // glibc strftime reads %z and %Z from the struct, newlib uses tz globals
+  t.tm_gmtoff = offset;
+  t.tm_zone = tzname[isdst > 0 ? 1 : 0];
+#endif
+  return t;
+}
+
+static size_t appendTo(String& out, const char* buf, size_t len) {
+  if (len > 0) {
+    out.reserve(out.length() + len);
+    out += buf;
+  }
+  return len;
+}
+
+// %Z takes the names from the rule, only parse it for them
+static size_t strftimeIn(char* dst, size_t cap, const char* fmt,
+                         const DateTimeFields& f, const char* timeZone) {
+  if (strstr(fmt, "%Z") == nullptr) {
+    return DateTimeFormat::strftimeTo(dst, cap, fmt, f);
+  }
+  const TimeZoneRule zone(timeZone);
+  return DateTimeFormat::strftimeTo(dst, cap, fmt, f, &zone);
+}
+
+size_t DateTimeParts::formatTo(char* dst, size_t cap, const char* fmt) const {
+  int len = DateTimeFormat::formatBuiltin(dst, cap, fmt, _fields);
+  if (len >= 0) {
+    return (size_t)len;
+  }
+  return strftimeIn(dst, cap, fmt, _fields, _tz);
+}
+
+size_t DateTimeParts::formatTo(Print& out, const char* fmt) const {
+  char buf[ESP_DATE_TIME_FORMAT_BUFFER];
+  size_t len = formatTo(buf, sizeof(buf), fmt);
+  return out.write((const uint8_t*)buf, len);
+}
+
+size_t DateTimeParts::formatTo(String& out, const char* fmt) const {
+  char buf[ESP_DATE_TIME_FORMAT_BUFFER];
+  return appendTo(out, buf, formatTo(buf, sizeof(buf), fmt));
+}
+
+size_t DateTimeParts::formatUTCTo(char* dst, size_t cap,
+                                  const char* fmt) const {
+  const DateTimeFields f = DateTimeFields::fromTime(_ts, 0, 0, _fields.usec);
+  int len = DateTimeFormat::formatBuiltin(dst, cap, fmt, f);
+  if (len >= 0) {
+    return (size_t)len;
+  }
+  return strftimeIn(dst, cap, fmt, f, "GMT0");
+}
+
+size_t DateTimeParts::formatUTCTo(Print& out, const char* fmt) const {
+  char buf[ESP_DATE_TIME_FORMAT_BUFFER];
+  size_t len = formatUTCTo(buf, sizeof(buf), fmt);
+  return out.write((const uint8_t*)buf, len);
+}
+
+size_t DateTimeParts::formatUTCTo(String& out, const char* fmt) const {
+  char buf[ESP_DATE_TIME_FORMAT_BUFFER];
+  return appendTo(out, buf, formatUTCTo(buf, sizeof(buf), fmt));
+}
+
 String DateTimeParts::format(const char* fmt) const {
-  char buf[64];
-  struct tm* t = localtime(&_ts);
-  strftime(buf, sizeof(buf), fmt, t);
-  return String(buf);
+  String s;
+  formatTo(s, fmt);
+  return s;
 }
 
 String DateTimeParts::formatUTC(const char* fmt) const {
-  char buf[64];
-  struct tm* t = gmtime(&_ts);
-  strftime(buf, sizeof(buf), fmt, t);
-  return String(buf);
+  String s;
+  formatUTCTo(s, fmt);
+  return s;
 }
 
 String DateTimeParts::toString() const {
   return format(DateFormatter::ISO8601);
 }
 
+// last TZ string parsed by DateTimeParts::from(), a copy of the text
+// catches a buffer rewritten at the same address
+struct ZoneCache {
+  const char* key;
+  char text[TimeZoneRule::MAX_LENGTH + 1];
+  TimeZoneRule rule;
+};
+
+static RcuCell<ZoneCache> zoneCache(ZoneCache{nullptr, {0}, TimeZoneRule()});
+
+// local fields in a POSIX TZ string zone, false if timeZone is not one.
+// Never waits for a writer, the cache is only refreshed with tryUpdate() and
+// only primed for the current year.
+static bool fieldsIn(const char* timeZone, const time_t secs,
+                     const uint32_t usec, DateTimeFields* out) {
+  if (!timeZone) {
+    return false;
+  }
+  {
+    RcuCell<ZoneCache>::Reader cache(zoneCache);
+    if (cache->key == timeZone && strcmp_P(cache->text, timeZone) == 0) {
+      int8_t isdst;
+      const int32_t offset = cache->rule.sharedOffsetAt(secs, &isdst);
+      *out = DateTimeFields::fromTime(secs, offset, isdst, usec);
+      if (!cache->rule.isCacheExpired(secs)) {
+        return true;
+      }
+      const time_t now = ClockBackend::time();
+      if (cache->rule.isCacheExpired(now)) {
+        // a new year, prime the cached rule for it
+        zoneCache.tryUpdate([timeZone, now](ZoneCache& next) {
+          if (next.key != timeZone || !next.rule.isCacheExpired(now)) {
+            return false;
+          }
+          next.rule.offsetAt(now);
+          return true;
+        });
+      }
+      return true;
+    }
+  }
+  const TimeZoneRule zone = primedRule(timeZone, ClockBackend::time());
+  if (!zone.isValid()) {
+    return false;
+  }
+  int8_t isdst;
+  const int32_t offset = zone.sharedOffsetAt(secs, &isdst);
+  *out = DateTimeFields::fromTime(secs, offset, isdst, usec);
+  zoneCache.tryUpdate([timeZone, &zone](ZoneCache& next) {
+    next.key = timeZone;
+    strcpy_P(next.text, timeZone);
+    next.rule = zone;
+    return true;
+  });
+  return true;
+}
+
 DateTimeParts DateTimeParts::from(const time_t timeSecs, const char* timeZone) {
-  return {timeSecs, timeZone};
+  DateTimeFields f;
+  if (fieldsIn(timeZone, timeSecs, 0, &f)) {
+    return {timeSecs, timeZone, f};
+  }
+  // not a POSIX TZ string, let libc handle it using global TZ
+  struct tm t;
+  localtime_r(&timeSecs, &t);
+  const int64_t localSecs = DateTimeCivil::secondsFromCivil(
+      t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min,
+      t.tm_sec);
+  return {timeSecs, timeZone,
+          DateTimeFields::fromTm(t, (int32_t)(localSecs - timeSecs))};
+}
+
+DateTimeParts DateTimeParts::from(const time_t timeSecs,
+                                  const TimeZoneRule& zone) {
+  int8_t isdst;
+  const int32_t offset = zone.offsetAt(timeSecs, &isdst);
+  return {timeSecs, zone.getSource(),
+          DateTimeFields::fromTime(timeSecs, offset, isdst)};
+}
+
+DateTimeParts DateTimeParts::fromUs(const int64_t timeUs,
+                                    const char* timeZone) {
+  uint32_t usec;
+  const time_t secs = (time_t)DateTimeCivil::splitMicros(timeUs, &usec);
+  DateTimeFields f;
+  if (fieldsIn(timeZone, secs, usec, &f)) {
+    return {secs, timeZone, f};
+  }
+  const DateTimeParts p = from(secs, timeZone);
+  f = p._fields;
+  f.usec = usec;
+  return {p._ts, p._tz, f};
+}
+
+DateTimeParts DateTimeParts::fromUs(const int64_t timeUs,
+                                    const TimeZoneRule& zone) {
+  uint32_t usec;
+  const time_t secs = (time_t)DateTimeCivil::splitMicros(timeUs, &usec);
+  int8_t isdst;
+  const int32_t offset = zone.offsetAt(secs, &isdst);
+  return {secs, zone.getSource(),
+          DateTimeFields::fromTime(secs, offset, isdst, usec)};
 }
 
 DateTimeParts DateTimeParts::from(DateTimeClass* dateTime) {
-  return from(dateTime->getTime(), dateTime->getTimeZone());
+  return dateTime->getParts();
 }
 
 DateTimeClass::DateTimeClass(const time_t _timeSecs, const char* _timeZone,
                              const char* _ntpServer)
-    : bootTimeSecs(validateTime(_timeSecs)),
-      timeZone(_timeZone),
-      ntpServer1(_ntpServer),
-      ntpMode(bootTimeSecs == TIME_ZERO) {}
+    : config({validateTime(_timeSecs), _timeZone,
+              primedRule(_timeZone, _timeSecs), _ntpServer, NTP_SERVER_2,
+              NTP_SERVER_3, ClockModel{0, 0, 0, 0, false}, false, 0}),
+      ntpMode(!isTimeValid()) {}
 
 bool DateTimeClass::setTimeZone(const char* _timeZone) {
-  if (strcmp(timeZone, _timeZone) == 0) {
+  const TimeZoneRule rule = primedRule(_timeZone, getTime());
+  if (!rule.isValid()) {
+    return false;
+  }
+  // both strings may be PSTR, compare from a RAM copy
+  char buf[TimeZoneRule::MAX_LENGTH + 1];
+  strcpy_P(buf, _timeZone);
+  const bool changed = config.update([&](Config& next) {
+    if (strcmp_P(buf, next.timeZone) == 0) {
+      return false;
+    }
+    next.timeZone = _timeZone;
+    next.zoneRule = rule;
+    return true;
+  });
+  if (!changed) {
     return false;
   }
-  timeZone = _timeZone;
 #ifdef ESP_DATE_TIME_DEBUG
   Serial.printf("setTimeZone to %s\n", _timeZone);
 #endif
@@ -61,63 +368,652 @@ void DateTimeClass::setServer(const char* _server1, const char* _server2,
 #ifdef ESP_DATE_TIME_DEBUG
   Serial.printf("setServer to %s,%s,%s\n", _server1, _server2, _server3);
 #endif
-  ntpServer1 = _server1;
-  ntpServer2 = _server2;
-  ntpServer3 = _server3;
+  config.update([=](Config& next) {
+    next.ntpServer1 = _server1;
+    next.ntpServer2 = _server2;
+    next.ntpServer3 = _server3;
+    return true;
+  });
+}
+
+static NTPResult makeResult(const NTPSync& sync, const char* server) {
+  NTPResult result;
+  result.time = sync.getState() == NTPSync::SYNCED ? sync.getTime()
+                                                   : DateTimeClass::TIME_ZERO;
+  result.waitMs = sync.getElapsed();
+  result.attempts = sync.getAttempts();
+  result.server = server;
+  return result;
+}
+
+// blocking version of poll(), sleep until the next check is due
+static void waitForTime(NTPSync& sync, const unsigned int timeOutMs) {
+  sync.start(ClockBackend::millis(), timeOutMs);
+  while (sync.poll(ClockBackend::millis(), ClockBackend::time(),
+                   DateTimeClass::SECS_START_POINT) == NTPSync::SYNCING) {
+    ClockBackend::delay(sync.nextCheckIn(ClockBackend::millis()));
+  }
+}
+
+// bumped by the core sntp when it sets the time
+static std::atomic<uint32_t> ntpSyncCount(0);
+
+static bool ntpSyncWatched = false;
+
+static void watchNtpSync() {
+  ntpSyncWatched = ClockBackend::watchSync([]() { ntpSyncCount++; });
+}
+
+// a resync needs a fresh sntp reply, the time is already valid
+static bool ntpSyncedSince(const uint32_t count) {
+  return !ntpSyncWatched || ntpSyncCount.load() != count;
+}
+
+// the core sntp stepped the system clock after the last model update, the
+// system clock is right until poll() takes the update into the model
+static bool followsModel(const ClockModel& clock, const uint32_t syncCount) {
+  return clock.valid && (!ntpSyncWatched || ntpSyncCount.load() == syncCount);
+}
+
+static uint32_t hardwareRandom() {
+#if defined(ESP32)
+  return esp_random();
+#elif defined(ESP8266)
+  return RANDOM_REG32;
+#else
+  return (uint32_t)micros();
+#endif
+}
+
+void DateTimeClass::configNtp() {
+  watchNtpSync();
+  RcuCell<Config>::Reader cfg(config);
+#ifdef ESP_DATE_TIME_DEBUG
+  Serial.printf("configNtp,timeZone:%s, server:%s\n", cfg->timeZone,
+                cfg->ntpServer1);
+#endif
+  ClockBackend::configTime(cfg->timeZone, cfg->ntpServer1, cfg->ntpServer2,
+                           cfg->ntpServer3);
 }
 
 bool DateTimeClass::forceUpdate(const unsigned int timeOutMs) {
 #ifdef ESP_DATE_TIME_DEBUG
-  Serial.printf("forceUpdate,timeZone:%s, server:%s, timeOut:%u\n", timeZone,
-                ntpServer1, timeOutMs);
+  Serial.printf("forceUpdate,timeOut:%u\n", timeOutMs);
+#endif
+  configNtp();
+  NTPSync sync;
+  waitForTime(sync, timeOutMs);
+#ifdef ESP_DATE_TIME_DEBUG
+  Serial.printf("forceUpdate,now:%ld\n", sync.getTime());
+#endif
+  ntpMode = true;
+  if (ClockBackend::time() > SECS_START_POINT) {
+    applySync((int64_t)ClockBackend::micros64(), SNTPClient::localUs());
+    disciplineSources(true);
+  } else if (scheduler.isRunning()) {
+    scheduler.onFailure(ClockBackend::millis());
+  }
+  return isTimeValid();
+}
+
+bool DateTimeClass::beginAsync(SyncCallback callback,
+                               const unsigned int timeOutMs) {
+  if (ntpSync.isSyncing()) {
+    return false;
+  }
+#ifdef ESP_DATE_TIME_DEBUG
+  Serial.printf("beginAsync,timeOut:%u\n", timeOutMs);
 #endif
-// esp8266 not support time_zone, just add seconds
-// so strftime %z always +0000
-#if defined(ESP8266)
-  configTime(timeZone, ntpServer1, ntpServer2, ntpServer3);
-#elif defined(ESP32)
-  configTzTime(timeZone, ntpServer1, ntpServer2, ntpServer3);
+  configNtp();
+  syncCallback = nullptr;
+  if (callback) {
+    syncCallback = [this, callback](const NTPResult&) {
+      callback(isTimeValid());
+    };
+  }
+  syncSetTime = true;
+  scheduledSync = false;
+  ntpSync.start(ClockBackend::millis(), timeOutMs);
+  return true;
+}
+
+void DateTimeClass::setAutoSync(const bool enable, const uint32_t budgetMs) {
+  if (!enable) {
+    scheduler.stop();
+    return;
+  }
+  scheduler.setBudget(budgetMs);
+  scheduler.setSeed(hardwareRandom());
+  scheduler.start(ClockBackend::millis());
+  bool synced;
+  {
+    RcuCell<Config>::Reader cfg(config);
+    synced = cfg->clock.valid && !cfg->restored;
+  }
+  if (synced) {
+    // right after begin(), the last sync counts as the first one
+    scheduler.onSuccess(ClockBackend::millis(), drift.getUncertaintyPpm(),
+                        (uint32_t)drift.getRmsResidual());
+  }
+}
+
+NTPSync::State DateTimeClass::poll() {
+  disciplineSources(false);
+  if (!ntpSync.isSyncing() && ntpSyncWatched &&
+      ntpSyncCount.load() != RcuCell<Config>::Reader(config)->syncCount &&
+      ClockBackend::time() > SECS_START_POINT) {
+    // the hourly core sntp update, a sample for the drift model
+    ntpMode = true;
+    applySync((int64_t)ClockBackend::micros64(), SNTPClient::localUs());
+  }
+  if (!ntpSync.isSyncing()) {
+    if (!scheduler.isDue(ClockBackend::millis())) {
+      return ntpSync.getState();
+    }
+#ifdef ESP_DATE_TIME_DEBUG
+    Serial.printf("poll,scheduled sync, failures:%u\n",
+                  scheduler.getFailures());
+#endif
+    scheduledSyncCount = ntpSyncCount.load();
+    configNtp();
+    syncCallback = nullptr;
+    syncSetTime = true;
+    scheduledSync = true;
+    ntpSync.start(ClockBackend::millis(), DEFAULT_TIMEOUT);
+  }
+  const bool fresh = !scheduledSync || ntpSyncedSince(scheduledSyncCount);
+  const NTPSync::State state =
+      ntpSync.poll(ClockBackend::millis(),
+                   fresh ? ClockBackend::time() : TIME_ZERO, SECS_START_POINT);
+  if (state == NTPSync::SYNCING) {
+    return state;
+  }
+  if (scheduledSync && state == NTPSync::TIMEOUT) {
+    scheduler.onFailure(ClockBackend::millis());
+  }
+  scheduledSync = false;
+#ifdef ESP_DATE_TIME_DEBUG
+  Serial.printf("poll,now:%ld, attempts:%u\n", ntpSync.getTime(),
+                ntpSync.getAttempts());
 #endif
-  time_t now = time(nullptr);
-  auto startMs = millis();
-  unsigned long retryCount = 0;
-  while (now < SECS_START_POINT && (millis() - startMs < timeOutMs)) {
-    delay(50 + 50 * retryCount++);
-    now = time(nullptr);
+  if (syncSetTime && state == NTPSync::SYNCED) {
+    ntpMode = true;
+    applySync((int64_t)ClockBackend::micros64(), SNTPClient::localUs());
   }
+  if (syncCallback) {
+    // move out first, the callback may start another sync
+    NTPCallback callback = syncCallback;
+    syncCallback = nullptr;
+    callback(makeResult(ntpSync, getServer()));
+  }
+  return state;
+}
+
+NTPResult DateTimeClass::ntpTime(const unsigned int timeOutMs) {
 #ifdef ESP_DATE_TIME_DEBUG
-  Serial.printf("forceUpdate,now:%ld\n", now);
+  Serial.printf("ntpTime,server:%s, timeOut:%u\n", getServer(), timeOutMs);
 #endif
+  NTPSync sync;
+  waitForTime(sync, timeOutMs);
+  const NTPResult result = makeResult(sync, getServer());
+#ifdef ESP_DATE_TIME_DEBUG
+  Serial.printf("ntpTime,now:%ld, wait:%lu\n", result.time, result.waitMs);
+#endif
+  return result;
+}
+
+bool DateTimeClass::ntpTimeAsync(NTPCallback callback,
+                                 const unsigned int timeOutMs) {
+  if (ntpSync.isSyncing()) {
+    return false;
+  }
+  syncCallback = callback;
+  syncSetTime = false;
+  scheduledSync = false;
+  ntpSync.start(ClockBackend::millis(), timeOutMs);
+  return true;
+}
+
+bool DateTimeClass::sntpUpdate(SNTPTransport& transport, SNTPSample* sample,
+                               const unsigned int timeOutMs) {
+  const char* servers[3];
+  {
+    RcuCell<Config>::Reader cfg(config);
+    servers[0] = cfg->ntpServer1;
+    servers[1] = cfg->ntpServer2;
+    servers[2] = cfg->ntpServer3;
+  }
+  SNTPSample best;
+  SNTPClient client(transport);
+  const int index = client.query(servers, 3, &best, timeOutMs);
+#ifdef ESP_DATE_TIME_DEBUG
+  Serial.printf("sntpUpdate,server:%d, offset:%ldus, delay:%ldus\n", index,
+                (long)(index < 0 ? 0 : best.offsetUs),
+                (long)(index < 0 ? 0 : best.delayUs));
+#endif
+  if (index < 0) {
+    if (scheduler.isRunning()) {
+      scheduler.onFailure(ClockBackend::millis());
+    }
+    return false;
+  }
+  if (sample) {
+    *sample = best;
+  }
+  const int64_t monoUs = (int64_t)ClockBackend::micros64();
+  const int64_t nowUs = SNTPClient::localUs() + best.offsetUs;
+  // keep time() in step
+  ClockBackend::setUtcUs(nowUs);
   ntpMode = true;
-  setTime(time(nullptr));
+  const bool valid = applySync(monoUs, nowUs);
+  disciplineSources(true);
+  return valid;
+}
+
+bool DateTimeClass::syncFrom(TimeSource& source) {
+  int64_t utcUs;
+  if (!source.read(&utcUs) || utcUs / 1000000 <= SECS_START_POINT) {
+    if (scheduler.isRunning()) {
+      scheduler.onFailure(ClockBackend::millis());
+    }
+    return false;
+  }
+  const int64_t monoUs = (int64_t)ClockBackend::micros64();
+#ifdef ESP_DATE_TIME_DEBUG
+  Serial.printf("syncFrom,source:%s\n", source.getName());
+#endif
+  ClockBackend::setUtcUs(utcUs);
+  // the other sources are written by poll()
+  return applySync(monoUs, utcUs);
+}
+
+bool DateTimeClass::applySync(const int64_t monoUs, const int64_t utcUs) {
+  const uint32_t syncCount = ntpSyncCount.load();
+  const bool stepped = drift.addSample(monoUs, utcUs);
+  const ClockModel clock = drift.getModel();
+  const time_t timeSecs = (time_t)(utcUs / 1000000);
+  const time_t bootTimeSecs = timeSecs - (time_t)(monoUs / 1000000);
+  config.update([&](Config& next) {
+    next.bootTimeSecs = bootTimeSecs;
+    next.clock = clock;
+    next.restored = false;
+    next.syncCount = syncCount;
+    next.zoneRule.offsetAt(timeSecs);
+    return true;
+  });
+  refreshAnchor();
+  if (scheduler.isRunning()) {
+    scheduler.onSuccess(ClockBackend::millis(), drift.getUncertaintyPpm(),
+                        (uint32_t)drift.getRmsResidual());
+  }
+  saveSync();
+  disciplinePending = sourceCount > 0;
+  disciplineSinceMs = ClockBackend::millis64();
+#ifdef ESP_DATE_TIME_DEBUG
+  Serial.printf("applySync,timeSecs:%ld, ppm:%.3f, %s\n", (long)timeSecs,
+                drift.getPpm(), stepped ? "step" : "slew");
+#else
+  (void)stepped;
+#endif
   return isTimeValid();
 }
 
-time_t DateTimeClass::ntpTime(const unsigned int timeOutMs) {
+void DateTimeClass::setStorage(TimeStorage* primary, TimeStorage* fallback) {
+  storage = primary;
+  fallbackStorage = fallback;
+  fallbackSaved = false;
+}
+
+void DateTimeClass::saveSync() {
+  TimeRecord record;
+  if ((!storage && !fallbackStorage) || !currentRecord(&record)) {
+    return;
+  }
+  uint8_t buf[TimeRecord::SIZE];
+  record.encode(buf);
+  if (storage) {
+    storage->write(buf, sizeof(buf));
+  }
+  // fallback is usually flash, limit the wear
+  const uint64_t nowMs = ClockBackend::millis64();
+  if (fallbackStorage &&
+      (!fallbackSaved || nowMs - fallbackSavedMs >= FALLBACK_SAVE_MS)) {
+    fallbackSaved = fallbackStorage->write(buf, sizeof(buf));
+    fallbackSavedMs = nowMs;
+  }
+}
+
+bool DateTimeClass::currentRecord(TimeRecord* record) const {
+  if (!isTimeValid()) {
+    return false;
+  }
+  memset(record, 0, sizeof(*record));
+  RcuCell<Config>::Reader cfg(config);
+  const int64_t monoUs = (int64_t)ClockBackend::micros64();
+  record->epochUs = followsModel(cfg->clock, cfg->syncCount)
+                        ? cfg->clock.utcAt(monoUs)
+                        : nowUs();
+  record->monoUs = monoUs;
+  record->freqPpb = cfg->clock.valid ? (int32_t)(cfg->clock.freq * 1e9) : 0;
+  // a longer string is not a valid rule, leave it empty
+  if (strlen_P(cfg->timeZone) < TimeRecord::ZONE_SIZE) {
+    strcpy_P(record->timeZone, cfg->timeZone);
+  }
+  return true;
+}
+
+bool DateTimeClass::saveTime(TimeStorage& target) const {
+  TimeRecord record;
+  if (!currentRecord(&record)) {
+    return false;
+  }
+  uint8_t buf[TimeRecord::SIZE];
+  record.encode(buf);
+  return target.write(buf, sizeof(buf));
+}
+
+static bool readRecord(TimeStorage& source, TimeRecord* record) {
+  uint8_t buf[TimeRecord::SIZE];
+  return source.read(buf, sizeof(buf)) && record->decode(buf, sizeof(buf)) &&
+         record->epochUs / 1000000 > DateTimeClass::SECS_START_POINT;
+}
+
+bool DateTimeClass::restoreClock(const int64_t utcUs, const double freq,
+                                 const char* timeZone) {
+  const int64_t monoUs = (int64_t)ClockBackend::micros64();
+  const time_t timeSecs = (time_t)(utcUs / 1000000);
+  drift.restore(monoUs, utcUs, freq);
+  const ClockModel clock = drift.getModel();
+  // readers may hold the buffer through an older snapshot, fill it once
+  const bool zone = timeZone && restoredZone[0] == '\0' &&
+                    TimeZoneRule(timeZone).isValid();
+  if (zone) {
+    strcpy(restoredZone, timeZone);
+  }
+  const TimeZoneRule rule = zone ? primedRule(restoredZone, timeSecs)
+                                 : TimeZoneRule();
+  config.update([&](Config& next) {
+    next.bootTimeSecs = timeSecs - (time_t)(monoUs / 1000000);
+    next.clock = clock;
+    next.restored = true;
+    next.syncCount = ntpSyncCount.load();
+    if (zone) {
+      next.timeZone = restoredZone;
+      next.zoneRule = rule;
+    } else {
+      next.zoneRule.offsetAt(timeSecs);
+    }
+    return true;
+  });
+  refreshAnchor();
 #ifdef ESP_DATE_TIME_DEBUG
-  Serial.printf("ntpTime,timeZone:%s, server:%s, timeOut:%u\n", timeZone,
-                ntpServer1, timeOutMs);
+  Serial.printf("restoreClock,timeSecs:%ld, ppm:%.3f, zone:%s\n",
+                (long)timeSecs, drift.getPpm(), zone ? restoredZone : "");
 #endif
-  time_t now = time(nullptr);
-  auto startMs = millis();
-  unsigned long retryCount = 0;
-  while (millis() - startMs < timeOutMs) {
-    delay(50 + 50 * retryCount++);
-    now = time(nullptr);
+  return isTimeValid();
+}
+
+bool DateTimeClass::restoreTime(TimeStorage& source, const bool withZone) {
+  TimeRecord record;
+  if (isTimeValid() || !readRecord(source, &record)) {
+    return false;
+  }
+  // at least the uptime passed since the save
+  return restoreClock(record.epochUs + (int64_t)ClockBackend::micros64(),
+                      record.freqPpb / 1e9,
+                      withZone ? record.timeZone : nullptr);
+}
+
+// keeps counting through deep sleep, -1 if there is none
+static int64_t rtcTimerUs() {
+#if defined(ARDUINO) && defined(ESP32)
+  // the system time is kept by the RTC timer in deep sleep
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#elif defined(ARDUINO) && defined(ESP8266)
+  // RTC ticks, calibrated period in microseconds << 12
+  return (int64_t)(((uint64_t)system_get_rtc_time() *
+                    system_rtc_clock_cali_proc()) >>
+                   12);
+#else
+  return -1;
+#endif
+}
+
+static int64_t rtcElapsedUs(const int64_t savedUs) {
+  const int64_t nowUs = rtcTimerUs();
+#if defined(ARDUINO) && defined(ESP8266)
+  if (nowUs < savedUs) {
+    // the 32-bit tick counter wraps about every 8 hours
+    return nowUs - savedUs +
+           (int64_t)((0x100000000ULL * system_rtc_clock_cali_proc()) >> 12);
   }
+#endif
+  return nowUs - savedUs;
+}
+
+static bool wokeFromSleep() {
+#if defined(ARDUINO) && defined(ESP32)
+  return esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED;
+#elif defined(ARDUINO) && defined(ESP8266)
+  return ESP.getResetInfoPtr()->reason == REASON_DEEP_SLEEP_AWAKE;
+#else
+  return true;
+#endif
+}
+
+TimeStorage* DateTimeClass::sleepStorage() {
+#ifdef ARDUINO
+  static RtcTimeStorage rtc;
+  return storage ? storage : &rtc;
+#else
+  return storage;
+#endif
+}
+
+bool DateTimeClass::prepareSleep(const uint64_t durationUs) {
+  TimeStorage* target = sleepStorage();
+  TimeRecord record;
+  if (!target || !currentRecord(&record)) {
+    return false;
+  }
+  record.flags = TimeRecord::FLAG_SLEEP;
+  record.sleepUs = (int64_t)durationUs;
+  record.rtcUs = rtcTimerUs();
+  if (record.rtcUs >= 0) {
+    record.flags |= TimeRecord::FLAG_RTC;
+  }
+  uint8_t buf[TimeRecord::SIZE];
+  record.encode(buf);
 #ifdef ESP_DATE_TIME_DEBUG
-  Serial.printf("ntpTime,now:%ld\n", now);
+  Serial.printf("prepareSleep,sleepUs:%lld, rtcUs:%lld\n",
+                (long long)record.sleepUs, (long long)record.rtcUs);
 #endif
-  return now;
+  return target->write(buf, sizeof(buf));
+}
+
+bool DateTimeClass::resumeFromSleep() {
+  TimeStorage* source = sleepStorage();
+  TimeRecord record;
+  if (isTimeValid() || !source || !wokeFromSleep() ||
+      !readRecord(*source, &record) ||
+      !(record.flags & TimeRecord::FLAG_SLEEP)) {
+    return false;
+  }
+  int64_t elapsedUs = record.sleepUs + (int64_t)ClockBackend::micros64();
+  if ((record.flags & TimeRecord::FLAG_RTC) && rtcTimerUs() >= 0) {
+    // measured, also right after an early wakeup
+    elapsedUs = rtcElapsedUs(record.rtcUs);
+  }
+  // used once, a later reset only gets the lower bound of restoreTime()
+  record.flags = 0;
+  uint8_t buf[TimeRecord::SIZE];
+  record.encode(buf);
+  source->write(buf, sizeof(buf));
+  return restoreClock(record.epochUs + elapsedUs, record.freqPpb / 1e9,
+                      record.timeZone);
+}
+
+bool DateTimeClass::begin(const unsigned int timeOutMs) {
+  if (isTimeValid() || resumeFromSleep()) {
+    return true;
+  }
+  if (readSources() || (storage && restoreTime(*storage)) ||
+      (fallbackStorage && restoreTime(*fallbackStorage))) {
+    // plausible time now, refined by poll()
+    beginAsync(nullptr, timeOutMs);
+    return true;
+  }
+  return forceUpdate(timeOutMs);
+}
+
+bool DateTimeClass::addTimeSource(TimeSource* source) {
+  if (!source || sourceCount == MAX_TIME_SOURCES) {
+    return false;
+  }
+  // keep sorted by priority, stable for equal ones
+  uint8_t i = sourceCount++;
+  while (i > 0 && sources[i - 1]->getPriority() > source->getPriority()) {
+    sources[i] = sources[i - 1];
+    i--;
+  }
+  sources[i] = source;
+  return true;
+}
+
+bool DateTimeClass::readSources() {
+  for (uint8_t i = 0; i < sourceCount; i++) {
+    int64_t utcUs;
+    if (sources[i]->read(&utcUs) && utcUs / 1000000 > SECS_START_POINT) {
+#ifdef ESP_DATE_TIME_DEBUG
+      Serial.printf("readSources,source:%s\n", sources[i]->getName());
+#endif
+      return restoreClock(utcUs, drift.getModel().freq, nullptr);
+    }
+  }
+  return false;
+}
+
+void DateTimeClass::disciplineSources(const bool wait) {
+  if (!disciplinePending) {
+    return;
+  }
+  int64_t utcUs = nowUs();
+  const uint32_t fraction = (uint32_t)(utcUs % 1000000);
+  if (wait) {
+    // the chips count whole seconds, write at the start of one
+    ClockBackend::delay((1000000 - fraction) / 1000);
+    utcUs = nowUs();
+  } else if (fraction > DISCIPLINE_WINDOW_US &&
+             ClockBackend::millis64() - disciplineSinceMs < DEFAULT_TIMEOUT) {
+    // wait for a poll() near the start of a second
+    return;
+  }
+  disciplinePending = false;
+  for (uint8_t i = 0; i < sourceCount; i++) {
+    const bool written = sources[i]->write(utcUs);
+#ifdef ESP_DATE_TIME_DEBUG
+    Serial.printf("disciplineSources,source:%s, written:%d\n",
+                  sources[i]->getName(), written);
+#else
+    (void)written;
+#endif
+  }
+}
+
+time_t DateTimeClass::getTime() const {
+  RcuCell<Config>::Reader cfg(config);
+  if (followsModel(cfg->clock, cfg->syncCount)) {
+    return (time_t)(nowUs() / 1000000);
+  }
+  return osTime();
+}
+
+int64_t DateTimeClass::refreshAnchor() const {
+  RcuCell<Config>::Reader cfg(config);
+  const ClockModel clock = cfg->clock;
+  if (followsModel(clock, cfg->syncCount)) {
+    // ClockBackend::micros() is the low 32 bits of micros64()
+    const uint64_t monoUs = ClockBackend::micros64();
+    const int64_t epochUs = clock.utcAt((int64_t)monoUs);
+    anchor.publish(epochUs, (uint32_t)monoUs);
+    return epochUs;
+  }
+  const int64_t utcUs = ClockBackend::utcUs();
+  const uint32_t monoUs = ClockBackend::micros();
+  const int64_t epochUs = utcUs / 1000000 > SECS_START_POINT
+                              ? utcUs
+                              : (int64_t)ClockBackend::millis64() * 1000;
+  anchor.publish(epochUs, monoUs);
+  return epochUs;
+}
+
+int64_t DateTimeClass::nowUs() const {
+  int64_t epochUs;
+  uint32_t anchorUs;
+  // ClockBackend::micros() after the anchor, see StampAnchor::now()
+  const bool valid = anchor.read(&epochUs, &anchorUs) != 0;
+  const uint32_t monoUs = ClockBackend::micros();
+  if (!valid ||
+      (uint32_t)(monoUs - anchorUs) >= ANCHOR_REFRESH_US) {
+    return refreshAnchor();
+  }
+  RcuCell<Config>::Reader cfg(config);
+  const ClockModel clock = cfg->clock;
+  if (followsModel(clock, cfg->syncCount)) {
+    // the anchor runs at the raw rate, follow the model to stay monotonic
+    return clock.utcAt((int64_t)ClockBackend::micros64());
+  }
+  return epochUs + (uint32_t)(monoUs - anchorUs);
+}
+
+int64_t IRAM_ATTR DateTimeClass::captureStamp() const {
+  return anchor.now();
+}
+
+DateTimeParts DateTimeClass::getParts(const int64_t stampUs) const {
+  uint32_t usec;
+  const time_t secs = (time_t)DateTimeCivil::splitMicros(stampUs, &usec);
+  RcuCell<Config>::Reader cfg(config);
+  // the rule is shared with other readers, do not touch its cache
+  int8_t isdst;
+  const int32_t offset = cfg->zoneRule.sharedOffsetAt(secs, &isdst);
+  if (cfg->zoneRule.isCacheExpired(secs)) {
+    const time_t now = getTime();
+    if (cfg->zoneRule.isCacheExpired(now)) {
+      // a new year, prime the shared rule for it unless a writer is busy,
+      // stamps of other years never move it
+      config.tryUpdate([now](Config& next) {
+        if (!next.zoneRule.isCacheExpired(now)) {
+          return false;
+        }
+        next.zoneRule.offsetAt(now);
+        return true;
+      });
+    }
+  }
+  return {secs, cfg->zoneRule.getSource(),
+          DateTimeFields::fromTime(secs, offset, isdst, usec)};
 }
 
 bool DateTimeClass::setTime(const time_t timeSecs, bool forceSet) {
   if (forceSet || timeSecs > SECS_START_POINT) {
-    bootTimeSecs = timeSecs - (time_t)(millis() / 1000);
+    const time_t bootTimeSecs =
+        timeSecs - (time_t)(ClockBackend::millis64() / 1000);
+    config.update([bootTimeSecs, timeSecs](Config& next) {
+      next.bootTimeSecs = bootTimeSecs;
+      // time set by hand, drop the drift model until the next sync
+      next.clock.valid = false;
+      next.restored = false;
+      next.zoneRule.offsetAt(timeSecs);
+      return true;
+    });
   }
+  refreshAnchor();
 #ifdef ESP_DATE_TIME_DEBUG
   Serial.printf("setTime,timeSecs:%ld, bootTimeSecs:%ld\n", timeSecs,
-                bootTimeSecs);
+                getBootTime());
 #endif
   return isTimeValid();
 }
@@ -128,4 +1024,20 @@ String DateTimeClass::formatUTC(const char* fmt) {
   return getParts().formatUTC(fmt);
 }
 
+size_t DateTimeClass::formatTo(char* dst, size_t cap, const char* fmt) {
+  return getParts().formatTo(dst, cap, fmt);
+}
+
+size_t DateTimeClass::formatTo(Print& out, const char* fmt) {
+  return getParts().formatTo(out, fmt);
+}
+
+size_t DateTimeClass::formatUTCTo(char* dst, size_t cap, const char* fmt) {
+  return getParts().formatUTCTo(dst, cap, fmt);
+}
+
+size_t DateTimeClass::formatUTCTo(Print& out, const char* fmt) {
+  return getParts().formatUTCTo(out, fmt);
+}
+
 DateTimeClass DateTime;
\ No newline at end of file
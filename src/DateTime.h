@@ -8,7 +8,8 @@
  *
  */
 
-#if !defined(ESP8266) && !defined(ESP32)
+// host builds use the shim in extras/native, see the native environment
+#if defined(ARDUINO) && !defined(ESP8266) && !defined(ESP32)
 #error "ESPDateTime only support ESP32 or ESP8266 platform!"
 #endif
 
@@ -18,28 +19,129 @@
  */
 #define DEFAULT_TIMEZONE "UTC0"
 
+/**
+ * @brief Stack buffer size used when formatting to Print or String sinks
+ *
+ */
+#ifndef ESP_DATE_TIME_FORMAT_BUFFER
+#define ESP_DATE_TIME_FORMAT_BUFFER 64
+#endif
+
 #include <Arduino.h>
 #include <sys/time.h>
 #include <time.h>
+#include <functional>
+#include "ClockBackend.h"
+#include "ClockDrift.h"
+#include "DateTimeCivil.h"
+#include "FixedZone.h"
+#include "MonoClock.h"
+#include "NTPSync.h"
+#include "RcuCell.h"
+#include "SNTP.h"
+#include "SyncScheduler.h"
+#include "TimeSource.h"
+#include "TimeStamp.h"
+#include "TimeStorage.h"
+#include "TimeZoneRule.h"
 
 class DateTimeClass;
 
+/**
+ * @brief Compact broken-down calendar fields, similar to struct tm but using
+ * the smallest integer types that fit, filled once by DateTimeParts::from().
+ *
+ */
+struct DateTimeFields {
+  int32_t offset; /**< seconds east of UTC used for this conversion */
+  int16_t year;   /**< year (format: 19xx, 20xx) */
+  uint16_t yday;  /**< days since January 1 (0-365) */
+  uint8_t month;  /**< months since January (0-11) */
+  uint8_t mday;   /**< day of the month (1-31) */
+  uint8_t hour;   /**< hours since midnight (0-23) */
+  uint8_t minute; /**< minutes after the hour (0-59) */
+  uint8_t second; /**< seconds after the minute (0-60) */
+  uint8_t wday;   /**< days since Sunday (0-6) */
+  int8_t isdst;   /**< daylight saving time flag */
+  uint32_t usec;  /**< microseconds after the second (0-999999) */
+  /**
+   * @brief Convert from struct tm, offset is seconds east of UTC
+   *
+   * @param t struct tm value
+   * @param offset seconds east of UTC
+   * @return DateTimeFields compact fields
+   */
+  static DateTimeFields fromTm(const struct tm& t, const int32_t offset);
+  /**
+   * @brief Convert timestamp with pure integer arithmetic, reentrant, no
+   * libc time zone access, see DateTimeCivil.h
+   *
+   * @param ts timestamp in seconds since 1970
+   * @param offset seconds east of UTC added before conversion
+   * @param isdst daylight saving time flag
+   * @param usec microseconds after the second
+   * @return DateTimeFields compact fields
+   */
+  static DateTimeFields fromTime(const time_t ts, const int32_t offset = 0,
+                                 const int8_t isdst = 0,
+                                 const uint32_t usec = 0);
+  /**
+   * @brief Convert timestamps with one offset, like fromTime() for each.
+   * Records on the same local day only split the time of day in a loop the
+   * compiler can vectorize, and the next day is a field increment, so sorted
+   * input is much faster. Unsorted input is still correct.
+   *
+   * @param ts timestamps in seconds since 1970
+   * @param n timestamp count
+   * @param out output fields, n records
+   * @param offset seconds east of UTC added before conversion
+   * @param isdst daylight saving time flag
+   */
+  static void fromTimeBatch(const time_t* ts, const size_t n,
+                            DateTimeFields* out, const int32_t offset = 0,
+                            const int8_t isdst = 0);
+  /**
+   * @brief Convert back to struct tm, for strftime
+   *
+   * @return struct tm broken-down time
+   */
+  struct tm toTm() const;
+};
+
 /**
  * @brief DateTime Parts struct, similar to struct tm in <time.h>, containing a
  * calendar date and time broken down into its components, but more readable,
  * include some useful getter methods.
  *
+ * The calendar fields are converted only once in from(), getters just read
+ * the cached fields.
+ *
  */
 struct DateTimeParts {
   // http://www.cplusplus.com/reference/ctime/tm/
-  const time_t _ts; /**< timestamp variable, internal */
-  const char* _tz;  /**< timezone variable, internal */
+  const time_t _ts;              /**< timestamp variable, internal */
+  const char* _tz;               /**< timezone variable, internal */
+  const DateTimeFields _fields;  /**< cached local fields, internal */
   /**
    * @brief Get current timestamp, in seconds
    *
    * @return time_t timestamp, in seconds
    */
   time_t getTime() const { return _ts; }
+  /**
+   * @brief Get current timestamp, in milliseconds
+   *
+   * @return int64_t timestamp, in milliseconds
+   */
+  int64_t getTimeMs() const {
+    return (int64_t)_ts * 1000 + _fields.usec / 1000;
+  }
+  /**
+   * @brief Get current timestamp, in microseconds
+   *
+   * @return int64_t timestamp, in microseconds
+   */
+  int64_t getTimeUs() const { return (int64_t)_ts * 1000000 + _fields.usec; }
   /**
    * @brief Get internal timezone offset
    *
@@ -51,73 +153,67 @@ struct DateTimeParts {
    *
    * @return int year value
    */
-  int getYear() const {
-    struct tm* t = localtime(&_ts);
-    return t->tm_year + 1900;
-  }
+  int getYear() const { return _fields.year; }
   /**
    * @brief Get months since January (0-11)
    *
    * @return int month value
    */
-  int getMonth() const {
-    struct tm* t = localtime(&_ts);
-    return t->tm_mon;
-  }
+  int getMonth() const { return _fields.month; }
   /**
    * @brief Get days since January 1 (0-365)
    *
    * @return int day of year
    */
-  int getYearDay() const {
-    struct tm* t = localtime(&_ts);
-    return t->tm_yday;
-  }
+  int getYearDay() const { return _fields.yday; }
   /**
    * @brief Get day of the month (1-31)
    *
    * @return int month day
    */
-  int getMonthDay() const {
-    struct tm* t = localtime(&_ts);
-    return t->tm_mday;
-  }
+  int getMonthDay() const { return _fields.mday; }
   /**
    * @brief Get days since Sunday (0-6)
    *
    * @return int day of week
    */
-  int getWeekDay() const {
-    struct tm* t = localtime(&_ts);
-    return t->tm_wday;
-  }
+  int getWeekDay() const { return _fields.wday; }
   /**
    * @brief Get hours since midnight (0-23)
    *
    * @return int hours
    */
-  int getHours() const {
-    struct tm* t = localtime(&_ts);
-    return t->tm_hour;
-  }
+  int getHours() const { return _fields.hour; }
   /**
    * @brief Get minutes after the hour (0-59)
    *
    * @return int minutes
    */
-  int getMinutes() const {
-    struct tm* t = localtime(&_ts);
-    return t->tm_min;
-  }
+  int getMinutes() const { return _fields.minute; }
   /**
    * @brief Get seconds after the minute (0-60)
    *
    * @return int seconds
    */
-  int getSeconds() const {
-    struct tm* t = localtime(&_ts);
-    return t->tm_sec;
-  }
+  int getSeconds() const { return _fields.second; }
+  /**
+   * @brief Get milliseconds after the second (0-999)
+   *
+   * @return int milliseconds
+   */
+  int getMilliseconds() const { return (int)(_fields.usec / 1000); }
+  /**
+   * @brief Get microseconds after the second (0-999999)
+   *
+   * @return long microseconds
+   */
+  long getMicroseconds() const { return (long)_fields.usec; }
+  /**
+   * @brief Get local offset from UTC, in seconds east of UTC
+   *
+   * @return int32_t offset seconds
+   */
+  int32_t getOffset() const { return _fields.offset; }
 
   /**
    * @brief Foramt current time to string representation
@@ -140,6 +236,82 @@ struct DateTimeParts {
    * @return String string representation of current time
    */
   String toString() const;
+  /**
+   * @brief Format current time into caller buffer, never touch the heap
+   *
+   * @param dst destination buffer, always null terminated if cap > 0
+   * @param cap destination buffer capacity, including terminator
+   * @param fmt format string for strftime
+   * @return size_t written length without terminator, 0 if not fit
+   */
+  size_t formatTo(char* dst, size_t cap, const char* fmt) const;
+  /**
+   * @brief Format current time to Print sink (Serial, File, Client)
+   *
+   * @param out print sink
+   * @param fmt format string for strftime
+   * @return size_t written length
+   */
+  size_t formatTo(Print& out, const char* fmt) const;
+  /**
+   * @brief Append formatted current time to String, reserve exact size once
+   *
+   * @param out string to append to
+   * @param fmt format string for strftime
+   * @return size_t appended length
+   */
+  size_t formatTo(String& out, const char* fmt) const;
+  /**
+   * @brief Format utc time into caller buffer, never touch the heap
+   *
+   * @param dst destination buffer, always null terminated if cap > 0
+   * @param cap destination buffer capacity, including terminator
+   * @param fmt format string for strftime
+   * @return size_t written length without terminator, 0 if not fit
+   */
+  size_t formatUTCTo(char* dst, size_t cap, const char* fmt) const;
+  /**
+   * @brief Format utc time to Print sink (Serial, File, Client)
+   *
+   * @param out print sink
+   * @param fmt format string for strftime
+   * @return size_t written length
+   */
+  size_t formatUTCTo(Print& out, const char* fmt) const;
+  /**
+   * @brief Append formatted utc time to String, reserve exact size once
+   *
+   * @param out string to append to
+   * @param fmt format string for strftime
+   * @return size_t appended length
+   */
+  size_t formatUTCTo(String& out, const char* fmt) const;
+  /**
+   * @brief Format current time with a precompiled format tag, selected at
+   * compile time, see DateTimeFormat.h
+   *
+   * @tparam F format tag, like FormatISO8601
+   * @param dst destination buffer
+   * @param cap destination buffer capacity, including terminator
+   * @return size_t written length without terminator, 0 if not fit
+   */
+  template <typename F>
+  size_t formatTo(char* dst, size_t cap) const {
+    return F::formatTo(dst, cap, _fields);
+  }
+  /**
+   * @brief Format current time with a precompiled format tag or a pattern
+   * compiled by CompiledFormat, see DateTimePattern.h
+   *
+   * @tparam F format tag, like FormatISO8601 or CompiledFormat<PATTERN>
+   * @return String string representation of current time
+   */
+  template <typename F>
+  String format() const {
+    char buf[F::LENGTH + 1];
+    formatTo<F>(buf, sizeof(buf));
+    return String(buf);
+  }
 
   /**
    * @brief factory method for constructing DateTimeParts from timestamp and
@@ -159,6 +331,62 @@ struct DateTimeParts {
    * @return DateTimeParts DateTimeParts object
    */
   static DateTimeParts from(DateTimeClass* dateTime);
+  /**
+   * @brief factory method for constructing DateTimeParts from timestamp and
+   * a parsed time zone rule, no TZ string parsing.
+   *
+   * @param timeSecs timestamp in seconds since 1970
+   * @param zone parsed time zone rule
+   * @return DateTimeParts DateTimeParts object
+   */
+  static DateTimeParts from(const time_t timeSecs, const TimeZoneRule& zone);
+  /**
+   * @brief factory method for constructing sub-second DateTimeParts from
+   * timestamp in microseconds and timezone.
+   *
+   * @param timeUs timestamp in microseconds since 1970
+   * @param timeZone POSIX TZ string
+   * @return DateTimeParts DateTimeParts object
+   */
+  static DateTimeParts fromUs(const int64_t timeUs,
+                              const char* timeZone = DEFAULT_TIMEZONE);
+  /**
+   * @brief factory method for constructing sub-second DateTimeParts from
+   * timestamp in microseconds and a parsed time zone rule.
+   *
+   * @param timeUs timestamp in microseconds since 1970
+   * @param zone parsed time zone rule
+   * @return DateTimeParts DateTimeParts object
+   */
+  static DateTimeParts fromUs(const int64_t timeUs, const TimeZoneRule& zone);
+  /**
+   * @brief factory method for constructing DateTimeParts from timestamp and
+   * a compile-time fixed zone, the zone lookup is a constant add.
+   *
+   * @tparam OFFSET seconds east of UTC
+   * @param timeSecs timestamp in seconds since 1970
+   * @return DateTimeParts DateTimeParts object
+   */
+  template <int32_t OFFSET>
+  static DateTimeParts from(const time_t timeSecs, const FixedZone<OFFSET>) {
+    return {timeSecs, FixedZone<OFFSET>::TIME_ZONE,
+            DateTimeFields::fromTime(timeSecs, OFFSET)};
+  }
+  /**
+   * @brief factory method for constructing sub-second DateTimeParts from
+   * timestamp in microseconds and a compile-time fixed zone.
+   *
+   * @tparam OFFSET seconds east of UTC
+   * @param timeUs timestamp in microseconds since 1970
+   * @return DateTimeParts DateTimeParts object
+   */
+  template <int32_t OFFSET>
+  static DateTimeParts fromUs(const int64_t timeUs, const FixedZone<OFFSET>) {
+    uint32_t usec;
+    const time_t secs = (time_t)DateTimeCivil::splitMicros(timeUs, &usec);
+    return {secs, FixedZone<OFFSET>::TIME_ZONE,
+            DateTimeFields::fromTime(secs, OFFSET, 0, usec)};
+  }
 };
 
 /**
@@ -169,35 +397,44 @@ struct DateTimeParts {
  */
 struct DateFormatter {
   /**
-   * @brief ISO8601 date time string format (2019-11-29T23:29:55+0800).
+   * @brief ISO8601 date time string format, "%FT%T%z"
+   * (2019-11-29T23:29:55+0800).
    *
    */
-  constexpr static const char* ISO8601 = "%FT%T%z";
+  static const char ISO8601[];
   /**
-   * @brief RFC1123 date time string format (Fri, 29 Nov 2019 15:29:55 GMT)
+   * @brief ISO8601 with milliseconds, "%FT%T.%L%z"
+   * (2019-11-29T23:29:55.123+0800), %L is milliseconds and %f
+   * microseconds, expanded before strftime.
    *
    */
-  constexpr static const char* HTTP = "%a, %d %b %Y %H:%M:%S GMT";
+  static const char ISO8601_MS[];
   /**
-   * @brief Simple date time string format (2019-11-29 23:29:55).
+   * @brief RFC1123 date time string format, "%a, %d %b %Y %H:%M:%S GMT"
+   * (Fri, 29 Nov 2019 15:29:55 GMT)
    *
    */
-  constexpr static const char* SIMPLE = "%F %T";
+  static const char HTTP[];
   /**
-   * @brief Compat date time string format (20191129_232955).
+   * @brief Simple date time string format, "%F %T" (2019-11-29 23:29:55).
    *
    */
-  constexpr static const char* COMPAT = "%Y%m%d_%H%M%S";
+  static const char SIMPLE[];
   /**
-   * @brief Date Only date time string format (2019-11-29).
+   * @brief Compat date time string format, "%Y%m%d_%H%M%S" (20191129_232955).
    *
    */
-  constexpr static const char* DATE_ONLY = "%F";
+  static const char COMPAT[];
   /**
-   * @brief Time Only date time string format (23:29:55).
+   * @brief Date Only date time string format, "%F" (2019-11-29).
    *
    */
-  constexpr static const char* TIME_ONLY = "%T";
+  static const char DATE_ONLY[];
+  /**
+   * @brief Time Only date time string format, "%T" (23:29:55).
+   *
+   */
+  static const char TIME_ONLY[];
   /**
    * @brief utility method for formatting time using fmt.
    *
@@ -210,11 +447,310 @@ struct DateFormatter {
                               const char* timeZone = DEFAULT_TIMEZONE) {
     return DateTimeParts::from(timeSecs, timeZone).format(fmt);
   }
+  /**
+   * @brief utility method for formatting time into caller buffer.
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity, including terminator
+   * @param fmt date time format string
+   * @param timeSecs timestamp value
+   * @param timeZone  timezone offset (-11,13)
+   * @return size_t written length, 0 if not fit
+   */
+  inline static size_t formatTo(char* dst, size_t cap, const char* fmt,
+                                const time_t timeSecs,
+                                const char* timeZone = DEFAULT_TIMEZONE) {
+    return DateTimeParts::from(timeSecs, timeZone).formatTo(dst, cap, fmt);
+  }
+  /**
+   * @brief utility method for formatting time to Print sink.
+   *
+   * @param out print sink
+   * @param fmt date time format string
+   * @param timeSecs timestamp value
+   * @param timeZone  timezone offset (-11,13)
+   * @return size_t written length
+   */
+  inline static size_t formatTo(Print& out, const char* fmt,
+                                const time_t timeSecs,
+                                const char* timeZone = DEFAULT_TIMEZONE) {
+    return DateTimeParts::from(timeSecs, timeZone).formatTo(out, fmt);
+  }
+  /**
+   * @brief utility method for formatting time with a precompiled format tag
+   * or a pattern compiled by CompiledFormat.
+   *
+   * @tparam F format tag, like CompiledFormat<PATTERN>, see DateTimePattern.h
+   * @param timeSecs timestamp value
+   * @param timeZone  timezone offset (-11,13)
+   * @return String string representation of timeSecs
+   */
+  template <typename F>
+  inline static String format(const time_t timeSecs,
+                              const char* timeZone = DEFAULT_TIMEZONE) {
+    return DateTimeParts::from(timeSecs, timeZone).format<F>();
+  }
+  /**
+   * @brief utility method for formatting time with a precompiled format tag.
+   *
+   * @tparam F format tag, like FormatISO8601, see DateTimeFormat.h
+   * @param dst destination buffer
+   * @param cap destination buffer capacity, including terminator
+   * @param timeSecs timestamp value
+   * @param timeZone  timezone offset (-11,13)
+   * @return size_t written length, 0 if not fit
+   */
+  template <typename F>
+  inline static size_t formatTo(char* dst, size_t cap, const time_t timeSecs,
+                                const char* timeZone = DEFAULT_TIMEZONE) {
+    return DateTimeParts::from(timeSecs, timeZone).formatTo<F>(dst, cap);
+  }
+  /**
+   * @brief utility method for formatting time in a compile-time fixed zone.
+   *
+   * @param fmt date time format string
+   * @param timeSecs timestamp value
+   * @param zone fixed zone, like FixedZone<8 * 3600>()
+   * @return String string representation of timeSecs
+   */
+  template <int32_t OFFSET>
+  inline static String format(const char* fmt, const time_t timeSecs,
+                              const FixedZone<OFFSET> zone) {
+    return DateTimeParts::from(timeSecs, zone).format(fmt);
+  }
+  /**
+   * @brief utility method for formatting time in a compile-time fixed zone
+   * into caller buffer.
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity, including terminator
+   * @param fmt date time format string
+   * @param timeSecs timestamp value
+   * @param zone fixed zone, like FixedZone<8 * 3600>()
+   * @return size_t written length, 0 if not fit
+   */
+  template <int32_t OFFSET>
+  inline static size_t formatTo(char* dst, size_t cap, const char* fmt,
+                                const time_t timeSecs,
+                                const FixedZone<OFFSET> zone) {
+    return DateTimeParts::from(timeSecs, zone).formatTo(dst, cap, fmt);
+  }
+  /**
+   * @brief utility method for formatting time in a compile-time fixed zone
+   * with a precompiled format tag, %z is copied from FixedZone::OFFSET_TEXT.
+   *
+   * @tparam F format tag, like FormatISO8601 or CompiledFormat<PATTERN>
+   * @param timeSecs timestamp value
+   * @param zone fixed zone, like FixedZone<8 * 3600>()
+   * @return String string representation of timeSecs
+   */
+  template <typename F, int32_t OFFSET>
+  inline static String format(const time_t timeSecs,
+                              const FixedZone<OFFSET> zone) {
+    char buf[F::LENGTH + 1];
+    formatTo<F>(buf, sizeof(buf), timeSecs, zone);
+    return String(buf);
+  }
+  /**
+   * @brief utility method for formatting time in a compile-time fixed zone
+   * with a precompiled format tag, %z is copied from FixedZone::OFFSET_TEXT.
+   *
+   * @tparam F format tag, like FormatISO8601 or CompiledFormat<PATTERN>
+   * @param dst destination buffer
+   * @param cap destination buffer capacity, including terminator
+   * @param timeSecs timestamp value
+   * @param zone fixed zone, like FixedZone<8 * 3600>()
+   * @return size_t written length, 0 if not fit
+   */
+  template <typename F, int32_t OFFSET>
+  inline static size_t formatTo(char* dst, size_t cap, const time_t timeSecs,
+                                const FixedZone<OFFSET>) {
+    return F::template formatTo<FixedZone<OFFSET>>(
+        dst, cap, DateTimeFields::fromTime(timeSecs, OFFSET));
+  }
+  /**
+   * @brief Records converted at a time by formatBatch(), their fields are
+   * kept on the stack
+   *
+   */
+  constexpr static size_t BATCH_CHUNK = 16;
+  /**
+   * @brief Convert timestamps to local fields, like DateTimeParts::from()
+   * for each. The offset is resolved once per DST segment and sorted input
+   * is converted incrementally, see DateTimeFields::fromTimeBatch().
+   *
+   * @param in timestamps in seconds since 1970
+   * @param n timestamp count
+   * @param out output fields, n records
+   * @param zone parsed time zone rule
+   */
+  static void toPartsBatch(const time_t* in, const size_t n,
+                           DateTimeFields* out, const TimeZoneRule& zone);
+  /**
+   * @brief Convert timestamps to local fields, the TZ string is parsed once
+   *
+   * @param in timestamps in seconds since 1970
+   * @param n timestamp count
+   * @param out output fields, n records
+   * @param timeZone POSIX TZ string
+   */
+  static void toPartsBatch(const time_t* in, const size_t n,
+                           DateTimeFields* out,
+                           const char* timeZone = DEFAULT_TIMEZONE);
+  /**
+   * @brief Convert timestamps to local fields in a compile-time fixed zone
+   *
+   * @param in timestamps in seconds since 1970
+   * @param n timestamp count
+   * @param out output fields, n records
+   * @param zone fixed zone, like FixedZone<8 * 3600>()
+   */
+  template <int32_t OFFSET>
+  inline static void toPartsBatch(const time_t* in, const size_t n,
+                                  DateTimeFields* out,
+                                  const FixedZone<OFFSET>) {
+    DateTimeFields::fromTimeBatch(in, n, out, OFFSET);
+  }
+  /**
+   * @brief Format converted fields to fixed size records, record i starts
+   * at out + i * stride and is always null terminated, empty if not fit.
+   * The DateFormatter constants take the precompiled writers.
+   *
+   * @param fields calendar fields, n records
+   * @param n record count
+   * @param out output buffer, n * stride bytes
+   * @param stride record size, including terminator
+   * @param fmt format string for strftime
+   * @param zone rule for the %Z names, nullptr for the libc zone
+   * @return size_t count of records that fit
+   */
+  static size_t formatFieldsBatch(const DateTimeFields* fields,
+                                  const size_t n, char* out,
+                                  const size_t stride, const char* fmt,
+                                  const TimeZoneRule* zone = nullptr);
+  /**
+   * @brief Format timestamps to fixed size records, like formatTo() for
+   * each but the zone and the format are resolved once, for flushing log
+   * and telemetry buffers.
+   *
+   * @param in timestamps in seconds since 1970, sorted is faster
+   * @param n timestamp count
+   * @param out output buffer, n * stride bytes
+   * @param stride record size, including terminator
+   * @param fmt format string for strftime
+   * @param zone parsed time zone rule
+   * @return size_t count of records that fit
+   */
+  static size_t formatBatch(const time_t* in, const size_t n, char* out,
+                            const size_t stride, const char* fmt,
+                            const TimeZoneRule& zone);
+  /**
+   * @brief Format timestamps to fixed size records, the TZ string is parsed
+   * once
+   *
+   * @param in timestamps in seconds since 1970, sorted is faster
+   * @param n timestamp count
+   * @param out output buffer, n * stride bytes
+   * @param stride record size, including terminator
+   * @param fmt format string for strftime
+   * @param timeZone POSIX TZ string
+   * @return size_t count of records that fit
+   */
+  static size_t formatBatch(const time_t* in, const size_t n, char* out,
+                            const size_t stride, const char* fmt,
+                            const char* timeZone = DEFAULT_TIMEZONE);
+  /**
+   * @brief Format timestamps to fixed size records in a compile-time fixed
+   * zone
+   *
+   * @param in timestamps in seconds since 1970, sorted is faster
+   * @param n timestamp count
+   * @param out output buffer, n * stride bytes
+   * @param stride record size, including terminator
+   * @param fmt format string for strftime
+   * @param zone fixed zone, like FixedZone<8 * 3600>()
+   * @return size_t count of records that fit
+   */
+  template <int32_t OFFSET>
+  static size_t formatBatch(const time_t* in, const size_t n, char* out,
+                            const size_t stride, const char* fmt,
+                            const FixedZone<OFFSET> zone) {
+    // %Z of a fixed zone, <+0800> is named +0800
+    const TimeZoneRule rule(FixedZone<OFFSET>::TIME_ZONE);
+    DateTimeFields fields[BATCH_CHUNK];
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += BATCH_CHUNK) {
+      const size_t m = n - i < BATCH_CHUNK ? n - i : BATCH_CHUNK;
+      toPartsBatch(in + i, m, fields, zone);
+      count += formatFieldsBatch(fields, m, out + i * stride, stride, fmt,
+                                 &rule);
+    }
+    return count;
+  }
+  /**
+   * @brief Format timestamps to fixed size records with a precompiled
+   * format tag, no format string at runtime.
+   *
+   * @tparam F format tag, like FormatISO8601 or CompiledFormat<PATTERN>
+   * @param in timestamps in seconds since 1970, sorted is faster
+   * @param n timestamp count
+   * @param out output buffer, n * stride bytes
+   * @param stride record size, including terminator
+   * @param zone parsed time zone rule
+   * @return size_t count of records that fit
+   */
+  template <typename F>
+  static size_t formatBatch(const time_t* in, const size_t n, char* out,
+                            const size_t stride, const TimeZoneRule& zone) {
+    DateTimeFields fields[BATCH_CHUNK];
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += BATCH_CHUNK) {
+      const size_t m = n - i < BATCH_CHUNK ? n - i : BATCH_CHUNK;
+      toPartsBatch(in + i, m, fields, zone);
+      for (size_t k = 0; k < m; k++) {
+        count += F::formatTo(out + (i + k) * stride, stride, fields[k]) > 0;
+      }
+    }
+    return count;
+  }
+  /**
+   * @brief Format timestamps to fixed size records with a precompiled
+   * format tag in a compile-time fixed zone, %z is a constant.
+   *
+   * @tparam F format tag, like FormatISO8601 or CompiledFormat<PATTERN>
+   * @param in timestamps in seconds since 1970, sorted is faster
+   * @param n timestamp count
+   * @param out output buffer, n * stride bytes
+   * @param stride record size, including terminator
+   * @param zone fixed zone, like FixedZone<8 * 3600>()
+   * @return size_t count of records that fit
+   */
+  template <typename F, int32_t OFFSET>
+  static size_t formatBatch(const time_t* in, const size_t n, char* out,
+                            const size_t stride,
+                            const FixedZone<OFFSET> zone) {
+    DateTimeFields fields[BATCH_CHUNK];
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += BATCH_CHUNK) {
+      const size_t m = n - i < BATCH_CHUNK ? n - i : BATCH_CHUNK;
+      toPartsBatch(in + i, m, fields, zone);
+      for (size_t k = 0; k < m; k++) {
+        count += F::template formatTo<FixedZone<OFFSET>>(
+                     out + (i + k) * stride, stride, fields[k]) > 0;
+      }
+    }
+    return count;
+  }
 };
 
 /**
  * @brief DateTime Library Main Class, include time get/set/format methods.
  *
+ * Getters and format methods may be called from any task or core, they read
+ * a snapshot of the settings without locks. setTime(), setTimeZone() and
+ * setServer() publish a new snapshot. NTP sync methods (begin(),
+ * beginAsync(), poll(), ntpTime()...) are meant for one task, like loop().
+ *
  */
 class DateTimeClass {
  public:
@@ -235,6 +771,28 @@ class DateTimeClass {
    *
    */
   constexpr static unsigned int DEFAULT_TIMEOUT = 10 * 1000;  // milliseconds
+  /**
+   * @brief nowUs() re-reads gettimeofday() after this many microseconds
+   *
+   */
+  constexpr static uint32_t ANCHOR_REFRESH_US = 1000 * 1000;
+  /**
+   * @brief Syncs save to the fallback storage at most once a day, it is
+   * usually flash
+   *
+   */
+  constexpr static uint32_t FALLBACK_SAVE_MS = 24UL * 3600 * 1000;
+  /**
+   * @brief Max sources of addTimeSource()
+   *
+   */
+  constexpr static uint8_t MAX_TIME_SOURCES = 4;
+  /**
+   * @brief poll() writes the synced time to the sources within this much of
+   * the start of a second: 20 milliseconds
+   *
+   */
+  constexpr static uint32_t DISCIPLINE_WINDOW_US = 20 * 1000;
   /**
    * @brief NTP Server 1
    *
@@ -250,6 +808,18 @@ class DateTimeClass {
    *
    */
   constexpr static const char* NTP_SERVER_3 = "time.windows.com";
+  /**
+   * @brief Callback of beginAsync(), called once from poll()
+   *
+   * @param synced true if time valid, false if timeout
+   */
+  typedef std::function<void(bool synced)> SyncCallback;
+  /**
+   * @brief Callback of ntpTimeAsync(), called once from poll()
+   *
+   * @param result ntp time result
+   */
+  typedef std::function<void(const NTPResult& result)> NTPCallback;
   /**
    * @brief Construct a new DateTimeClass object.
    *
@@ -287,11 +857,168 @@ class DateTimeClass {
    */
   bool forceUpdate(const unsigned int timeOutMs = DEFAULT_TIMEOUT);
   /**
-   * @brief Force NTP Sync, but not call setTime().
+   * @brief Start NTP Sync without blocking, call poll() from loop() until
+   * the callback is called.
    *
+   * @param callback called once when time valid or timeout, may be nullptr
    * @param timeOutMs ntp request timeout
+   * @return true if sync started
+   * @return false if a sync is already running
    */
-  time_t ntpTime(const unsigned int timeOutMs = DEFAULT_TIMEOUT);
+  bool beginAsync(SyncCallback callback = nullptr,
+                  const unsigned int timeOutMs = DEFAULT_TIMEOUT);
+  /**
+   * @brief Drive the sync started by beginAsync(), never blocks. Checks the
+   * system time with the same backoff as forceUpdate(), updates the time and
+   * calls the callback when done. Also starts the syncs of setAutoSync()
+   * when due.
+   *
+   * @return NTPSync::State SYNCING while waiting, SYNCED or TIMEOUT when done
+   */
+  NTPSync::State poll();
+  /**
+   * @brief Check a sync started by beginAsync() is running
+   *
+   * @return true if waiting for ntp time
+   */
+  inline bool isSyncing() const { return ntpSync.isSyncing(); }
+  /**
+   * @brief Keep the time synced from poll(). The interval adapts to the
+   * measured drift to stay within the error budget, failures back off
+   * exponentially, and random jitter spreads a fleet of devices.
+   *
+   * With the built-in SNTP client, call sntpUpdate() when isSyncDue() instead
+   * of poll().
+   *
+   * @param enable start or stop scheduling, the first sync is due now
+   * unless the time is already synced, then it is one interval away
+   * @param budgetMs max clock error allowed between syncs
+   */
+  void setAutoSync(const bool enable,
+                   const uint32_t budgetMs = SyncScheduler::DEFAULT_BUDGET_MS);
+  /**
+   * @brief Check the next scheduled sync is due
+   *
+   * @return true if auto sync enabled and due
+   */
+  inline bool isSyncDue() const {
+    return scheduler.isDue(ClockBackend::millis());
+  }
+  /**
+   * @brief Get the resync scheduler, for the next interval and failures
+   *
+   * @return const SyncScheduler& scheduler
+   */
+  inline const SyncScheduler& getScheduler() const { return scheduler; }
+  /**
+   * @brief Wait for valid NTP time, but not call setTime(). Returns as soon
+   * as the time is valid. Reports the system time set by the core sntp, it
+   * does not send a query of its own, use sntpUpdate() for a fresh offset.
+   *
+   * @param timeOutMs ntp request timeout
+   * @return NTPResult time (0 if timeout), wait time, attempts and server
+   */
+  NTPResult ntpTime(const unsigned int timeOutMs = DEFAULT_TIMEOUT);
+  /**
+   * @brief Non-blocking ntpTime(), call poll() from loop() until the
+   * callback is called.
+   *
+   * @param callback called once with the result, may be nullptr
+   * @param timeOutMs ntp request timeout
+   * @return true if started
+   * @return false if a sync is already running
+   */
+  bool ntpTimeAsync(NTPCallback callback,
+                    const unsigned int timeOutMs = DEFAULT_TIMEOUT);
+  /**
+   * @brief Update time with the built-in SNTP client instead of the core
+   * sntp, query the three ntp servers and use the one with the lowest round
+   * trip delay.
+   *
+   * @param transport udp transport, like SNTPUdpTransport over WiFiUDP
+   * @param sample output offset, delay and millisecond time, may be nullptr
+   * @param timeOutMs reply timeout of each server
+   * @return true if any server replied and time valid
+   */
+  bool sntpUpdate(SNTPTransport& transport, SNTPSample* sample = nullptr,
+                  const unsigned int timeOutMs = SNTPClient::DEFAULT_TIMEOUT);
+  /**
+   * @brief Keep the last known good time in storage. begin() restores it
+   * when the time is not valid, every sync saves it to primary and at most
+   * once a day to fallback.
+   *
+   * @param primary storage written on every sync, like RtcTimeStorage
+   * @param fallback storage read if primary has no valid record, like
+   * EEPROMTimeStorage, may be nullptr
+   */
+  void setStorage(TimeStorage* primary, TimeStorage* fallback = nullptr);
+  /**
+   * @brief Save current time, drift estimate and time zone
+   *
+   * @param storage target storage
+   * @return true if time valid and written
+   */
+  bool saveTime(TimeStorage& storage) const;
+  /**
+   * @brief Restore time saved by saveTime(), if the time is not valid yet.
+   * The time since the save is unknown, the restored time assumes the device
+   * rebooted right after it, so it is a lower bound until the next sync. The
+   * system clock is not touched, NTP still sets it.
+   *
+   * Call once at startup, before other tasks read the time.
+   *
+   * @param storage source storage
+   * @param withZone also restore the saved time zone
+   * @return true if a valid record was restored
+   */
+  bool restoreTime(TimeStorage& storage, const bool withZone = true);
+  /**
+   * @brief Check current time comes from storage or a time source and not
+   * a sync yet
+   *
+   * @return true if restored and not synced since
+   */
+  inline bool isTimeRestored() const {
+    return RcuCell<Config>::Reader(config)->restored;
+  }
+  /**
+   * @brief Add a time source, like an RTC chip. begin() reads the sources by
+   * priority when the time is not valid, before the NTP sync. Every NTP sync
+   * writes the time to them, at the start of a second.
+   *
+   * @param source time source, must outlive this object
+   * @return true if added, false if MAX_TIME_SOURCES reached
+   */
+  bool addTimeSource(TimeSource* source);
+  /**
+   * @brief Save the time before deep sleep, call it right before
+   * esp_deep_sleep() or ESP.deepSleep(). Uses the primary storage of
+   * setStorage(), or RtcTimeStorage at block 0.
+   *
+   * @param durationUs requested sleep duration, used if there is no RTC
+   * timer to measure it
+   * @return true if time valid and saved
+   */
+  bool prepareSleep(const uint64_t durationUs);
+  /**
+   * @brief Rebuild the time after a deep sleep wakeup from the record of
+   * prepareSleep(), without a network round trip. The sleep is measured by
+   * the RTC timer that keeps running in deep sleep, the system time on ESP32
+   * and the RTC tick counter on ESP8266 (wraps after about 8 hours). Called
+   * by begin().
+   *
+   * @return true if woke from deep sleep and time restored
+   */
+  bool resumeFromSleep();
+  /**
+   * @brief Sync from a time source instead of NTP, like a GPSTimeSource
+   * when there is no network. The time is a drift sample like an NTP sync,
+   * poll() writes it to the sources of addTimeSource().
+   *
+   * @param source time source
+   * @return true if the source has valid time
+   */
+  bool syncFrom(TimeSource& source);
   /**
    * @brief Set the timestamp from outside, for test only
    *
@@ -304,8 +1031,8 @@ class DateTimeClass {
   /**
    * @brief Format current local time to string
    *
-   * Attention: ESP8266 does not support real timezone, it just add timeZone
-   * 3600 seconds to original timestamp, so %z format is always +0000
+   * Local fields come from the parsed timeZone rule of this object, %z and
+   * %Z too.
    *
    * @param fmt date time format
    * @return String string representation of local time
@@ -318,31 +1045,68 @@ class DateTimeClass {
    * @return String String string representation of utc time
    */
   String formatUTC(const char* fmt);
-  // inline functions
-  //   void formatTo(const char* fmt, char* dst);
   /**
-   * @brief Begin ntp sync to update system time
+   * @brief Format current local time into caller buffer, no heap allocation
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity, including terminator
+   * @param fmt date time format
+   * @return size_t written length, 0 if not fit
+   */
+  size_t formatTo(char* dst, size_t cap, const char* fmt);
+  /**
+   * @brief Format current local time to Print sink, no heap allocation
+   *
+   * @param out print sink
+   * @param fmt date time format
+   * @return size_t written length
+   */
+  size_t formatTo(Print& out, const char* fmt);
+  /**
+   * @brief Format current utc time into caller buffer, no heap allocation
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity, including terminator
+   * @param fmt date time format
+   * @return size_t written length, 0 if not fit
+   */
+  size_t formatUTCTo(char* dst, size_t cap, const char* fmt);
+  /**
+   * @brief Format current utc time to Print sink, no heap allocation
+   *
+   * @param out print sink
+   * @param fmt date time format
+   * @return size_t written length
+   */
+  size_t formatUTCTo(Print& out, const char* fmt);
+  /**
+   * @brief Begin ntp sync to update system time. After a deep sleep it
+   * resumes the time of prepareSleep() without a sync. With a time source
+   * or setStorage(), a restored time returns at once and beginAsync()
+   * refines it, call poll() from loop().
    *
    * @param timeOutMs ntp request timeout
    * @return true if timestamp updated and valid
    * @return false if timestamp not valid
    */
-  inline bool begin(const unsigned int timeOutMs = DEFAULT_TIMEOUT) {
-    return isTimeValid() || forceUpdate(timeOutMs);
-  }
+  bool begin(const unsigned int timeOutMs = DEFAULT_TIMEOUT);
+  // inline functions
   /**
    * @brief Check current timestamp is or not valid time
    *
    * @return true if time valid
    * @return false if time not valid
    */
-  inline bool isTimeValid() const { return bootTimeSecs > SECS_START_POINT; }
+  inline bool isTimeValid() const {
+    return RcuCell<Config>::Reader(config)->bootTimeSecs > SECS_START_POINT;
+  }
   /**
    * @brief Get system boot timestamp in seconds
    *
    * @return time_t boot timestamp
    */
   inline time_t getBootTime() const {
+    const time_t bootTimeSecs = RcuCell<Config>::Reader(config)->bootTimeSecs;
     return bootTimeSecs > SECS_START_POINT ? bootTimeSecs : TIME_ZERO;
   }
   /**
@@ -352,38 +1116,105 @@ class DateTimeClass {
    */
   inline time_t now() const { return getTime(); }
   /**
-   * @brief Get current local timestamp
+   * @brief Get current local timestamp. After the first NTP or SNTP sync
+   * this follows the drift corrected clock, see nowUs().
    *
    * @return time_t timestamp
    */
-  inline time_t getTime() const { return osTime(); }
+  time_t getTime() const;
   /**
    * @brief Get os timestamp, in seconds
    *
    * @return time_t timestamp, in seconds
    */
   inline time_t osTime() const {
-    auto t = time(nullptr);
-    return t > SECS_START_POINT ? t : (time_t)(millis() / 1000);
+    auto t = ClockBackend::time();
+    return t > SECS_START_POINT ? t
+                                : (time_t)(ClockBackend::millis64() / 1000);
   }
+  /**
+   * @brief Get current timestamp, in microseconds. Reads gettimeofday() once
+   * per ANCHOR_REFRESH_US and adds micros() elapsed since then, cheap enough
+   * to call per sample.
+   *
+   * After a sync the local clock is corrected by the estimated drift, and
+   * corrections below ClockDrift::STEP_THRESHOLD_US are slewed, so the
+   * returned time never goes back.
+   *
+   * @return int64_t timestamp in microseconds since 1970, or since boot if
+   * time not valid
+   */
+  int64_t nowUs() const;
+  /**
+   * @brief Get current timestamp, in milliseconds, see nowUs()
+   *
+   * @return int64_t timestamp in milliseconds
+   */
+  inline int64_t nowMs() const { return nowUs() / 1000; }
+  /**
+   * @brief Capture current timestamp in microseconds, safe to call from
+   * interrupt handlers (IRAM, no locks, no libc time calls). Format it later
+   * with getParts(stamp).
+   *
+   * The anchor is refreshed by nowUs(), getParts() and setTime(), call one
+   * of them at least once an hour since micros() wraps after ~71 minutes.
+   *
+   * @return int64_t timestamp in microseconds, like nowUs()
+   */
+  int64_t captureStamp() const;
+  /**
+   * @brief Get DateTimeParts of a captured stamp, in the current timezone
+   *
+   * @param stampUs timestamp from captureStamp() or nowUs()
+   * @return DateTimeParts DateTimeParts object
+   */
+  DateTimeParts getParts(const int64_t stampUs) const;
   /**
    * @brief Get current timezone offset
    *
    * @return int time zone offset
    */
-  inline const char* getTimeZone() const { return timeZone; }
+  inline const char* getTimeZone() const {
+    return RcuCell<Config>::Reader(config)->timeZone;
+  }
+  /**
+   * @brief Get parsed time zone rule of current timezone, a copy since
+   * setTimeZone() may replace it from another task
+   *
+   * @return TimeZoneRule time zone rule
+   */
+  inline TimeZoneRule getTimeZoneRule() const {
+    return RcuCell<Config>::Reader(config)->zoneRule;
+  }
+  /**
+   * @brief Get estimated frequency error of the local clock
+   *
+   * @return double parts per million, positive if the local clock is slow
+   */
+  inline double getDriftPpm() const {
+    return RcuCell<Config>::Reader(config)->clock.freq * 1e6;
+  }
+  /**
+   * @brief Get drift estimator, with sample residuals. Only for the task
+   * that runs the NTP sync.
+   *
+   * @return const ClockDrift& drift estimator
+   */
+  inline const ClockDrift& getClockDrift() const { return drift; }
   /**
    * @brief Get current ntp server address
    *
    * @return const char* ntp server
    */
-  inline const char* getServer() { return ntpServer1; }
+  inline const char* getServer() const {
+    return RcuCell<Config>::Reader(config)->ntpServer1;
+  }
   /**
    * @brief Get DateTimeParts object
    *
    * @return DateTimeParts DateTimeParts object
    */
-  inline DateTimeParts getParts() { return DateTimeParts::from(this); }
+  inline DateTimeParts getParts() const { return getParts(nowUs()); }
   /**
    * @brief String simple string representation of local time
    *
@@ -402,25 +1233,66 @@ class DateTimeClass {
    * @return String string representation
    */
   inline String toUTCString() { return formatUTC(DateFormatter::HTTP); }
+  /**
+   * @brief Simple string representation of local time into caller buffer
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity
+   * @return size_t written length
+   */
+  inline size_t toString(char* dst, size_t cap) {
+    return formatTo(dst, cap, DateFormatter::SIMPLE);
+  }
+  /**
+   * @brief ISO8601 representation of local time into caller buffer
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity
+   * @return size_t written length
+   */
+  inline size_t toISOString(char* dst, size_t cap) {
+    return formatTo(dst, cap, DateFormatter::ISO8601);
+  }
+  /**
+   * @brief RFC1123 representation of utc time into caller buffer
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity
+   * @return size_t written length
+   */
+  inline size_t toUTCString(char* dst, size_t cap) {
+    return formatUTCTo(dst, cap, DateFormatter::HTTP);
+  }
   // operator overloads
   DateTimeClass operator+(const time_t timeDeltaSecs) {
-    DateTimeClass dt(getTime() + timeDeltaSecs, timeZone, ntpServer1);
+    RcuCell<Config>::Reader cfg(config);
+    DateTimeClass dt(getTime() + timeDeltaSecs, cfg->timeZone,
+                     cfg->ntpServer1);
     return dt;
   }
   DateTimeClass operator-(const time_t timeDeltaSecs) {
-    DateTimeClass dt(getTime() - timeDeltaSecs, timeZone, ntpServer1);
+    RcuCell<Config>::Reader cfg(config);
+    DateTimeClass dt(getTime() - timeDeltaSecs, cfg->timeZone,
+                     cfg->ntpServer1);
     return dt;
   }
   DateTimeClass& operator-=(const time_t timeDeltaSecs) {
-    bootTimeSecs += timeDeltaSecs;
+    config.update([timeDeltaSecs](Config& next) {
+      next.bootTimeSecs += timeDeltaSecs;
+      return true;
+    });
     return *this;
   }
   DateTimeClass& operator+=(const time_t timeDeltaSecs) {
-    bootTimeSecs -= timeDeltaSecs;
+    config.update([timeDeltaSecs](Config& next) {
+      next.bootTimeSecs -= timeDeltaSecs;
+      return true;
+    });
     return *this;
   }
   friend bool operator<(const DateTimeClass& lhs, const DateTimeClass& rhs) {
-    return lhs.bootTimeSecs < rhs.bootTimeSecs;
+    return RcuCell<Config>::Reader(lhs.config)->bootTimeSecs <
+           RcuCell<Config>::Reader(rhs.config)->bootTimeSecs;
   }
   friend bool operator>(const DateTimeClass& lhs, const DateTimeClass& rhs) {
     return rhs < lhs;
@@ -433,7 +1305,9 @@ class DateTimeClass {
   }
 
   friend bool operator==(const DateTimeClass& lhs, const DateTimeClass& rhs) {
-    return lhs.bootTimeSecs == rhs.bootTimeSecs && lhs.timeZone == rhs.timeZone;
+    RcuCell<Config>::Reader l(lhs.config);
+    RcuCell<Config>::Reader r(rhs.config);
+    return l->bootTimeSecs == r->bootTimeSecs && l->timeZone == r->timeZone;
   }
   friend bool operator!=(const DateTimeClass& lhs, const DateTimeClass& rhs) {
     return !(lhs == rhs);
@@ -441,23 +1315,81 @@ class DateTimeClass {
 
  private:
   /**
-   * @brief Boot timestamp seconds.
+   * @brief Settings changed by setTime(), setTimeZone() and setServer(),
+   * replaced as a whole so readers on other tasks see either the old or the
+   * new settings, never a mix.
    *
    */
-  unsigned long bootTimeSecs;
+  struct Config {
+    time_t bootTimeSecs;    /**< boot timestamp seconds */
+    const char* timeZone;   /**< POSIX TZ string */
+    TimeZoneRule zoneRule;  /**< parsed timeZone, cache primed */
+    const char* ntpServer1; /**< ntp server addresses */
+    const char* ntpServer2;
+    const char* ntpServer3;
+    ClockModel clock;       /**< drift model, not valid before a sync */
+    bool restored;          /**< time not from a sync yet */
+    uint32_t syncCount;     /**< core sntp updates the model includes */
+  };
+  // getParts() primes the rule cache for a new year with tryUpdate()
+  mutable RcuCell<Config> config;
+  bool ntpMode;
   /**
-   * @brief Time zone offset
+   * @brief State of the running ntp sync.
    *
    */
-  const char* timeZone;
+  NTPSync ntpSync;
   /**
-   * @brief First ntp server address.
+   * @brief Samples of the syncs, owned by the sync task, the fitted model is
+   * published in config.
    *
    */
-  const char* ntpServer1 = NTP_SERVER_1;
-  const char* ntpServer2 = NTP_SERVER_2;
-  const char* ntpServer3 = NTP_SERVER_3;
-  bool ntpMode;
+  ClockDrift drift;
+  /**
+   * @brief Picks the next sync of setAutoSync(), owned by the sync task.
+   *
+   */
+  SyncScheduler scheduler;
+  bool scheduledSync = false;
+  uint32_t scheduledSyncCount = 0;
+  /**
+   * @brief gettimeofday() and micros() read together, for nowUs() and
+   * captureStamp().
+   *
+   */
+  mutable StampAnchor anchor;
+
+  int64_t refreshAnchor() const;
+  NTPCallback syncCallback;
+  bool syncSetTime = false;
+
+  /**
+   * @brief Last known good time of setStorage(), owned by the sync task.
+   *
+   */
+  TimeStorage* storage = nullptr;
+  TimeStorage* fallbackStorage = nullptr;
+  uint64_t fallbackSavedMs = 0;
+  bool fallbackSaved = false;
+  char restoredZone[TimeRecord::ZONE_SIZE] = {0};
+  /**
+   * @brief Sources of addTimeSource() by priority, owned by the sync task.
+   *
+   */
+  TimeSource* sources[MAX_TIME_SOURCES] = {nullptr};
+  uint8_t sourceCount = 0;
+  bool disciplinePending = false;
+  uint64_t disciplineSinceMs = 0;
+
+  void configNtp();
+  bool applySync(const int64_t monoUs, const int64_t utcUs);
+  bool currentRecord(TimeRecord* record) const;
+  bool restoreClock(const int64_t utcUs, const double freq,
+                    const char* timeZone);
+  bool readSources();
+  void disciplineSources(const bool wait);
+  TimeStorage* sleepStorage();
+  void saveSync();
 };
 
 /**
@@ -0,0 +1,149 @@
+#ifndef ESP_DATE_TIME_CIVIL_H
+#define ESP_DATE_TIME_CIVIL_H
+
+/**
+ * @file DateTimeCivil.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime calendar arithmetic
+ *
+ * Integer only days <-> civil date conversion for the proleptic Gregorian
+ * calendar, based on http://howardhinnant.github.io/date_algorithms.html
+ *
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Civil date, year/month/day
+ *
+ */
+struct CivilDate {
+  int32_t year;  /**< year (format: 19xx, 20xx) */
+  uint8_t month; /**< month of year (1-12) */
+  uint8_t day;   /**< day of the month (1-31) */
+};
+
+/**
+ * @brief Reentrant calendar conversions, no static buffers, no libc calls.
+ *
+ */
+struct DateTimeCivil {
+  constexpr static int32_t SECS_PER_DAY = 86400; /**< seconds per day */
+  /**
+   * @brief Days since 1970-01-01 of a civil date
+   *
+   * @param y year
+   * @param m month of year (1-12)
+   * @param d day of the month (1-31)
+   * @return int32_t days since epoch, negative before 1970
+   */
+  static inline int32_t daysFromCivil(int32_t y, const uint32_t m,
+                                      const uint32_t d) {
+    y -= m <= 2;
+    const int32_t era = (y >= 0 ? y : y - 399) / 400;
+    const uint32_t yoe = (uint32_t)(y - era * 400);
+    const uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+  }
+  /**
+   * @brief Civil date of days since 1970-01-01
+   *
+   * @param z days since epoch
+   * @return CivilDate civil date
+   */
+  static inline CivilDate civilFromDays(int32_t z) {
+    z += 719468;
+    const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const uint32_t doe = (uint32_t)(z - era * 146097);
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const uint32_t mp = (5 * doy + 2) / 153;
+    const uint32_t d = doy - (153 * mp + 2) / 5 + 1;
+    const uint32_t m = mp < 10 ? mp + 3 : mp - 9;
+    return {(int32_t)yoe + era * 400 + (m <= 2), (uint8_t)m, (uint8_t)d};
+  }
+  /**
+   * @brief Day of week of days since 1970-01-01
+   *
+   * @param z days since epoch
+   * @return uint8_t days since Sunday (0-6)
+   */
+  static inline uint8_t weekDayFromDays(const int32_t z) {
+    return (uint8_t)(z >= -4 ? (z + 4) % 7 : (z + 5) % 7 + 6);
+  }
+  /**
+   * @brief Check leap year
+   *
+   * @param y year
+   * @return true if leap year
+   */
+  static inline bool isLeapYear(const int32_t y) {
+    return (y % 4 == 0) && (y % 100 != 0 || y % 400 == 0);
+  }
+  /**
+   * @brief Days in a month
+   *
+   * @param y year
+   * @param m month (1-12)
+   * @return uint8_t days (28-31)
+   */
+  static inline uint8_t daysInMonth(const int32_t y, const uint32_t m) {
+    return m == 2 ? (isLeapYear(y) ? 29 : 28)
+                  : (uint8_t)(30 + ((m + (m >> 3)) & 1));
+  }
+  /**
+   * @brief Split timestamp to days since epoch and seconds of day, floored
+   *
+   * @param ts timestamp in seconds
+   * @param secs output seconds of day (0-86399)
+   * @return int32_t days since epoch
+   */
+  static inline int32_t splitDays(const int64_t ts, int32_t* secs) {
+    int32_t days = (int32_t)(ts / SECS_PER_DAY);
+    int32_t rem = (int32_t)(ts % SECS_PER_DAY);
+    if (rem < 0) {
+      rem += SECS_PER_DAY;
+      days--;
+    }
+    *secs = rem;
+    return days;
+  }
+  /**
+   * @brief Split microsecond timestamp to seconds and microseconds, floored
+   *
+   * @param us timestamp in microseconds
+   * @param usec output microseconds of second (0-999999)
+   * @return int64_t timestamp in seconds
+   */
+  static inline int64_t splitMicros(const int64_t us, uint32_t* usec) {
+    int64_t secs = us / 1000000;
+    int32_t rem = (int32_t)(us % 1000000);
+    if (rem < 0) {
+      rem += 1000000;
+      secs--;
+    }
+    *usec = (uint32_t)rem;
+    return secs;
+  }
+  /**
+   * @brief Seconds since epoch of broken-down civil time, like timegm
+   *
+   * @param y year
+   * @param m month of year (1-12)
+   * @param d day of the month (1-31)
+   * @param hh hours (0-23)
+   * @param mm minutes (0-59)
+   * @param ss seconds (0-60)
+   * @return int64_t seconds since epoch
+   */
+  static inline int64_t secondsFromCivil(const int32_t y, const uint32_t m,
+                                         const uint32_t d, const int32_t hh,
+                                         const int32_t mm, const int32_t ss) {
+    return (int64_t)daysFromCivil(y, m, d) * SECS_PER_DAY + hh * 3600 +
+           mm * 60 + ss;
+  }
+};
+
+#endif
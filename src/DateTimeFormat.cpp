@@ -0,0 +1,216 @@
+#include "DateTimeFormat.h"
+
+// one definition each, formatBuiltin() compares the addresses
+const char DateFormatter::ISO8601[] = "%FT%T%z";
+const char DateFormatter::ISO8601_MS[] = "%FT%T.%L%z";
+const char DateFormatter::HTTP[] = "%a, %d %b %Y %H:%M:%S GMT";
+const char DateFormatter::SIMPLE[] = "%F %T";
+const char DateFormatter::COMPAT[] = "%Y%m%d_%H%M%S";
+const char DateFormatter::DATE_ONLY[] = "%F";
+const char DateFormatter::TIME_ONLY[] = "%T";
+
+static const char WEEK_DAY_NAMES[] PROGMEM = "SunMonTueWedThuFriSat";
+static const char MONTH_NAMES[] PROGMEM =
+    "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+char* DateTimeFormat::putWeekDayName(char* p, const uint8_t wday) {
+  memcpy_P(p, WEEK_DAY_NAMES + wday * 3, 3);
+  return p + 3;
+}
+
+char* DateTimeFormat::putMonthName(char* p, const uint8_t month) {
+  memcpy_P(p, MONTH_NAMES + month * 3, 3);
+  return p + 3;
+}
+
+char* DateTimeFormat::putZoneName(char* p, const DateTimeFields& f,
+                                  const TimeZoneRule* zone) {
+  const char* name = zone && zone->isValid()
+                         ? zone->getName(f.isdst > 0)
+                         : tzname[f.isdst > 0 ? 1 : 0];
+  size_t len = 0;
+  while (len < ZONE_NAME_WIDTH && name[len] != '\0') {
+    len++;
+  }
+  memcpy(p, name, len);
+  return p + len;
+}
+
+static inline bool isFieldSpec(const char c, const bool zone) {
+  return c == 'L' || c == 'f' || (zone && (c == 'z' || c == 'Z'));
+}
+
+// strftime with %L and %f replaced by digits, strftime does not know them,
+// and %z and %Z if f is set, newlib strftime takes them from the TZ globals.
+// A pattern longer than the buffer is expanded and formatted in pieces.
+static size_t strftimeFields(char* dst, const size_t cap, const char* fmt,
+                             const struct tm& t, const uint32_t usec,
+                             const DateTimeFields* f,
+                             const TimeZoneRule* zone) {
+  if (cap == 0) {
+    return 0;
+  }
+  const char* s = fmt;
+  while ((s = strchr(s, '%')) != nullptr && !isFieldSpec(s[1], f)) {
+    s += s[1] == '\0' ? 1 : 2;
+  }
+  if (s == nullptr) {
+    // nothing to replace
+    const size_t len = strftime(dst, cap, fmt, &t);
+    if (len == 0) {
+      dst[0] = '\0';
+    }
+    return len;
+  }
+  char buf[ESP_DATE_TIME_FORMAT_BUFFER];
+  // room for the widest replacement and the terminator
+  char* const end = buf + sizeof(buf) - DateTimeFormat::ZONE_NAME_WIDTH - 1;
+  size_t len = 0;
+  s = fmt;
+  while (*s) {
+    char* p = buf;
+    // a piece ends between two specifiers, never inside one
+    for (; *s && p < end; s++) {
+      if (s[0] != '%' || s[1] == '\0') {
+        *p++ = *s;
+        continue;
+      }
+      s++;
+      if (*s == 'L') {
+        p = DateTimeFormat::putMillis(p, usec);
+      } else if (*s == 'f') {
+        p = DateTimeFormat::putMicros(p, usec);
+      } else if (f && *s == 'z') {
+        p = DateTimeFormat::putOffset(p, f->offset);
+      } else if (f && *s == 'Z') {
+        p = DateTimeFormat::putZoneName(p, *f, zone);
+      } else {
+        *p++ = '%';
+        *p++ = *s;
+        // %E and %O modify the next conversion
+        if ((*s == 'E' || *s == 'O') && s[1] != '\0') {
+          *p++ = *++s;
+        }
+      }
+    }
+    *p = '\0';
+    const size_t n = strftime(dst + len, cap - len, buf, &t);
+    if (n == 0 && buf[0] != '\0') {
+      dst[0] = '\0';
+      return 0;
+    }
+    len += n;
+  }
+  return len;
+}
+
+size_t DateTimeFormat::strftimeTo(char* dst, size_t cap, const char* fmt,
+                                  const struct tm& t, const uint32_t usec) {
+  return strftimeFields(dst, cap, fmt, t, usec, nullptr, nullptr);
+}
+
+size_t DateTimeFormat::strftimeTo(char* dst, size_t cap, const char* fmt,
+                                  const DateTimeFields& f,
+                                  const TimeZoneRule* zone) {
+  const struct tm t = f.toTm();
+  return strftimeFields(dst, cap, fmt, t, f.usec, &f, zone);
+}
+
+int DateTimeFormat::formatBuiltin(char* dst, size_t cap, const char* fmt,
+                                  const DateTimeFields& f) {
+  // DateFormatter constants are compared by address, other strings with
+  // the same content just take the strftime path
+  if (fmt == DateFormatter::ISO8601) {
+    return (int)formatFields<FormatISO8601>(dst, cap, f);
+  } else if (fmt == DateFormatter::ISO8601_MS) {
+    return (int)formatFields<FormatISO8601Ms>(dst, cap, f);
+  } else if (fmt == DateFormatter::SIMPLE) {
+    return (int)formatFields<FormatSimple>(dst, cap, f);
+  } else if (fmt == DateFormatter::HTTP) {
+    return (int)formatFields<FormatHTTP>(dst, cap, f);
+  } else if (fmt == DateFormatter::COMPAT) {
+    return (int)formatFields<FormatCompat>(dst, cap, f);
+  } else if (fmt == DateFormatter::DATE_ONLY) {
+    return (int)formatFields<FormatDateOnly>(dst, cap, f);
+  } else if (fmt == DateFormatter::TIME_ONLY) {
+    return (int)formatFields<FormatTimeOnly>(dst, cap, f);
+  }
+  return -1;
+}
+
+void DateFormatter::toPartsBatch(const time_t* in, const size_t n,
+                                 DateTimeFields* out,
+                                 const TimeZoneRule& zone) {
+  size_t i = 0;
+  while (i < n) {
+    int64_t begin, end;
+    int8_t isdst;
+    const int32_t offset = zone.offsetSpan(in[i], &begin, &end, &isdst);
+    size_t next = i + 1;
+    while (next < n && (int64_t)in[next] >= begin &&
+           (int64_t)in[next] < end) {
+      next++;
+    }
+    DateTimeFields::fromTimeBatch(in + i, next - i, out + i, offset, isdst);
+    i = next;
+  }
+}
+
+void DateFormatter::toPartsBatch(const time_t* in, const size_t n,
+                                 DateTimeFields* out, const char* timeZone) {
+  TimeZoneRule zone(timeZone);
+  if (zone.isValid()) {
+    toPartsBatch(in, n, out, zone);
+    return;
+  }
+  // not a POSIX TZ string, libc converts each
+  for (size_t i = 0; i < n; i++) {
+    out[i] = DateTimeParts::from(in[i], timeZone)._fields;
+  }
+}
+
+size_t DateFormatter::formatFieldsBatch(const DateTimeFields* fields,
+                                        const size_t n, char* out,
+                                        const size_t stride,
+                                        const char* fmt,
+                                        const TimeZoneRule* zone) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    char* dst = out + i * stride;
+    int len = DateTimeFormat::formatBuiltin(dst, stride, fmt, fields[i]);
+    if (len < 0) {
+      len = (int)DateTimeFormat::strftimeTo(dst, stride, fmt, fields[i],
+                                            zone);
+    }
+    count += len > 0;
+  }
+  return count;
+}
+
+size_t DateFormatter::formatBatch(const time_t* in, const size_t n, char* out,
+                                  const size_t stride, const char* fmt,
+                                  const TimeZoneRule& zone) {
+  DateTimeFields fields[BATCH_CHUNK];
+  size_t count = 0;
+  for (size_t i = 0; i < n; i += BATCH_CHUNK) {
+    const size_t m = n - i < BATCH_CHUNK ? n - i : BATCH_CHUNK;
+    toPartsBatch(in + i, m, fields, zone);
+    count +=
+        formatFieldsBatch(fields, m, out + i * stride, stride, fmt, &zone);
+  }
+  return count;
+}
+
+size_t DateFormatter::formatBatch(const time_t* in, const size_t n, char* out,
+                                  const size_t stride, const char* fmt,
+                                  const char* timeZone) {
+  TimeZoneRule zone(timeZone);
+  if (zone.isValid()) {
+    return formatBatch(in, n, out, stride, fmt, zone);
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    count += formatTo(out + i * stride, stride, fmt, in[i], timeZone) > 0;
+  }
+  return count;
+}
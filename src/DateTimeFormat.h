@@ -0,0 +1,398 @@
+#ifndef ESP_DATE_TIME_FORMAT_H
+#define ESP_DATE_TIME_FORMAT_H
+
+/**
+ * @file DateTimeFormat.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime fast path formatters
+ *
+ */
+
+#include "DateTime.h"
+
+struct FieldsZone;
+
+/**
+ * @brief Digit writers and dispatch for the built-in DateFormatter formats,
+ * output is byte-identical to strftime but without format string parsing.
+ *
+ */
+struct DateTimeFormat {
+  /**
+   * @brief Write two digits, zero padded
+   *
+   * @param p output position
+   * @param v value (0-99)
+   * @return char* next output position
+   */
+  static inline char* put2(char* p, const uint32_t v) {
+    p[0] = (char)('0' + v / 10);
+    p[1] = (char)('0' + v % 10);
+    return p + 2;
+  }
+  /**
+   * @brief Write four digits, zero padded
+   *
+   * @param p output position
+   * @param v value (0-9999)
+   * @return char* next output position
+   */
+  static inline char* put4(char* p, const uint32_t v) {
+    return put2(put2(p, v / 100), v % 100);
+  }
+  /**
+   * @brief Write three digits, zero padded
+   *
+   * @param p output position
+   * @param v value (0-999)
+   * @return char* next output position
+   */
+  static inline char* put3(char* p, const uint32_t v) {
+    *p++ = (char)('0' + v / 100);
+    return put2(p, v % 100);
+  }
+  /**
+   * @brief Write milliseconds as %L (123)
+   *
+   * @param p output position
+   * @param usec microseconds after the second (0-999999)
+   * @return char* next output position
+   */
+  static inline char* putMillis(char* p, const uint32_t usec) {
+    return put3(p, usec / 1000);
+  }
+  /**
+   * @brief Write microseconds as %f (123456)
+   *
+   * @param p output position
+   * @param usec microseconds after the second (0-999999)
+   * @return char* next output position
+   */
+  static inline char* putMicros(char* p, const uint32_t usec) {
+    return put3(put3(p, usec / 1000), usec % 1000);
+  }
+  /**
+   * @brief Write date part as strftime %F (2019-11-29)
+   *
+   * @param p output position
+   * @param f calendar fields
+   * @return char* next output position
+   */
+  static inline char* putDate(char* p, const DateTimeFields& f) {
+    p = put4(p, f.year);
+    *p++ = '-';
+    p = put2(p, f.month + 1);
+    *p++ = '-';
+    return put2(p, f.mday);
+  }
+  /**
+   * @brief Write time part as strftime %T (23:29:55)
+   *
+   * @param p output position
+   * @param f calendar fields
+   * @return char* next output position
+   */
+  static inline char* putTime(char* p, const DateTimeFields& f) {
+    p = put2(p, f.hour);
+    *p++ = ':';
+    p = put2(p, f.minute);
+    *p++ = ':';
+    return put2(p, f.second);
+  }
+  /**
+   * @brief Write utc offset as strftime %z (+0800)
+   *
+   * @param p output position
+   * @param offset seconds east of UTC
+   * @return char* next output position
+   */
+  static inline char* putOffset(char* p, const int32_t offset) {
+    uint32_t mins = (uint32_t)(offset < 0 ? -offset : offset) / 60;
+    *p++ = offset < 0 ? '-' : '+';
+    return put2(put2(p, mins / 60), mins % 60);
+  }
+  /**
+   * @brief Max width of a zone abbreviation written for %Z
+   *
+   */
+  constexpr static size_t ZONE_NAME_WIDTH = 16;
+  /**
+   * @brief Write zone abbreviation as strftime %Z (CST), from zone if it is
+   * valid, else from the libc zone
+   *
+   * @param p output position
+   * @param f calendar fields, isdst picks the name
+   * @param zone rule the fields are in, may be nullptr
+   * @return char* next output position
+   */
+  static char* putZoneName(char* p, const DateTimeFields& f,
+                           const TimeZoneRule* zone = nullptr);
+  /**
+   * @brief Write abbreviated weekday name as strftime %a (Fri)
+   *
+   * @param p output position
+   * @param wday days since Sunday (0-6)
+   * @return char* next output position
+   */
+  static char* putWeekDayName(char* p, const uint8_t wday);
+  /**
+   * @brief Write abbreviated month name as strftime %b (Nov)
+   *
+   * @param p output position
+   * @param month months since January (0-11)
+   * @return char* next output position
+   */
+  static char* putMonthName(char* p, const uint8_t month);
+  /**
+   * @brief Check the year fits the four digits fast path
+   *
+   * @param f calendar fields
+   * @return true if 1000 <= year <= 9999
+   */
+  static inline bool hasFourDigitYear(const DateTimeFields& f) {
+    return f.year >= 1000 && f.year <= 9999;
+  }
+  /**
+   * @brief strftime into caller buffer, always null terminated if cap > 0,
+   * %L (milliseconds) and %f (microseconds) are expanded first, a pattern
+   * longer than ESP_DATE_TIME_FORMAT_BUFFER piece by piece.
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity
+   * @param fmt format string for strftime
+   * @param t broken-down time
+   * @param usec microseconds after the second, for %L and %f
+   * @return size_t written length, 0 if not fit
+   */
+  static size_t strftimeTo(char* dst, size_t cap, const char* fmt,
+                           const struct tm& t, const uint32_t usec = 0);
+  /**
+   * @brief strftime of calendar fields, %L, %f, %z and %Z are expanded first
+   * from the fields and the zone. newlib strftime would take %z and %Z from
+   * the TZ globals, not from the fields.
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity
+   * @param fmt format string for strftime
+   * @param f calendar fields
+   * @param zone rule for the %Z names, nullptr for the libc zone
+   * @return size_t written length, 0 if not fit
+   */
+  static size_t strftimeTo(char* dst, size_t cap, const char* fmt,
+                           const DateTimeFields& f,
+                           const TimeZoneRule* zone = nullptr);
+  /**
+   * @brief Format using the precompiled writer if fmt is one of the
+   * DateFormatter constants, compared by pointer.
+   *
+   * @param dst destination buffer
+   * @param cap destination buffer capacity
+   * @param fmt format string, DateFormatter constant
+   * @param f calendar fields
+   * @return int written length, -1 if fmt is not a built-in format
+   */
+  static int formatBuiltin(char* dst, size_t cap, const char* fmt,
+                           const DateTimeFields& f);
+  /**
+   * @brief Format fields using precompiled writer of format tag F, fall back
+   * to strftime if the fields are out of the fast path range.
+   *
+   * @tparam F format tag, like FormatISO8601
+   * @tparam Z zone writing %z, FieldsZone or a FixedZone
+   * @param dst destination buffer
+   * @param cap destination buffer capacity
+   * @param f calendar fields
+   * @return size_t written length, 0 if not fit
+   */
+  template <typename F, typename Z = FieldsZone>
+  static size_t formatFields(char* dst, size_t cap, const DateTimeFields& f) {
+    if (!F::supports(f)) {
+      return strftimeTo(dst, cap, F::pattern(), f);
+    }
+    if (cap > F::LENGTH) {
+      char* end = F::template write<Z>(dst, f);
+      *end = '\0';
+      return (size_t)(end - dst);
+    }
+    // LENGTH is an upper bound, output may still fit the small buffer
+    char buf[F::LENGTH + 1];
+    size_t len = (size_t)(F::template write<Z>(buf, f) - buf);
+    if (len >= cap) {
+      if (cap > 0) {
+        dst[0] = '\0';
+      }
+      return 0;
+    }
+    memcpy(dst, buf, len);
+    dst[len] = '\0';
+    return len;
+  }
+};
+
+/**
+ * @brief Zone of the precompiled writers when the zone is known at runtime,
+ * %z is written from DateTimeFields::offset and %Z is the libc zone name.
+ * FixedZone writes constants.
+ *
+ */
+struct FieldsZone {
+  static inline char* putOffset(char* p, const DateTimeFields& f) {
+    return DateTimeFormat::putOffset(p, f.offset);
+  }
+  static inline char* putZoneName(char* p, const DateTimeFields& f) {
+    return DateTimeFormat::putZoneName(p, f);
+  }
+};
+
+/**
+ * @brief Base of the precompiled format tags, provides the static formatTo()
+ * used by DateTimeParts::formatTo<F>() and DateFormatter::formatTo<F>().
+ *
+ * @tparam F format tag
+ */
+template <typename F>
+struct BuiltinFormat {
+  template <typename Z = FieldsZone>
+  static size_t formatTo(char* dst, size_t cap, const DateTimeFields& f) {
+    return DateTimeFormat::formatFields<F, Z>(dst, cap, f);
+  }
+};
+
+/**
+ * @brief Precompiled DateFormatter::ISO8601 (2019-11-29T23:29:55+0800)
+ *
+ */
+struct FormatISO8601 : BuiltinFormat<FormatISO8601> {
+  constexpr static size_t LENGTH = 24; /**< max output length */
+  static const char* pattern() { return DateFormatter::ISO8601; }
+  static bool supports(const DateTimeFields& f) {
+    return DateTimeFormat::hasFourDigitYear(f);
+  }
+  template <typename Z = FieldsZone>
+  static char* write(char* p, const DateTimeFields& f) {
+    p = DateTimeFormat::putDate(p, f);
+    *p++ = 'T';
+    p = DateTimeFormat::putTime(p, f);
+    return Z::putOffset(p, f);
+  }
+};
+
+/**
+ * @brief Precompiled DateFormatter::ISO8601_MS (2019-11-29T23:29:55.123+0800)
+ *
+ */
+struct FormatISO8601Ms : BuiltinFormat<FormatISO8601Ms> {
+  constexpr static size_t LENGTH = 28; /**< max output length */
+  static const char* pattern() { return DateFormatter::ISO8601_MS; }
+  static bool supports(const DateTimeFields& f) {
+    return DateTimeFormat::hasFourDigitYear(f);
+  }
+  template <typename Z = FieldsZone>
+  static char* write(char* p, const DateTimeFields& f) {
+    p = DateTimeFormat::putDate(p, f);
+    *p++ = 'T';
+    p = DateTimeFormat::putTime(p, f);
+    *p++ = '.';
+    p = DateTimeFormat::putMillis(p, f.usec);
+    return Z::putOffset(p, f);
+  }
+};
+
+/**
+ * @brief Precompiled DateFormatter::HTTP (Fri, 29 Nov 2019 15:29:55 GMT)
+ *
+ */
+struct FormatHTTP : BuiltinFormat<FormatHTTP> {
+  constexpr static size_t LENGTH = 29; /**< max output length */
+  static const char* pattern() { return DateFormatter::HTTP; }
+  static bool supports(const DateTimeFields& f) {
+    return DateTimeFormat::hasFourDigitYear(f) && f.wday < 7 && f.month < 12;
+  }
+  template <typename Z = FieldsZone>
+  static char* write(char* p, const DateTimeFields& f) {
+    p = DateTimeFormat::putWeekDayName(p, f.wday);
+    *p++ = ',';
+    *p++ = ' ';
+    p = DateTimeFormat::put2(p, f.mday);
+    *p++ = ' ';
+    p = DateTimeFormat::putMonthName(p, f.month);
+    *p++ = ' ';
+    p = DateTimeFormat::put4(p, f.year);
+    *p++ = ' ';
+    p = DateTimeFormat::putTime(p, f);
+    memcpy(p, " GMT", 4);
+    return p + 4;
+  }
+};
+
+/**
+ * @brief Precompiled DateFormatter::SIMPLE (2019-11-29 23:29:55)
+ *
+ */
+struct FormatSimple : BuiltinFormat<FormatSimple> {
+  constexpr static size_t LENGTH = 19; /**< max output length */
+  static const char* pattern() { return DateFormatter::SIMPLE; }
+  static bool supports(const DateTimeFields& f) {
+    return DateTimeFormat::hasFourDigitYear(f);
+  }
+  template <typename Z = FieldsZone>
+  static char* write(char* p, const DateTimeFields& f) {
+    p = DateTimeFormat::putDate(p, f);
+    *p++ = ' ';
+    return DateTimeFormat::putTime(p, f);
+  }
+};
+
+/**
+ * @brief Precompiled DateFormatter::COMPAT (20191129_232955)
+ *
+ */
+struct FormatCompat : BuiltinFormat<FormatCompat> {
+  constexpr static size_t LENGTH = 15; /**< max output length */
+  static const char* pattern() { return DateFormatter::COMPAT; }
+  static bool supports(const DateTimeFields& f) {
+    return DateTimeFormat::hasFourDigitYear(f);
+  }
+  template <typename Z = FieldsZone>
+  static char* write(char* p, const DateTimeFields& f) {
+    p = DateTimeFormat::put4(p, f.year);
+    p = DateTimeFormat::put2(p, f.month + 1);
+    p = DateTimeFormat::put2(p, f.mday);
+    *p++ = '_';
+    p = DateTimeFormat::put2(p, f.hour);
+    p = DateTimeFormat::put2(p, f.minute);
+    return DateTimeFormat::put2(p, f.second);
+  }
+};
+
+/**
+ * @brief Precompiled DateFormatter::DATE_ONLY (2019-11-29)
+ *
+ */
+struct FormatDateOnly : BuiltinFormat<FormatDateOnly> {
+  constexpr static size_t LENGTH = 10; /**< max output length */
+  static const char* pattern() { return DateFormatter::DATE_ONLY; }
+  static bool supports(const DateTimeFields& f) {
+    return DateTimeFormat::hasFourDigitYear(f);
+  }
+  template <typename Z = FieldsZone>
+  static char* write(char* p, const DateTimeFields& f) {
+    return DateTimeFormat::putDate(p, f);
+  }
+};
+
+/**
+ * @brief Precompiled DateFormatter::TIME_ONLY (23:29:55)
+ *
+ */
+struct FormatTimeOnly : BuiltinFormat<FormatTimeOnly> {
+  constexpr static size_t LENGTH = 8; /**< max output length */
+  static const char* pattern() { return DateFormatter::TIME_ONLY; }
+  static bool supports(const DateTimeFields&) { return true; }
+  template <typename Z = FieldsZone>
+  static char* write(char* p, const DateTimeFields& f) {
+    return DateTimeFormat::putTime(p, f);
+  }
+};
+
+#endif
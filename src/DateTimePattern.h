@@ -0,0 +1,500 @@
+#ifndef ESP_DATE_TIME_PATTERN_H
+#define ESP_DATE_TIME_PATTERN_H
+
+/**
+ * @file DateTimePattern.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime compile-time format pattern compiler
+ *
+ * A strftime style pattern declared as a constexpr char array is parsed at
+ * compile time into a sequence of field writer ops, no format string is
+ * parsed at runtime:
+ *
+ *     constexpr char LOG_FILE[] = "%Y%m%d-%H";
+ *     char buf[16];
+ *     DateTime.getParts().formatTo<CompiledFormat<LOG_FILE>>(buf, 16);
+ *
+ * %L (milliseconds) and %f (microseconds) write DateTimeFields::usec, %z
+ * and %Z are written by the zone. Unknown specifiers are rejected by
+ * static_assert. Locale dependent specifiers (%A %B %c %x %X %U %W %V %G %g
+ * %s) are kept and handed to strftime one by one.
+ *
+ */
+
+#include "DateTimeFormat.h"
+
+/**
+ * @brief constexpr helpers for parsing strftime patterns, C++11 compatible.
+ *
+ */
+struct FormatPattern {
+  /**
+   * @brief Field writer op kinds
+   *
+   */
+  enum OpKind : uint8_t {
+    OP_INVALID = 0,
+    OP_LITERAL,
+    OP_YEAR,          // %Y
+    OP_YEAR_2,        // %y
+    OP_CENTURY,       // %C
+    OP_MONTH,         // %m
+    OP_MONTH_DAY,     // %d
+    OP_MONTH_DAY_SP,  // %e
+    OP_YEAR_DAY,      // %j
+    OP_HOUR,          // %H
+    OP_HOUR_12,       // %I
+    OP_MINUTE,        // %M
+    OP_SECOND,        // %S
+    OP_WEEK_DAY,      // %w
+    OP_WEEK_DAY_ISO,  // %u
+    OP_WEEK_DAY_NAME, // %a
+    OP_MONTH_NAME,    // %b %h
+    OP_AM_PM,         // %p
+    OP_DATE,          // %F
+    OP_TIME,          // %T
+    OP_HOUR_MINUTE,   // %R
+    OP_US_DATE,       // %D
+    OP_TIME_12,       // %r
+    OP_OFFSET,        // %z
+    OP_ZONE_NAME,     // %Z
+    OP_MILLIS,        // %L
+    OP_MICROS,        // %f
+    OP_PERCENT,       // %%
+    OP_NEWLINE,       // %n
+    OP_TAB,           // %t
+    OP_STRFTIME,      // handed to strftime
+  };
+  /**
+   * @brief Op kind of a conversion specifier character
+   *
+   */
+  constexpr static uint8_t specKind(const char c) {
+    return c == 'Y'   ? OP_YEAR
+           : c == 'y' ? OP_YEAR_2
+           : c == 'C' ? OP_CENTURY
+           : c == 'm' ? OP_MONTH
+           : c == 'd' ? OP_MONTH_DAY
+           : c == 'e' ? OP_MONTH_DAY_SP
+           : c == 'j' ? OP_YEAR_DAY
+           : c == 'H' ? OP_HOUR
+           : c == 'I' ? OP_HOUR_12
+           : c == 'M' ? OP_MINUTE
+           : c == 'S' ? OP_SECOND
+           : c == 'w' ? OP_WEEK_DAY
+           : c == 'u' ? OP_WEEK_DAY_ISO
+           : c == 'a' ? OP_WEEK_DAY_NAME
+           : (c == 'b' || c == 'h') ? OP_MONTH_NAME
+           : c == 'p' ? OP_AM_PM
+           : c == 'F' ? OP_DATE
+           : c == 'T' ? OP_TIME
+           : c == 'R' ? OP_HOUR_MINUTE
+           : c == 'D' ? OP_US_DATE
+           : c == 'r' ? OP_TIME_12
+           : c == 'z' ? OP_OFFSET
+           : c == 'Z' ? OP_ZONE_NAME
+           : c == 'L' ? OP_MILLIS
+           : c == 'f' ? OP_MICROS
+           : c == '%' ? OP_PERCENT
+           : c == 'n' ? OP_NEWLINE
+           : c == 't' ? OP_TAB
+           : strftimeWidth(c) > 0 ? OP_STRFTIME
+                                  : OP_INVALID;
+  }
+  /**
+   * @brief Max output width of the specifiers handed to strftime, 0 if the
+   * character is not a supported specifier
+   *
+   */
+  constexpr static size_t strftimeWidth(const char c) {
+    return (c == 'A' || c == 'B')               ? 9
+           : c == 'c'                           ? 24
+           : (c == 'x' || c == 'X')             ? 8
+           : (c == 'U' || c == 'W' || c == 'V') ? 2
+           : c == 'G'                           ? 4
+           : c == 'g'                           ? 2
+           : c == 's'                           ? 20
+                                                : 0;
+  }
+  /**
+   * @brief Max output width of an op
+   *
+   */
+  constexpr static size_t opWidth(const uint8_t kind, const char c) {
+    return kind == OP_YEAR ? 4
+           : (kind == OP_YEAR_DAY || kind == OP_WEEK_DAY_NAME ||
+              kind == OP_MONTH_NAME || kind == OP_MILLIS)
+               ? 3
+           : kind == OP_MICROS ? 6
+           : (kind == OP_LITERAL || kind == OP_WEEK_DAY ||
+              kind == OP_WEEK_DAY_ISO || kind == OP_PERCENT ||
+              kind == OP_NEWLINE || kind == OP_TAB)
+               ? 1
+           : kind == OP_DATE                               ? 10
+           : (kind == OP_TIME || kind == OP_US_DATE)       ? 8
+           : (kind == OP_HOUR_MINUTE || kind == OP_OFFSET) ? 5
+           : kind == OP_TIME_12                            ? 11
+           : kind == OP_STRFTIME                           ? strftimeWidth(c)
+           : kind == OP_ZONE_NAME ? DateTimeFormat::ZONE_NAME_WIDTH
+                                  : 2;
+  }
+  /**
+   * @brief Length of the token starting at pos, 2 for a specifier
+   *
+   */
+  constexpr static size_t step(const char* s, const size_t pos) {
+    return s[pos] == '%' && s[pos + 1] != '\0' ? 2 : 1;
+  }
+  /**
+   * @brief Number of tokens (literal chars and specifiers) in pattern
+   *
+   */
+  constexpr static size_t count(const char* s, const size_t pos = 0) {
+    return s[pos] == '\0' ? 0 : 1 + count(s, pos + step(s, pos));
+  }
+  /**
+   * @brief Start position of the token at index
+   *
+   */
+  constexpr static size_t position(const char* s, const size_t index,
+                                   const size_t pos = 0) {
+    return index == 0 ? pos : position(s, index - 1, pos + step(s, pos));
+  }
+  /**
+   * @brief Op kind of the token at index
+   *
+   */
+  constexpr static uint8_t kindAt(const char* s, const size_t index) {
+    return s[position(s, index)] == '%'
+               ? specKind(s[position(s, index) + 1])
+               : (uint8_t)OP_LITERAL;
+  }
+  /**
+   * @brief Literal or specifier character of the token at index
+   *
+   */
+  constexpr static char charAt(const char* s, const size_t index) {
+    return s[position(s, index)] == '%' ? s[position(s, index) + 1]
+                                        : s[position(s, index)];
+  }
+  /**
+   * @brief Max output length of the tokens from index to the end
+   *
+   */
+  constexpr static size_t maxLength(const char* s, const size_t index,
+                                    const size_t n) {
+    return index >= n ? 0
+                      : opWidth(kindAt(s, index), charAt(s, index)) +
+                            maxLength(s, index + 1, n);
+  }
+};
+
+/**
+ * @brief Field writer for one op kind, the primary template is only
+ * instantiated for invalid specifiers.
+ *
+ * @tparam K op kind
+ */
+template <uint8_t K>
+struct PatternOp {
+  static_assert(K != FormatPattern::OP_INVALID,
+                "unsupported strftime specifier in pattern");
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_LITERAL> {
+  static inline char* write(char* p, const DateTimeFields&, const char c) {
+    *p = c;
+    return p + 1;
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_YEAR> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::put4(p, f.year);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_YEAR_2> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::put2(p, f.year % 100);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_CENTURY> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::put2(p, f.year / 100);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_MONTH> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::put2(p, f.month + 1);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_MONTH_DAY> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::put2(p, f.mday);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_MONTH_DAY_SP> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    DateTimeFormat::put2(p, f.mday);
+    if (f.mday < 10) {
+      p[0] = ' ';
+    }
+    return p + 2;
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_YEAR_DAY> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    *p++ = (char)('0' + (f.yday + 1) / 100);
+    return DateTimeFormat::put2(p, (f.yday + 1) % 100);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_HOUR> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::put2(p, f.hour);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_HOUR_12> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::put2(p, f.hour % 12 == 0 ? 12 : f.hour % 12);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_MINUTE> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::put2(p, f.minute);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_SECOND> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::put2(p, f.second);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_WEEK_DAY> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    *p = (char)('0' + f.wday);
+    return p + 1;
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_WEEK_DAY_ISO> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    *p = (char)(f.wday == 0 ? '7' : '0' + f.wday);
+    return p + 1;
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_WEEK_DAY_NAME> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::putWeekDayName(p, f.wday);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_MONTH_NAME> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::putMonthName(p, f.month);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_AM_PM> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    p[0] = f.hour < 12 ? 'A' : 'P';
+    p[1] = 'M';
+    return p + 2;
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_DATE> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::putDate(p, f);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_TIME> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::putTime(p, f);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_HOUR_MINUTE> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    p = DateTimeFormat::put2(p, f.hour);
+    *p++ = ':';
+    return DateTimeFormat::put2(p, f.minute);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_US_DATE> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    p = DateTimeFormat::put2(p, f.month + 1);
+    *p++ = '/';
+    p = DateTimeFormat::put2(p, f.mday);
+    *p++ = '/';
+    return DateTimeFormat::put2(p, f.year % 100);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_TIME_12> {
+  static inline char* write(char* p, const DateTimeFields& f, const char c) {
+    p = PatternOp<FormatPattern::OP_HOUR_12>::write(p, f, c);
+    *p++ = ':';
+    p = DateTimeFormat::put2(p, f.minute);
+    *p++ = ':';
+    p = DateTimeFormat::put2(p, f.second);
+    *p++ = ' ';
+    return PatternOp<FormatPattern::OP_AM_PM>::write(p, f, c);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_OFFSET> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::putOffset(p, f.offset);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_MILLIS> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::putMillis(p, f.usec);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_MICROS> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return DateTimeFormat::putMicros(p, f.usec);
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_PERCENT> {
+  static inline char* write(char* p, const DateTimeFields&, const char) {
+    *p = '%';
+    return p + 1;
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_NEWLINE> {
+  static inline char* write(char* p, const DateTimeFields&, const char) {
+    *p = '\n';
+    return p + 1;
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_TAB> {
+  static inline char* write(char* p, const DateTimeFields&, const char) {
+    *p = '\t';
+    return p + 1;
+  }
+};
+
+template <>
+struct PatternOp<FormatPattern::OP_STRFTIME> {
+  static inline char* write(char* p, const DateTimeFields& f, const char c) {
+    const char spec[3] = {'%', c, '\0'};
+    const struct tm t = f.toTm();
+    return p + strftime(p, FormatPattern::strftimeWidth(c) + 1, spec, &t);
+  }
+};
+
+/**
+ * @brief Op writer in a zone, %z and %Z are written by the zone Z
+ *
+ * @tparam K op kind
+ * @tparam Z zone, FieldsZone or a FixedZone
+ */
+template <uint8_t K, typename Z>
+struct ZonedPatternOp {
+  static inline char* write(char* p, const DateTimeFields& f, const char c) {
+    return PatternOp<K>::write(p, f, c);
+  }
+};
+
+template <typename Z>
+struct ZonedPatternOp<FormatPattern::OP_OFFSET, Z> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return Z::putOffset(p, f);
+  }
+};
+
+template <typename Z>
+struct ZonedPatternOp<FormatPattern::OP_ZONE_NAME, Z> {
+  static inline char* write(char* p, const DateTimeFields& f, const char) {
+    return Z::putZoneName(p, f);
+  }
+};
+
+/**
+ * @brief Unrolled op sequence of pattern P, from token I to N
+ *
+ */
+template <const char* P, size_t I, size_t N, typename Z>
+struct PatternOps {
+  static inline char* write(char* p, const DateTimeFields& f) {
+    p = ZonedPatternOp<FormatPattern::kindAt(P, I), Z>::write(
+        p, f, FormatPattern::charAt(P, I));
+    return PatternOps<P, I + 1, N, Z>::write(p, f);
+  }
+};
+
+template <const char* P, size_t N, typename Z>
+struct PatternOps<P, N, N, Z> {
+  static inline char* write(char* p, const DateTimeFields&) { return p; }
+};
+
+/**
+ * @brief Format tag for a custom pattern compiled at compile time, use with
+ * DateTimeParts::formatTo<F>() and DateFormatter::formatTo<F>().
+ *
+ * @tparam P constexpr char array holding a strftime style pattern
+ */
+template <const char* P>
+struct CompiledFormat : BuiltinFormat<CompiledFormat<P>> {
+  constexpr static size_t COUNT = FormatPattern::count(P); /**< op count */
+  constexpr static size_t LENGTH =
+      FormatPattern::maxLength(P, 0, COUNT); /**< max output length */
+  static const char* pattern() { return P; }
+  static bool supports(const DateTimeFields& f) {
+    return DateTimeFormat::hasFourDigitYear(f) && f.wday < 7 && f.month < 12;
+  }
+  template <typename Z = FieldsZone>
+  static char* write(char* p, const DateTimeFields& f) {
+    return PatternOps<P, 0, COUNT, Z>::write(p, f);
+  }
+};
+
+#endif
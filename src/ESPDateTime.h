@@ -8,7 +8,22 @@
  *
  */
 
+#include <ClockBackend.h>
+#include <ClockDrift.h>
 #include <DateTime.h>
+#include <DateTimeCivil.h>
+#include <DateTimeFormat.h>
+#include <DateTimePattern.h>
+#include <FixedZone.h>
+#include <MonoClock.h>
+#include <NMEA.h>
+#include <RcuCell.h>
+#include <SNTP.h>
+#include <SyncScheduler.h>
 #include <TimeElapsed.h>
+#include <TimeSource.h>
+#include <TimeStamp.h>
+#include <TimeStorage.h>
+#include <TimeZoneDB.h>
 
 #endif
\ No newline at end of file
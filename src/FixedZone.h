@@ -0,0 +1,122 @@
+#ifndef ESP_DATE_TIME_FIXED_ZONE_H
+#define ESP_DATE_TIME_FIXED_ZONE_H
+
+/**
+ * @file FixedZone.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime compile-time time zone with a fixed utc offset
+ *
+ * A zone without daylight saving time, resolved at compile time:
+ *
+ *     typedef FixedZone<8 * 3600> ChinaTime;
+ *     DateTimeParts p = DateTimeParts::from(ts, ChinaTime());
+ *     DateFormatter::formatTo<FormatISO8601>(buf, 32, ts, ChinaTime());
+ *
+ * The zone lookup is the constant offset added to the timestamp, and %z and
+ * %Z of the precompiled formats are copied from a constexpr string. The
+ * runtime zones still work side by side, TIME_ZONE is the same zone as a
+ * POSIX TZ string for setTimeZone().
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+struct DateTimeFields;
+
+/**
+ * @brief Time zone with a fixed utc offset, like FixedZone<-5 * 3600> for
+ * EST without DST or FixedZone<19800> for India.
+ *
+ * @tparam OFFSET seconds east of UTC, whole minutes in (-12h, +14h)
+ */
+template <int32_t OFFSET>
+struct FixedZone {
+  static_assert(OFFSET % 60 == 0, "fixed zone offset must be whole minutes");
+  static_assert(OFFSET >= -12 * 3600 && OFFSET <= 14 * 3600,
+                "fixed zone offset out of range (-12h, +14h)");
+  /**
+   * @brief Seconds east of UTC
+   *
+   */
+  constexpr static int32_t OFFSET_SECS = OFFSET;
+  /**
+   * @brief Offset as strftime %z (+0800)
+   *
+   */
+  constexpr static char OFFSET_TEXT[6] = {
+      OFFSET < 0 ? '-' : '+',
+      (char)('0' + (OFFSET < 0 ? -OFFSET : OFFSET) / 36000),
+      (char)('0' + (OFFSET < 0 ? -OFFSET : OFFSET) / 3600 % 10),
+      (char)('0' + (OFFSET < 0 ? -OFFSET : OFFSET) / 600 % 6),
+      (char)('0' + (OFFSET < 0 ? -OFFSET : OFFSET) / 60 % 10),
+      '\0'};
+  /**
+   * @brief Same zone as POSIX TZ string (<+0800>-08:00), the sign is
+   * inverted as POSIX counts west of UTC
+   *
+   */
+  constexpr static char TIME_ZONE[14] = {
+      '<', OFFSET_TEXT[0], OFFSET_TEXT[1], OFFSET_TEXT[2],
+      OFFSET_TEXT[3], OFFSET_TEXT[4], '>', OFFSET < 0 ? '+' : '-',
+      OFFSET_TEXT[1], OFFSET_TEXT[2], ':', OFFSET_TEXT[3],
+      OFFSET_TEXT[4], '\0'};
+  /**
+   * @brief Utc offset at a time, same as TimeZoneRule::offsetAt()
+   *
+   * @param ts timestamp in seconds since 1970, not used
+   * @param isdst output daylight saving time flag, always 0, may be nullptr
+   * @return int32_t seconds east of UTC
+   */
+  static inline int32_t offsetAt(const time_t, int8_t* isdst = nullptr) {
+    if (isdst) {
+      *isdst = 0;
+    }
+    return OFFSET;
+  }
+  /**
+   * @brief Local seconds of a timestamp
+   *
+   * @param ts timestamp in seconds since 1970
+   * @return int64_t local seconds since 1970
+   */
+  static inline int64_t toLocal(const time_t ts) {
+    return (int64_t)ts + OFFSET;
+  }
+  /**
+   * @brief Write %z for the precompiled formats, see FieldsZone
+   *
+   * @param p output position
+   * @return char* next output position
+   */
+  static inline char* putOffset(char* p, const DateTimeFields&) {
+    memcpy(p, OFFSET_TEXT, 5);
+    return p + 5;
+  }
+  /**
+   * @brief Write %Z for the precompiled formats, the zone of TIME_ZONE is
+   * named like its offset (+0800)
+   *
+   * @param p output position
+   * @return char* next output position
+   */
+  static inline char* putZoneName(char* p, const DateTimeFields&) {
+    memcpy(p, OFFSET_TEXT, 5);
+    return p + 5;
+  }
+};
+
+template <int32_t OFFSET>
+constexpr char FixedZone<OFFSET>::OFFSET_TEXT[6];
+
+template <int32_t OFFSET>
+constexpr char FixedZone<OFFSET>::TIME_ZONE[14];
+
+/**
+ * @brief Fixed UTC zone, %z is +0000
+ *
+ */
+typedef FixedZone<0> FixedUTC;
+
+#endif
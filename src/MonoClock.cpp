@@ -0,0 +1,45 @@
+#include "MonoClock.h"
+#include <Arduino.h>
+
+#if defined(ESP32)
+#include <esp_timer.h>
+#endif
+
+uint64_t RolloverCounter::extend(const uint32_t raw) {
+  uint64_t last = value.load(std::memory_order_acquire);
+  for (;;) {
+    const uint32_t delta = raw - (uint32_t)last;
+    if (delta >= 0x80000000UL && last != 0) {
+      // raw was read before another task moved the value forward
+      return last - (uint32_t)((uint32_t)last - raw);
+    }
+    const uint64_t next = last + delta;
+    if (delta == 0 ||
+        value.compare_exchange_weak(last, next, std::memory_order_acq_rel,
+                                    std::memory_order_acquire)) {
+      return next;
+    }
+  }
+}
+
+uint64_t MonoClock::millis64() {
+#if defined(ESP32)
+  return (uint64_t)esp_timer_get_time() / 1000;
+#elif defined(ESP8266) || defined(ESP_DATE_TIME_NATIVE)
+  return ::micros64() / 1000;
+#else
+  static RolloverCounter counter;
+  return counter.extend((uint32_t)millis());
+#endif
+}
+
+uint64_t MonoClock::micros64() {
+#if defined(ESP32)
+  return (uint64_t)esp_timer_get_time();
+#elif defined(ESP8266) || defined(ESP_DATE_TIME_NATIVE)
+  return ::micros64();
+#else
+  static RolloverCounter counter;
+  return counter.extend((uint32_t)micros());
+#endif
+}
@@ -0,0 +1,75 @@
+#ifndef ESP_DATE_TIME_MONO_CLOCK_H
+#define ESP_DATE_TIME_MONO_CLOCK_H
+
+/**
+ * @file MonoClock.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime 64-bit monotonic clock
+ *
+ */
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Extends a wrapping 32-bit counter, like millis(), to 64 bits.
+ *
+ * Each call moves the stored value forward by the distance from its low 32
+ * bits, so a wrap of the counter carries into the high bits. A raw value
+ * slightly behind the stored one, read by a task that was preempted while
+ * another task called extend(), is mapped back without moving the value.
+ * extend() must be called at least once per half counter period (~24.8 days
+ * for millis()).
+ *
+ */
+class RolloverCounter {
+ public:
+  RolloverCounter() {}
+  /**
+   * @brief Extend a raw counter value
+   *
+   * @param raw current 32-bit counter value
+   * @return uint64_t 64-bit counter value
+   */
+  uint64_t extend(const uint32_t raw);
+  /**
+   * @brief Last extended value
+   *
+   * @return uint64_t 64-bit counter value
+   */
+  inline uint64_t get() const { return value.load(std::memory_order_acquire); }
+
+ private:
+  std::atomic<uint64_t> value{0};
+};
+
+/**
+ * @brief Monotonic time since boot that never wraps. Uses esp_timer on ESP32,
+ * micros64() on ESP8266 and host builds, millis()/micros() extended by
+ * RolloverCounter elsewhere. The low 32 bits of micros64() equal micros().
+ *
+ */
+class MonoClock {
+ public:
+  /**
+   * @brief Milliseconds since boot
+   *
+   * @return uint64_t milliseconds
+   */
+  static uint64_t millis64();
+  /**
+   * @brief Microseconds since boot, on targets without a 64-bit timer it
+   * must be called at least every ~35 minutes
+   *
+   * @return uint64_t microseconds
+   */
+  static uint64_t micros64();
+  /**
+   * @brief Seconds since boot
+   *
+   * @return uint64_t seconds
+   */
+  static inline uint64_t seconds() { return millis64() / 1000; }
+};
+
+#endif
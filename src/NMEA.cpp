@@ -0,0 +1,277 @@
+#include "NMEA.h"
+#include <Arduino.h>
+#include "DateTimeCivil.h"
+
+// decoded fields, bits of seen
+static const uint8_t SEEN_TIME = 0x01;
+static const uint8_t SEEN_STATUS = 0x02;
+static const uint8_t SEEN_DAY = 0x04;
+static const uint8_t SEEN_MONTH = 0x08;
+static const uint8_t SEEN_YEAR = 0x10;
+static const uint8_t SEEN_DATE = SEEN_DAY | SEEN_MONTH | SEEN_YEAR;
+
+static const uint32_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+static int hexValue(const char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+void NMEAParser::reset() {
+  state = IDLE;
+  type = NONE;
+  timeUs = 0;
+  sentence = NONE;
+  count = 0;
+  errors = 0;
+}
+
+void NMEAParser::startField() {
+  value = 0;
+  fraction = 0;
+  digits = 0;
+  fracDigits = 0;
+  first = 0;
+  dot = false;
+  bad = false;
+}
+
+void NMEAParser::endField() {
+  if (field == 0) {
+    // talker id, then the sentence id: GPRMC, GNZDA...
+    type = NONE;
+    if (addressLen == 5 && address[2] == 'R' && address[3] == 'M' &&
+        address[4] == 'C') {
+      type = RMC;
+    } else if (addressLen == 5 && address[2] == 'Z' && address[3] == 'D' &&
+               address[4] == 'A') {
+      type = ZDA;
+    }
+    return;
+  }
+  if (type == RMC && field == 2) {
+    // A is a valid fix, V is void
+    active = first == 'A';
+    seen |= SEEN_STATUS;
+    return;
+  }
+  if (type == NONE || bad) {
+    return;
+  }
+  if (field == 1) {
+    // hhmmss.sss
+    const uint32_t hh = value / 10000;
+    const uint32_t mm = value / 100 % 100;
+    const uint32_t ss = value % 100;
+    if (digits == 6 && hh < 24 && mm < 60 && ss <= 60) {
+      secsOfDay = (int32_t)(hh * 3600 + mm * 60 + ss);
+      usec = fraction * POW10[6 - fracDigits];
+      seen |= SEEN_TIME;
+    }
+  } else if (type == RMC && field == 9) {
+    // ddmmyy
+    if (digits == 6 && !dot) {
+      day = (uint8_t)(value / 10000);
+      month = (uint8_t)(value / 100 % 100);
+      year = 2000 + (int32_t)(value % 100);
+      seen |= SEEN_DATE;
+    }
+  } else if (type == ZDA && !dot && digits > 0) {
+    if (field == 2 && digits <= 2) {
+      day = (uint8_t)value;
+      seen |= SEEN_DAY;
+    } else if (field == 3 && digits <= 2) {
+      month = (uint8_t)value;
+      seen |= SEEN_MONTH;
+    } else if (field == 4 && digits == 4) {
+      year = (int32_t)value;
+      seen |= SEEN_YEAR;
+    }
+  }
+}
+
+bool NMEAParser::finish() {
+  bool complete = false;
+  if (type == RMC) {
+    complete = (seen & (SEEN_TIME | SEEN_STATUS | SEEN_DATE)) ==
+                   (SEEN_TIME | SEEN_STATUS | SEEN_DATE) &&
+               active;
+  } else if (type == ZDA) {
+    complete = (seen & (SEEN_TIME | SEEN_DATE)) == (SEEN_TIME | SEEN_DATE);
+  }
+  if (!complete || month < 1 || month > 12 || day < 1) {
+    return false;
+  }
+  const int32_t days = DateTimeCivil::daysFromCivil(year, month, day);
+  if (DateTimeCivil::civilFromDays(days).day != day) {
+    return false;
+  }
+  timeUs = ((int64_t)days * DateTimeCivil::SECS_PER_DAY + secsOfDay) *
+               1000000 +
+           usec;
+  sentence = type;
+  return true;
+}
+
+bool NMEAParser::feed(const char c) {
+  if (c == '$') {
+    // an unfinished sentence is dropped
+    state = ADDRESS;
+    type = NONE;
+    length = 0;
+    field = 0;
+    checksum = 0;
+    addressLen = 0;
+    seen = 0;
+    startField();
+    return false;
+  }
+  if (state == IDLE) {
+    return false;
+  }
+  if (++length > MAX_LENGTH || c == '\r' || c == '\n') {
+    // too long, or no checksum
+    errors++;
+    state = IDLE;
+    return false;
+  }
+  if (state == CHECKSUM) {
+    const int v = hexValue(c);
+    if (v < 0) {
+      errors++;
+      state = IDLE;
+      return false;
+    }
+    received = (uint8_t)(received << 4 | v);
+    if (++hexDigits < 2) {
+      return false;
+    }
+    state = IDLE;
+    if (received != checksum) {
+      errors++;
+      return false;
+    }
+    count++;
+    return finish();
+  }
+  if (c == '*') {
+    endField();
+    state = CHECKSUM;
+    received = 0;
+    hexDigits = 0;
+    return false;
+  }
+  checksum ^= (uint8_t)c;
+  if (c == ',') {
+    endField();
+    field++;
+    state = FIELDS;
+    startField();
+    return false;
+  }
+  if (state == ADDRESS) {
+    if (addressLen < sizeof(address)) {
+      address[addressLen] = c;
+    }
+    addressLen++;
+    return false;
+  }
+  if (first == 0) {
+    first = c;
+  }
+  if (c >= '0' && c <= '9') {
+    if (dot) {
+      if (fracDigits < 6) {
+        fraction = fraction * 10 + (uint32_t)(c - '0');
+        fracDigits++;
+      }
+    } else if (digits < 9) {
+      value = value * 10 + (uint32_t)(c - '0');
+      digits++;
+    } else {
+      bad = true;
+    }
+  } else if (c == '.' && !dot) {
+    dot = true;
+  } else {
+    bad = true;
+  }
+  return false;
+}
+
+bool GPSTimeSource::feed(const char c) {
+  if (!parser.feed(c)) {
+    return false;
+  }
+  const uint32_t nowUs = micros();
+  const int64_t timeUs = parser.getTimeUs();
+  if (aligned && timeUs == fixUtcUs) {
+    // RMC then ZDA of the same second, keep the pulse edge
+    return true;
+  }
+  uint32_t seq, edgeUs, prevUs;
+  do {
+    seq = pulseSeq.load(std::memory_order_acquire);
+    edgeUs = pulseUs.load(std::memory_order_relaxed);
+    prevUs = prevPulseUs.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // a pulse came in meanwhile, the edges may be from different pulses
+  } while ((seq & 1) != 0 || pulseSeq.load(std::memory_order_relaxed) != seq);
+  uint32_t count = seq / 2;
+  // pulses since the last sentence edge, one per second between the two
+  const uint32_t fresh = count - usedPulses;
+  const int64_t elapsed = timeUs / 1000000 - fixUtcUs / 1000000;
+  const bool paired = fixed && timeUs % 1000000 == 0 && elapsed > 0 &&
+                      elapsed <= MAX_AGE_US / 1000000;
+  aligned = false;
+  if (paired && fresh == (uint32_t)elapsed &&
+      (uint32_t)(nowUs - edgeUs) < 1000000) {
+    // the sentence tells the time of the last pulse edge
+    aligned = true;
+  } else if (paired && fresh == (uint32_t)elapsed + 1 &&
+             (uint32_t)(nowUs - prevUs) < 2000000) {
+    // read late, the next pulse already fired, the edge before is ours
+    aligned = true;
+    edgeUs = prevUs;
+    count--;
+  }
+  usedPulses = count;
+  fixUtcUs = timeUs;
+  fixMonoUs = aligned ? edgeUs : nowUs;
+  fixed = true;
+  return true;
+}
+
+void IRAM_ATTR GPSTimeSource::onPulse() { pulseAt(micros()); }
+
+void IRAM_ATTR GPSTimeSource::pulseAt(const uint32_t atUs) {
+  // only the interrupt writes, a reader that sees the odd sequence or a
+  // newer one retries
+  const uint32_t seq = pulseSeq.load(std::memory_order_relaxed);
+  pulseSeq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  prevPulseUs.store(pulseUs.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+  pulseUs.store(atUs, std::memory_order_relaxed);
+  pulseSeq.store(seq + 2, std::memory_order_release);
+}
+
+bool GPSTimeSource::read(int64_t* utcUs) {
+  if (!fixed) {
+    return false;
+  }
+  const uint32_t ageUs = micros() - fixMonoUs;
+  if (ageUs > MAX_AGE_US) {
+    return false;
+  }
+  *utcUs = fixUtcUs + ageUs;
+  return true;
+}
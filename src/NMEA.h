@@ -0,0 +1,203 @@
+#ifndef ESP_DATE_TIME_NMEA_H
+#define ESP_DATE_TIME_NMEA_H
+
+/**
+ * @file NMEA.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime GPS time from NMEA 0183 sentences and PPS
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "TimeSource.h"
+
+/**
+ * @brief Streaming NMEA 0183 time parser for RMC and ZDA sentences. Bytes
+ * are fed one at a time, fields are decoded as their digits arrive, so
+ * there is no line buffer and no allocation. Sentences with a bad checksum,
+ * a void fix or out of range fields are dropped.
+ *
+ */
+class NMEAParser {
+ public:
+  /**
+   * @brief Longest sentence, from $ to the checksum, as in NMEA 0183
+   *
+   */
+  constexpr static uint8_t MAX_LENGTH = 82;
+  /**
+   * @brief Time sentences
+   *
+   */
+  enum Sentence : uint8_t {
+    NONE = 0, /**< no time sentence yet */
+    RMC,      /**< recommended minimum data, time and date of a valid fix */
+    ZDA       /**< time and date */
+  };
+
+  NMEAParser() { reset(); }
+  /**
+   * @brief Drop the sentence in progress and the last time
+   *
+   */
+  void reset();
+  /**
+   * @brief Feed one received byte
+   *
+   * @param c byte from the GPS serial port
+   * @return true if it completed a valid time sentence
+   */
+  bool feed(const char c);
+  /**
+   * @brief Time of the last valid time sentence
+   *
+   * @return int64_t microseconds since 1970, 0 if none yet
+   */
+  inline int64_t getTimeUs() const { return timeUs; }
+  /**
+   * @brief Type of the last valid time sentence
+   *
+   * @return Sentence RMC or ZDA, NONE if none yet
+   */
+  inline Sentence getSentence() const { return sentence; }
+  /**
+   * @brief Sentences completed, any type, with a good checksum
+   *
+   * @return uint32_t sentence count
+   */
+  inline uint32_t getCount() const { return count; }
+  /**
+   * @brief Sentences dropped for a bad checksum or length
+   *
+   * @return uint32_t error count
+   */
+  inline uint32_t getErrors() const { return errors; }
+
+ private:
+  enum State : uint8_t { IDLE, ADDRESS, FIELDS, CHECKSUM };
+  State state;
+  Sentence type;      // of the sentence in progress
+  uint8_t length;     // bytes since $
+  uint8_t field;      // field index, 0 is the address
+  uint8_t checksum;   // xor from $ to *
+  uint8_t received;   // checksum digits
+  uint8_t hexDigits;  // checksum digits seen
+  char address[5];    // talker and sentence id, not terminated
+  uint8_t addressLen;
+  // current field
+  uint32_t value;     // integer digits
+  uint32_t fraction;  // fraction digits, up to 6
+  uint8_t digits;     // integer digits
+  uint8_t fracDigits; // fraction digits
+  char first;         // first character
+  bool dot;           // after the decimal point
+  bool bad;           // not a number
+  // decoded fields of the sentence in progress
+  int32_t secsOfDay;
+  uint32_t usec;
+  uint8_t day;
+  uint8_t month;
+  int32_t year;
+  bool active;
+  uint8_t seen;       // bit mask of decoded fields
+  // last valid time
+  int64_t timeUs;
+  Sentence sentence;
+  uint32_t count;
+  uint32_t errors;
+
+  void startField();
+  void endField();
+  bool finish();
+};
+
+/**
+ * @brief TimeSource from a GPS receiver. Feed the serial bytes, and call
+ * onPulse() from the PPS interrupt: the sentence time is then the time of
+ * the pulse edge, not the time the sentence arrived, which is hundreds of
+ * milliseconds later.
+ *
+ * A sentence is paired with an edge by counting: the pulses since the last
+ * time sentence must match the seconds between the two. If the sentence is
+ * read after the next pulse already fired, the edge before it is used. The
+ * first sentence, and any with pulses missing or extra, is not aligned.
+ *
+ */
+class GPSTimeSource : public TimeSource {
+ public:
+  /**
+   * @brief read() fails after this long without a time sentence: 10 seconds
+   *
+   */
+  constexpr static uint32_t MAX_AGE_US = 10UL * 1000 * 1000;
+  /**
+   * @brief Construct a new source
+   *
+   * @param _priority lower is tried first
+   */
+  explicit GPSTimeSource(const uint8_t _priority = 5)
+      : TimeSource(_priority, 0),
+        pulseSeq(0),
+        pulseUs(0),
+        prevPulseUs(0),
+        usedPulses(0),
+        fixUtcUs(0),
+        fixMonoUs(0),
+        fixed(false),
+        aligned(false) {}
+  /**
+   * @brief Feed one byte from the GPS serial port
+   *
+   * @param c received byte
+   * @return true if it completed a valid time sentence
+   */
+  bool feed(const char c);
+  /**
+   * @brief Call from the PPS rising edge interrupt
+   *
+   */
+  void onPulse();
+  /**
+   * @brief Pulse edge captured elsewhere, like by a timer capture unit
+   *
+   * @param atUs micros() at the edge
+   */
+  void pulseAt(const uint32_t atUs);
+  /**
+   * @brief Time now, from the last time sentence
+   *
+   * @param utcUs output microseconds since 1970
+   * @return true if a time sentence arrived in the last MAX_AGE_US
+   */
+  bool read(int64_t* utcUs) override;
+  inline const char* getName() const override { return "GPS"; }
+  /**
+   * @brief Check the last time sentence was aligned to a pulse
+   *
+   * @return true if the time is exact to the pulse edge
+   */
+  inline bool isAligned() const { return aligned; }
+  /**
+   * @brief Get the sentence parser, for counters
+   *
+   * @return const NMEAParser& parser
+   */
+  inline const NMEAParser& getParser() const { return parser; }
+
+ private:
+  NMEAParser parser;
+  // odd while the interrupt writes the edges, pulses counted is pulseSeq / 2
+  std::atomic<uint32_t> pulseSeq;
+  std::atomic<uint32_t> pulseUs;
+  std::atomic<uint32_t> prevPulseUs;
+  // pulses counted up to the edge of the last time sentence
+  uint32_t usedPulses;
+  int64_t fixUtcUs;
+  uint32_t fixMonoUs;
+  bool fixed;
+  bool aligned;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#include "NTPSync.h"
+
+void NTPSync::start(const unsigned long nowMs, const unsigned long _timeOutMs) {
+  state = SYNCING;
+  startMs = nowMs;
+  timeOutMs = _timeOutMs;
+  nextCheckMs = nowMs;
+  elapsedMs = 0;
+  attempts = 0;
+  lastTime = 0;
+}
+
+NTPSync::State NTPSync::poll(const unsigned long nowMs, const time_t osTime,
+                             const time_t minValidTime) {
+  if (state != SYNCING || (long)(nowMs - nextCheckMs) < 0) {
+    return state;
+  }
+  lastTime = osTime;
+  elapsedMs = nowMs - startMs;
+  if (osTime >= minValidTime) {
+    state = SYNCED;
+  } else if (elapsedMs >= timeOutMs) {
+    state = TIMEOUT;
+  } else {
+    nextCheckMs = nowMs + BACKOFF_STEP_MS + BACKOFF_STEP_MS * attempts;
+  }
+  attempts++;
+  return state;
+}
+
+unsigned long NTPSync::nextCheckIn(const unsigned long nowMs) const {
+  if (state != SYNCING || (long)(nowMs - nextCheckMs) >= 0) {
+    return 0;
+  }
+  return nextCheckMs - nowMs;
+}
@@ -0,0 +1,127 @@
+#ifndef ESP_DATE_TIME_NTP_SYNC_H
+#define ESP_DATE_TIME_NTP_SYNC_H
+
+/**
+ * @file NTPSync.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime non-blocking ntp sync state machine
+ *
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Result of DateTimeClass::ntpTime(). The core sntp sets the system
+ * clock and does not report the reply, so this is the system time once
+ * valid, not a network round trip or the server that answered.
+ *
+ */
+struct NTPResult {
+  time_t time;           /**< system time when done, 0 if not valid */
+  unsigned long waitMs;  /**< milliseconds waited for a valid time */
+  unsigned int attempts; /**< number of time checks */
+  const char* server;    /**< configured primary server, not the one used */
+  /**
+   * @brief Check the time is valid
+   *
+   * @return true if time valid before timeout
+   */
+  inline bool isValid() const { return time != 0; }
+};
+
+/**
+ * @brief Non-blocking wait for the system time to become valid after ntp
+ * was configured, same backoff as the old blocking loop (50ms, 100ms,
+ * 150ms...), driven by poll() with the current time passed in, so it can be
+ * tested with a fake clock.
+ *
+ */
+class NTPSync {
+ public:
+  /**
+   * @brief Sync state
+   *
+   */
+  enum State : uint8_t {
+    IDLE = 0, /**< not started */
+    SYNCING,  /**< waiting for valid time */
+    SYNCED,   /**< time valid */
+    TIMEOUT,  /**< time not valid before timeout */
+  };
+  /**
+   * @brief Backoff base delay between checks, in milliseconds
+   *
+   */
+  constexpr static unsigned long BACKOFF_STEP_MS = 50;
+  /**
+   * @brief Start waiting, the first poll() checks immediately
+   *
+   * @param nowMs current milliseconds
+   * @param timeOutMs give up after this many milliseconds
+   */
+  void start(const unsigned long nowMs, const unsigned long timeOutMs);
+  /**
+   * @brief Check the time if a check is due, never blocks
+   *
+   * @param nowMs current milliseconds
+   * @param osTime current system time, seconds since 1970
+   * @param minValidTime osTime not less than this is valid
+   * @return State state after this poll
+   */
+  State poll(const unsigned long nowMs, const time_t osTime,
+             const time_t minValidTime);
+  /**
+   * @brief Stop waiting, state becomes IDLE
+   *
+   */
+  inline void cancel() { state = IDLE; }
+  /**
+   * @brief Get current state
+   *
+   * @return State sync state
+   */
+  inline State getState() const { return state; }
+  /**
+   * @brief Check waiting for valid time
+   *
+   * @return true if state is SYNCING
+   */
+  inline bool isSyncing() const { return state == SYNCING; }
+  /**
+   * @brief Milliseconds until the next check is due
+   *
+   * @param nowMs current milliseconds
+   * @return unsigned long milliseconds, 0 if due or not syncing
+   */
+  unsigned long nextCheckIn(const unsigned long nowMs) const;
+  /**
+   * @brief Number of time checks done
+   *
+   * @return unsigned int check count
+   */
+  inline unsigned int getAttempts() const { return attempts; }
+  /**
+   * @brief Milliseconds elapsed from start() to SYNCED or TIMEOUT
+   *
+   * @return unsigned long elapsed milliseconds
+   */
+  inline unsigned long getElapsed() const { return elapsedMs; }
+  /**
+   * @brief Last checked system time
+   *
+   * @return time_t seconds since 1970
+   */
+  inline time_t getTime() const { return lastTime; }
+
+ private:
+  State state = IDLE;
+  unsigned long startMs = 0;
+  unsigned long timeOutMs = 0;
+  unsigned long nextCheckMs = 0;
+  unsigned long elapsedMs = 0;
+  unsigned int attempts = 0;
+  time_t lastTime = 0;
+};
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef ESP_DATE_TIME_RCU_CELL_H
+#define ESP_DATE_TIME_RCU_CELL_H
+
+/**
+ * @file RcuCell.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime read-copy-update value cell
+ *
+ */
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Value shared between tasks, read without locks, replaced by
+ * read-copy-update.
+ *
+ * Two copies of the value: readers pin the published copy with a counter,
+ * the writer copies it into the other slot, modifies the copy, then publishes
+ * it with one atomic store. Readers never wait, the writer waits only for
+ * readers still pinning the slot it is about to reuse, and writers are
+ * serialized with a flag. Readers must not call update() on the same cell,
+ * tryUpdate() never waits and is safe for them.
+ *
+ * @tparam T value type, copy assignable
+ */
+template <typename T>
+class RcuCell {
+ public:
+  /**
+   * @brief Pins the published value while in scope
+   *
+   */
+  class Reader {
+   public:
+    explicit Reader(const RcuCell& _cell) : cell(_cell), index(cell.pin()) {}
+    ~Reader() { cell.readers[index].fetch_sub(1, std::memory_order_release); }
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+    inline const T& operator*() const { return cell.slots[index]; }
+    inline const T* operator->() const { return &cell.slots[index]; }
+
+   private:
+    const RcuCell& cell;
+    uint8_t index;
+  };
+  /**
+   * @brief Construct a cell holding value
+   *
+   * @param value initial value
+   */
+  explicit RcuCell(const T& value) : slots{value, value} {}
+  /**
+   * @brief Copy the currently published value
+   *
+   */
+  RcuCell(const RcuCell& other) : RcuCell(other.get()) {}
+  RcuCell& operator=(const RcuCell& other) {
+    if (this != &other) {
+      const T value = other.get();
+      update([&value](T& next) {
+        next = value;
+        return true;
+      });
+    }
+    return *this;
+  }
+  /**
+   * @brief Copy of the published value
+   *
+   * @return T value
+   */
+  T get() const {
+    Reader r(*this);
+    return *r;
+  }
+  /**
+   * @brief Modify a private copy of the value and publish it
+   *
+   * @param fn called as bool fn(T& next) with a copy of the published value,
+   * return false to discard the copy
+   * @return true if a new value was published
+   */
+  template <typename F>
+  bool update(F fn) {
+    while (writing.exchange(true, std::memory_order_acquire)) {
+      yield();
+    }
+    const uint8_t next = 1 - current.load(std::memory_order_relaxed);
+    // readers that loaded the index before the last publish may still pin
+    // the old slot
+    while (readers[next].load(std::memory_order_seq_cst) != 0) {
+      yield();
+    }
+    return publish(fn, next);
+  }
+  /**
+   * @brief Like update() but never waits, gives up while another writer
+   * runs or a reader still pins the slot to reuse. For readers refreshing a
+   * cache they can do without.
+   *
+   * @param fn called as bool fn(T& next), see update()
+   * @return true if a new value was published
+   */
+  template <typename F>
+  bool tryUpdate(F fn) {
+    if (writing.exchange(true, std::memory_order_acquire)) {
+      return false;
+    }
+    const uint8_t next = 1 - current.load(std::memory_order_relaxed);
+    if (readers[next].load(std::memory_order_seq_cst) != 0) {
+      writing.store(false, std::memory_order_release);
+      return false;
+    }
+    return publish(fn, next);
+  }
+
+ private:
+  T slots[2];
+  std::atomic<uint8_t> current{0};
+  mutable std::atomic<uint32_t> readers[2]{{0}, {0}};
+  std::atomic<bool> writing{false};
+
+  // called with the writing flag and no reader pinning slot next
+  template <typename F>
+  bool publish(F& fn, const uint8_t next) {
+    slots[next] = slots[1 - next];
+    const bool changed = fn(slots[next]);
+    if (changed) {
+      current.store(next, std::memory_order_seq_cst);
+    }
+    writing.store(false, std::memory_order_release);
+    return changed;
+  }
+
+  uint8_t pin() const {
+    for (;;) {
+      const uint8_t index = current.load(std::memory_order_seq_cst);
+      readers[index].fetch_add(1, std::memory_order_seq_cst);
+      // the slot may have been retired between the load and the pin
+      if (current.load(std::memory_order_seq_cst) == index) {
+        return index;
+      }
+      readers[index].fetch_sub(1, std::memory_order_release);
+    }
+  }
+};
+
+#endif
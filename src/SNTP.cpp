@@ -0,0 +1,176 @@
+#include "SNTP.h"
+#include <Arduino.h>
+#include <sys/time.h>
+#include "ClockBackend.h"
+
+static void putU32(uint8_t* p, const uint32_t v) {
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+static void putU64(uint8_t* p, const uint64_t v) {
+  putU32(p, (uint32_t)(v >> 32));
+  putU32(p + 4, (uint32_t)v);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 |
+         (uint32_t)p[3];
+}
+
+static uint64_t getU64(const uint8_t* p) {
+  return (uint64_t)getU32(p) << 32 | getU32(p + 4);
+}
+
+SNTPPacket SNTPPacket::request(const int64_t txUs) {
+  SNTPPacket packet;
+  memset(&packet, 0, sizeof(packet));
+  packet.version = 4;
+  packet.mode = MODE_CLIENT;
+  packet.txTime = toNtp(txUs);
+  return packet;
+}
+
+void SNTPPacket::encode(uint8_t* buf) const {
+  buf[0] =
+      (uint8_t)((leap & 0x03) << 6 | (version & 0x07) << 3 | (mode & 0x07));
+  buf[1] = stratum;
+  buf[2] = (uint8_t)poll;
+  buf[3] = (uint8_t)precision;
+  putU32(buf + 4, rootDelay);
+  putU32(buf + 8, rootDispersion);
+  putU32(buf + 12, refId);
+  putU64(buf + 16, refTime);
+  putU64(buf + 24, origTime);
+  putU64(buf + 32, rxTime);
+  putU64(buf + 40, txTime);
+}
+
+bool SNTPPacket::decode(const uint8_t* buf, const size_t len) {
+  if (len < SIZE) {
+    return false;
+  }
+  leap = buf[0] >> 6;
+  version = (buf[0] >> 3) & 0x07;
+  mode = buf[0] & 0x07;
+  stratum = buf[1];
+  poll = (int8_t)buf[2];
+  precision = (int8_t)buf[3];
+  rootDelay = getU32(buf + 4);
+  rootDispersion = getU32(buf + 8);
+  refId = getU32(buf + 12);
+  refTime = getU64(buf + 16);
+  origTime = getU64(buf + 24);
+  rxTime = getU64(buf + 32);
+  txTime = getU64(buf + 40);
+  return true;
+}
+
+uint64_t SNTPPacket::toNtp(const int64_t unixUs) {
+  int64_t secs = unixUs / 1000000;
+  int64_t us = unixUs % 1000000;
+  if (us < 0) {
+    secs--;
+    us += 1000000;
+  }
+  // era 1 wraps to 0 from 2036, the high 32 bits keep the low bits only
+  const uint32_t ntpSecs = (uint32_t)(secs + UNIX_OFFSET);
+  const uint32_t fraction = (uint32_t)(((uint64_t)us << 32) / 1000000);
+  return (uint64_t)ntpSecs << 32 | fraction;
+}
+
+int64_t SNTPPacket::toUnixUs(const uint64_t ntp) {
+  const uint32_t ntpSecs = (uint32_t)(ntp >> 32);
+  const uint32_t fraction = (uint32_t)ntp;
+  int64_t secs = (int64_t)ntpSecs - UNIX_OFFSET;
+  if ((ntpSecs & 0x80000000UL) == 0) {
+    secs += (int64_t)1 << 32;
+  }
+  // round to nearest microsecond
+  const int64_t us =
+      (int64_t)(((uint64_t)fraction * 1000000 + 0x80000000UL) >> 32);
+  return secs * 1000000 + us;
+}
+
+int64_t SNTPClient::localUs() { return ClockBackend::utcUs(); }
+
+bool SNTPClient::request(const char* server, SNTPSample* sample,
+                         const unsigned int timeOutMs) {
+  uint8_t buf[SNTPPacket::SIZE + 20];
+  // drop stale replies of earlier requests
+  while (transport.receive(buf, sizeof(buf)) > 0) {
+  }
+  const int64_t t1 = localUs();
+  const SNTPPacket req = SNTPPacket::request(t1);
+  req.encode(buf);
+  if (!transport.send(server, port, buf, SNTPPacket::SIZE)) {
+    return false;
+  }
+  const uint32_t startMs = ClockBackend::millis();
+  while (ClockBackend::millis() - startMs < timeOutMs) {
+    const int len = transport.receive(buf, sizeof(buf));
+    if (len <= 0) {
+      ClockBackend::delay(1);
+      continue;
+    }
+    const int64_t t4 = localUs();
+    SNTPPacket res;
+    // the originate timestamp must echo our transmit timestamp
+    if (!res.decode(buf, (size_t)len) || res.origTime != req.txTime) {
+      continue;
+    }
+    if (res.mode != SNTPPacket::MODE_SERVER ||
+        res.leap == SNTPPacket::LEAP_UNSYNC || res.stratum == 0 ||
+        res.stratum > 15 || res.txTime == 0) {
+      return false;
+    }
+    const int64_t t2 = SNTPPacket::toUnixUs(res.rxTime);
+    const int64_t t3 = SNTPPacket::toUnixUs(res.txTime);
+    sample->offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+    sample->delayUs = (t4 - t1) - (t3 - t2);
+    if (sample->delayUs < 0) {
+      sample->delayUs = 0;
+    }
+    sample->timeUs = t4 + sample->offsetUs;
+    sample->stratum = res.stratum;
+    sample->server = server;
+    return true;
+  }
+  return false;
+}
+
+int SNTPClient::query(const char* const* servers, const size_t count,
+                      SNTPSample* best, const unsigned int timeOutMs) {
+  int bestIndex = -1;
+  for (size_t i = 0; i < count; i++) {
+    SNTPSample sample;
+    if (servers[i] == nullptr || !request(servers[i], &sample, timeOutMs)) {
+      continue;
+    }
+    if (bestIndex < 0 || sample.delayUs < best->delayUs) {
+      *best = sample;
+      bestIndex = (int)i;
+    }
+  }
+  return bestIndex;
+}
+
+#ifdef ARDUINO
+bool SNTPUdpTransport::send(const char* host, const uint16_t port,
+                            const uint8_t* data, const size_t len) {
+  if (!started) {
+    started = udp.begin(LOCAL_PORT) != 0;
+  }
+  return udp.beginPacket(host, port) && udp.write(data, len) == len &&
+         udp.endPacket();
+}
+
+int SNTPUdpTransport::receive(uint8_t* buf, const size_t cap) {
+  if (udp.parsePacket() <= 0) {
+    return 0;
+  }
+  return udp.read(buf, cap);
+}
+#endif
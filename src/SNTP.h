@@ -0,0 +1,232 @@
+#ifndef ESP_DATE_TIME_SNTP_H
+#define ESP_DATE_TIME_SNTP_H
+
+/**
+ * @file SNTP.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime SNTP (RFC 4330) client
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <Udp.h>
+#endif
+
+/**
+ * @brief SNTP packet, 48 bytes on the wire, timestamps in NTP 32.32 fixed
+ * point format (seconds since 1900).
+ *
+ */
+struct SNTPPacket {
+  /**
+   * @brief Packet size without authenticator
+   *
+   */
+  constexpr static size_t SIZE = 48;
+  /**
+   * @brief Seconds from 1900-01-01 to 1970-01-01
+   *
+   */
+  constexpr static uint32_t UNIX_OFFSET = 2208988800UL;
+  /**
+   * @brief Client mode
+   *
+   */
+  constexpr static uint8_t MODE_CLIENT = 3;
+  /**
+   * @brief Server mode
+   *
+   */
+  constexpr static uint8_t MODE_SERVER = 4;
+  /**
+   * @brief Leap indicator: clock not synchronized
+   *
+   */
+  constexpr static uint8_t LEAP_UNSYNC = 3;
+
+  uint8_t leap;            /**< leap indicator (0-3) */
+  uint8_t version;         /**< protocol version (1-4) */
+  uint8_t mode;            /**< association mode (0-7) */
+  uint8_t stratum;         /**< 0 kiss-o'-death, 1 primary, 2-15 secondary */
+  int8_t poll;             /**< poll interval, log2 seconds */
+  int8_t precision;        /**< clock precision, log2 seconds */
+  uint32_t rootDelay;      /**< 16.16 seconds */
+  uint32_t rootDispersion; /**< 16.16 seconds */
+  uint32_t refId;          /**< reference identifier */
+  uint64_t refTime;        /**< reference timestamp */
+  uint64_t origTime;       /**< originate timestamp (T1) */
+  uint64_t rxTime;         /**< receive timestamp (T2) */
+  uint64_t txTime;         /**< transmit timestamp (T3) */
+
+  /**
+   * @brief Build a client request
+   *
+   * @param txUs client transmit time, microseconds since 1970
+   * @return SNTPPacket version 4 client packet
+   */
+  static SNTPPacket request(const int64_t txUs);
+  /**
+   * @brief Write packet in network byte order
+   *
+   * @param buf output buffer, at least SIZE bytes
+   */
+  void encode(uint8_t* buf) const;
+  /**
+   * @brief Read packet in network byte order
+   *
+   * @param buf input buffer
+   * @param len input length, extra bytes (authenticator) are ignored
+   * @return true if len not less than SIZE
+   */
+  bool decode(const uint8_t* buf, const size_t len);
+  /**
+   * @brief Convert microseconds since 1970 to NTP timestamp
+   *
+   * @param unixUs microseconds since 1970
+   * @return uint64_t NTP 32.32 timestamp
+   */
+  static uint64_t toNtp(const int64_t unixUs);
+  /**
+   * @brief Convert NTP timestamp to microseconds since 1970, timestamps with
+   * the high bit clear are taken as era 1 (after 2036-02-07), see RFC 4330
+   *
+   * @param ntp NTP 32.32 timestamp
+   * @return int64_t microseconds since 1970
+   */
+  static int64_t toUnixUs(const uint64_t ntp);
+};
+
+/**
+ * @brief Result of one SNTP request
+ *
+ */
+struct SNTPSample {
+  int64_t offsetUs;   /**< server clock minus local clock */
+  int64_t delayUs;    /**< round trip delay */
+  int64_t timeUs;     /**< server time when the reply arrived, since 1970 */
+  uint8_t stratum;    /**< server stratum */
+  const char* server; /**< server that replied */
+};
+
+/**
+ * @brief Datagram transport used by SNTPClient, implemented over WiFiUDP on
+ * device (SNTPUdpTransport) and over sockets in tests.
+ *
+ */
+class SNTPTransport {
+ public:
+  virtual ~SNTPTransport() {}
+  /**
+   * @brief Send one datagram
+   *
+   * @param host server domain name or ip address
+   * @param port server port
+   * @param data datagram
+   * @param len datagram length
+   * @return true if sent
+   */
+  virtual bool send(const char* host, const uint16_t port, const uint8_t* data,
+                    const size_t len) = 0;
+  /**
+   * @brief Receive one datagram if available, never blocks
+   *
+   * @param buf output buffer
+   * @param cap buffer size
+   * @return int received length, 0 if nothing available
+   */
+  virtual int receive(uint8_t* buf, const size_t cap) = 0;
+};
+
+#ifdef ARDUINO
+/**
+ * @brief SNTPTransport over an Arduino UDP object, like WiFiUDP
+ *
+ */
+class SNTPUdpTransport : public SNTPTransport {
+ public:
+  /**
+   * @brief Local port used when the udp object is not started
+   *
+   */
+  constexpr static uint16_t LOCAL_PORT = 2390;
+  /**
+   * @brief Construct a new transport
+   *
+   * @param _udp udp object, must outlive this object
+   */
+  explicit SNTPUdpTransport(UDP& _udp) : udp(_udp) {}
+  bool send(const char* host, const uint16_t port, const uint8_t* data,
+            const size_t len) override;
+  int receive(uint8_t* buf, const size_t cap) override;
+
+ private:
+  UDP& udp;
+  bool started = false;
+};
+#endif
+
+/**
+ * @brief SNTP client, computes clock offset and round trip delay from the
+ * four timestamps (RFC 4330 section 5):
+ *
+ * offset = ((T2 - T1) + (T3 - T4)) / 2, delay = (T4 - T1) - (T3 - T2)
+ *
+ */
+class SNTPClient {
+ public:
+  /**
+   * @brief NTP server port
+   *
+   */
+  constexpr static uint16_t NTP_PORT = 123;
+  /**
+   * @brief Default timeout for each server: 1 second
+   *
+   */
+  constexpr static unsigned int DEFAULT_TIMEOUT = 1000;  // milliseconds
+  /**
+   * @brief Construct a new client
+   *
+   * @param _transport datagram transport, must outlive this object
+   * @param _port server port
+   */
+  explicit SNTPClient(SNTPTransport& _transport,
+                      const uint16_t _port = NTP_PORT)
+      : transport(_transport), port(_port) {}
+  /**
+   * @brief Query one server, wait for the reply until timeout
+   *
+   * @param server server domain name or ip address
+   * @param sample output offset and delay
+   * @param timeOutMs reply timeout
+   * @return true if a valid reply received
+   */
+  bool request(const char* server, SNTPSample* sample,
+               const unsigned int timeOutMs = DEFAULT_TIMEOUT);
+  /**
+   * @brief Query servers one by one, keep the reply with the lowest delay
+   *
+   * @param servers server names, nullptr entries are skipped
+   * @param count number of servers
+   * @param best output best sample
+   * @param timeOutMs reply timeout of each server
+   * @return int index of the best server, -1 if no valid reply
+   */
+  int query(const char* const* servers, const size_t count, SNTPSample* best,
+            const unsigned int timeOutMs = DEFAULT_TIMEOUT);
+  /**
+   * @brief Local clock, microseconds since 1970
+   *
+   * @return int64_t system time of the ClockBackend in microseconds
+   */
+  static int64_t localUs();
+
+ private:
+  SNTPTransport& transport;
+  uint16_t port;
+};
+
+#endif
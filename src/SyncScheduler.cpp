@@ -0,0 +1,86 @@
+#include "SyncScheduler.h"
+
+SyncScheduler::SyncScheduler(const uint32_t _budgetMs)
+    : budgetMs(_budgetMs),
+      interval(0),
+      delayMs(0),
+      lastMs(0),
+      rng(0x9E3779B9UL),
+      failures(0),
+      running(false) {}
+
+void SyncScheduler::setSeed(const uint32_t seed) {
+  // murmur3 finalizer, so close seeds give unrelated sequences
+  uint32_t h = seed;
+  h ^= h >> 16;
+  h *= 0x85EBCA6BUL;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35UL;
+  h ^= h >> 16;
+  // xorshift never leaves zero
+  rng = h != 0 ? h : 0x9E3779B9UL;
+}
+
+void SyncScheduler::start(const unsigned long nowMs) {
+  running = true;
+  failures = 0;
+  lastMs = nowMs;
+  delayMs = 0;
+}
+
+bool SyncScheduler::isDue(const unsigned long nowMs) const {
+  return running && nowMs - lastMs >= delayMs;
+}
+
+unsigned long SyncScheduler::dueIn(const unsigned long nowMs) const {
+  const unsigned long elapsed = nowMs - lastMs;
+  return elapsed >= delayMs ? 0 : delayMs - elapsed;
+}
+
+uint32_t SyncScheduler::onSuccess(const unsigned long nowMs,
+                                  const double uncertaintyPpm,
+                                  const uint32_t residualUs) {
+  failures = 0;
+  // error after t seconds: residual + ppm * t microseconds
+  const double budgetUs = (double)budgetMs * 1000 - residualUs;
+  const double ppm = uncertaintyPpm > 0.001 ? uncertaintyPpm : 0.001;
+  double ms = budgetUs > 0 ? budgetUs / ppm * 1000 : 0;
+  // let the drift estimate catch up before stretching further
+  if (interval > 0 && ms > 2.0 * interval) {
+    ms = 2.0 * interval;
+  }
+  if (ms < MIN_INTERVAL_MS) {
+    ms = MIN_INTERVAL_MS;
+  } else if (ms > MAX_INTERVAL_MS) {
+    ms = MAX_INTERVAL_MS;
+  }
+  interval = (uint32_t)ms;
+  lastMs = nowMs;
+  delayMs = jitter(interval);
+  return delayMs;
+}
+
+uint32_t SyncScheduler::onFailure(const unsigned long nowMs) {
+  if (failures < 255) {
+    failures++;
+  }
+  uint32_t ms = MAX_RETRY_MS;
+  if (failures <= 16) {
+    const uint32_t backoff = RETRY_MS << (failures - 1);
+    ms = backoff < MAX_RETRY_MS ? backoff : MAX_RETRY_MS;
+  }
+  lastMs = nowMs;
+  delayMs = jitter(ms);
+  return delayMs;
+}
+
+uint32_t SyncScheduler::jitter(const uint32_t ms) {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  const uint32_t span = ms / 100 * JITTER_PERCENT;
+  if (span == 0) {
+    return ms;
+  }
+  return ms - span + rng % (2 * span + 1);
+}
@@ -0,0 +1,154 @@
+#ifndef ESP_DATE_TIME_SYNC_SCHEDULER_H
+#define ESP_DATE_TIME_SYNC_SCHEDULER_H
+
+/**
+ * @file SyncScheduler.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime adaptive resync scheduler
+ *
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief Picks when to sync next. After a sync the interval is how long the
+ * corrected clock takes to drift out of the error budget, growing at most 2x
+ * per sync. Failures back off exponentially. Every delay gets random jitter,
+ * so devices that booted together spread out over time.
+ *
+ * Like NTPSync it takes the current time as a parameter and never blocks.
+ *
+ */
+class SyncScheduler {
+ public:
+  /**
+   * @brief Default error budget: 100 milliseconds
+   *
+   */
+  constexpr static uint32_t DEFAULT_BUDGET_MS = 100;
+  /**
+   * @brief Shortest interval, NTP minpoll: 64 seconds
+   *
+   */
+  constexpr static uint32_t MIN_INTERVAL_MS = 64UL * 1000;
+  /**
+   * @brief Longest interval, about NTP maxpoll: 36 hours
+   *
+   */
+  constexpr static uint32_t MAX_INTERVAL_MS = 36UL * 3600 * 1000;
+  /**
+   * @brief First retry delay after a failure: 15 seconds
+   *
+   */
+  constexpr static uint32_t RETRY_MS = 15UL * 1000;
+  /**
+   * @brief Longest retry delay: 1 hour
+   *
+   */
+  constexpr static uint32_t MAX_RETRY_MS = 3600UL * 1000;
+  /**
+   * @brief Random jitter added to each delay, +-10%
+   *
+   */
+  constexpr static uint8_t JITTER_PERCENT = 10;
+  /**
+   * @brief Construct a stopped scheduler
+   *
+   * @param _budgetMs max clock error allowed between syncs
+   */
+  explicit SyncScheduler(const uint32_t _budgetMs = DEFAULT_BUDGET_MS);
+  /**
+   * @brief Set max clock error allowed between syncs
+   *
+   * @param _budgetMs error budget in milliseconds
+   */
+  inline void setBudget(const uint32_t _budgetMs) { budgetMs = _budgetMs; }
+  /**
+   * @brief Get max clock error allowed between syncs
+   *
+   * @return uint32_t error budget in milliseconds
+   */
+  inline uint32_t getBudget() const { return budgetMs; }
+  /**
+   * @brief Seed the jitter generator, use a hardware random number so
+   * devices do not share the same sequence
+   *
+   * @param seed random seed
+   */
+  void setSeed(const uint32_t seed);
+  /**
+   * @brief Start scheduling, the first sync is due now
+   *
+   * @param nowMs current millis()
+   */
+  void start(const unsigned long nowMs);
+  /**
+   * @brief Stop scheduling, isDue() returns false
+   *
+   */
+  inline void stop() { running = false; }
+  /**
+   * @brief Check scheduling is running
+   *
+   * @return true if started
+   */
+  inline bool isRunning() const { return running; }
+  /**
+   * @brief Check next sync is due
+   *
+   * @param nowMs current millis()
+   * @return true if running and the delay passed
+   */
+  bool isDue(const unsigned long nowMs) const;
+  /**
+   * @brief Milliseconds until the next sync is due
+   *
+   * @param nowMs current millis()
+   * @return unsigned long 0 if due
+   */
+  unsigned long dueIn(const unsigned long nowMs) const;
+  /**
+   * @brief Schedule after a successful sync
+   *
+   * @param nowMs current millis()
+   * @param uncertaintyPpm drift rate of the corrected clock, see
+   * ClockDrift::getUncertaintyPpm()
+   * @param residualUs clock error right after the sync, see
+   * ClockDrift::getRmsResidual()
+   * @return uint32_t delay until the next sync, with jitter
+   */
+  uint32_t onSuccess(const unsigned long nowMs, const double uncertaintyPpm,
+                     const uint32_t residualUs);
+  /**
+   * @brief Schedule a retry after a failed sync
+   *
+   * @param nowMs current millis()
+   * @return uint32_t delay until the retry, with jitter
+   */
+  uint32_t onFailure(const unsigned long nowMs);
+  /**
+   * @brief Interval picked by the last onSuccess(), without jitter
+   *
+   * @return uint32_t milliseconds, 0 before the first success
+   */
+  inline uint32_t getInterval() const { return interval; }
+  /**
+   * @brief Failures since the last success
+   *
+   * @return uint8_t failure count
+   */
+  inline uint8_t getFailures() const { return failures; }
+
+ private:
+  uint32_t budgetMs;
+  uint32_t interval;
+  uint32_t delayMs;
+  unsigned long lastMs;
+  uint32_t rng;
+  uint8_t failures;
+  bool running;
+
+  uint32_t jitter(const uint32_t ms);
+};
+
+#endif
@@ -9,27 +9,44 @@
  */
 
 #include <Arduino.h>
+#include <limits.h>
+#include "MonoClock.h"
 
 /**
- * @brief TimeElapsed class
+ * @brief TimeElapsed class, milliseconds since start, based on
+ * MonoClock::millis64() so it keeps counting after millis() wraps.
  *
  */
 
 class TimeElapsed {
  private:
-  unsigned long ms;
+  uint64_t ms;
 
  public:
-  TimeElapsed() : ms(millis()) {}
-  TimeElapsed(unsigned long val) { ms = millis() - val; }
+  TimeElapsed() : ms(MonoClock::millis64()) {}
+  TimeElapsed(unsigned long val) { ms = MonoClock::millis64() - val; }
   TimeElapsed(const TimeElapsed& rhs) { ms = rhs.ms; }
-  operator unsigned long() const { return millis() - ms; }
+  /**
+   * @brief Elapsed milliseconds, saturates at ULONG_MAX where unsigned long
+   * is 32 bits (after ~49.7 days), use elapsed() for longer spans
+   *
+   */
+  operator unsigned long() const {
+    const uint64_t value = elapsed();
+    return value > ULONG_MAX ? ULONG_MAX : (unsigned long)value;
+  }
+  /**
+   * @brief Elapsed milliseconds
+   *
+   * @return uint64_t milliseconds
+   */
+  uint64_t elapsed() const { return MonoClock::millis64() - ms; }
   TimeElapsed& operator=(const TimeElapsed& rhs) {
     ms = rhs.ms;
     return *this;
   }
   TimeElapsed& operator=(unsigned long val) {
-    ms = millis() - val;
+    ms = MonoClock::millis64() - val;
     return *this;
   }
   TimeElapsed& operator-=(unsigned long val) {
@@ -0,0 +1,141 @@
+#include "TimeSource.h"
+#include <Arduino.h>
+#include "DateTimeCivil.h"
+
+static uint8_t fromBcd(const uint8_t v) { return (v >> 4) * 10 + (v & 0x0F); }
+
+static uint8_t toBcd(const uint8_t v) {
+  return (uint8_t)((v / 10) << 4 | v % 10);
+}
+
+#ifdef ARDUINO
+bool WireI2CBus::readRegisters(const uint8_t address, const uint8_t reg,
+                               uint8_t* buf, const size_t len) {
+  wire.beginTransmission(address);
+  wire.write(reg);
+  if (wire.endTransmission(false) != 0) {
+    return false;
+  }
+  if (wire.requestFrom(address, (uint8_t)len) != len) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = (uint8_t)wire.read();
+  }
+  return true;
+}
+
+bool WireI2CBus::writeRegisters(const uint8_t address, const uint8_t reg,
+                                const uint8_t* data, const size_t len) {
+  wire.beginTransmission(address);
+  wire.write(reg);
+  wire.write(data, len);
+  return wire.endTransmission() == 0;
+}
+#endif
+
+bool I2CRtcTimeSource::readSeconds(int64_t* secs) {
+  uint8_t r[7];
+  if (!bus.readRegisters(layout.address, layout.timeReg, r, sizeof(r)) ||
+      (r[0] & layout.stopMask)) {
+    return false;
+  }
+  const uint8_t second = fromBcd(r[0] & 0x7F);
+  const uint8_t minute = fromBcd(r[1] & 0x7F);
+  uint8_t hour;
+  if (r[2] & 0x40) {
+    // 12 hour mode, bit 5 is PM
+    hour = fromBcd(r[2] & 0x1F) % 12 + ((r[2] & 0x20) ? 12 : 0);
+  } else {
+    hour = fromBcd(r[2] & 0x3F);
+  }
+  const uint8_t day = fromBcd(r[layout.mday] & 0x3F);
+  const uint8_t month = fromBcd(r[5] & 0x1F);
+  // century bits are ignored, 2000-2099
+  const int32_t year = 2000 + fromBcd(r[6]);
+  if (second > 59 || minute > 59 || hour > 23 || month < 1 || month > 12 ||
+      day < 1) {
+    return false;
+  }
+  const int32_t days = DateTimeCivil::daysFromCivil(year, month, day);
+  if (DateTimeCivil::civilFromDays(days).day != day) {
+    return false;
+  }
+  *secs = (int64_t)days * DateTimeCivil::SECS_PER_DAY + hour * 3600 +
+          minute * 60 + second;
+  return true;
+}
+
+bool I2CRtcTimeSource::read(int64_t* utcUs) {
+  int64_t first;
+  if (!isRunning() || !readSeconds(&first)) {
+    return false;
+  }
+  if (!waitEdge) {
+    // somewhere in this second, the middle has the least error
+    *utcUs = first * 1000000 + 500000;
+    return true;
+  }
+  // poll the seconds register only, the others are stable after the tick
+  const uint8_t firstReg = (uint8_t)(first % 60);
+  const uint32_t startUs = micros();
+  uint8_t reg = firstReg;
+  while (reg == firstReg) {
+    if ((uint32_t)(micros() - startUs) > EDGE_TIMEOUT_US) {
+      return false;
+    }
+    yield();
+    uint8_t v;
+    if (!bus.readRegisters(layout.address, layout.timeReg, &v, 1)) {
+      return false;
+    }
+    reg = fromBcd(v & 0x7F);
+  }
+  int64_t secs;
+  if (!readSeconds(&secs)) {
+    return false;
+  }
+  *utcUs = secs * 1000000;
+  return true;
+}
+
+bool I2CRtcTimeSource::write(const int64_t utcUs) {
+  int32_t secs;
+  const int32_t days =
+      DateTimeCivil::splitDays((utcUs + 500000) / 1000000, &secs);
+  const CivilDate date = DateTimeCivil::civilFromDays(days);
+  if (date.year < 2000 || date.year > 2099) {
+    return false;
+  }
+  uint8_t r[7];
+  // clears the stop bits, 24 hour mode
+  r[0] = toBcd((uint8_t)(secs % 60));
+  r[1] = toBcd((uint8_t)(secs / 60 % 60));
+  r[2] = toBcd((uint8_t)(secs / 3600));
+  r[layout.wday] =
+      (uint8_t)(DateTimeCivil::weekDayFromDays(days) + layout.wdayBase);
+  r[layout.mday] = toBcd(date.day);
+  r[5] = toBcd(date.month);
+  r[6] = toBcd((uint8_t)(date.year - 2000));
+  return bus.writeRegisters(layout.address, layout.timeReg, r, sizeof(r)) &&
+         clearStopped();
+}
+
+// DS3231 status register, bit 7 is the oscillator stop flag
+static const uint8_t DS3231_STATUS = 0x0F;
+static const uint8_t DS3231_OSF = 0x80;
+
+bool DS3231TimeSource::isRunning() {
+  uint8_t status;
+  return bus.readRegisters(layout.address, DS3231_STATUS, &status, 1) &&
+         !(status & DS3231_OSF);
+}
+
+bool DS3231TimeSource::clearStopped() {
+  uint8_t status;
+  if (!bus.readRegisters(layout.address, DS3231_STATUS, &status, 1)) {
+    return false;
+  }
+  status &= (uint8_t)~DS3231_OSF;
+  return bus.writeRegisters(layout.address, DS3231_STATUS, &status, 1);
+}
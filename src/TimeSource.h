@@ -0,0 +1,258 @@
+#ifndef ESP_DATE_TIME_TIME_SOURCE_H
+#define ESP_DATE_TIME_TIME_SOURCE_H
+
+/**
+ * @file TimeSource.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime time sources and external RTC chips
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#ifdef ARDUINO
+#include <Wire.h>
+#endif
+
+/**
+ * @brief A clock other than NTP, like a battery backed RTC chip. DateTime
+ * reads the sources by priority when the time is not valid, and writes the
+ * NTP time to the writable ones.
+ *
+ */
+class TimeSource {
+ public:
+  /**
+   * @brief Construct a new source
+   *
+   * @param _priority lower is tried first
+   * @param _accuracyPpm frequency tolerance
+   */
+  TimeSource(const uint8_t _priority, const uint32_t _accuracyPpm)
+      : priority(_priority), accuracyPpm(_accuracyPpm) {}
+  virtual ~TimeSource() {}
+  /**
+   * @brief Read current time
+   *
+   * @param utcUs output microseconds since 1970
+   * @return true if the source keeps valid time
+   */
+  virtual bool read(int64_t* utcUs) = 0;
+  /**
+   * @brief Set the source to the current time
+   *
+   * @param utcUs microseconds since 1970
+   * @return true if written, false if failed or read only
+   */
+  virtual bool write(const int64_t utcUs) {
+    (void)utcUs;
+    return false;
+  }
+  /**
+   * @brief Source name, for logs
+   *
+   * @return const char* name
+   */
+  virtual const char* getName() const = 0;
+  /**
+   * @brief Sources with lower priority are tried first
+   *
+   * @return uint8_t priority
+   */
+  inline uint8_t getPriority() const { return priority; }
+  /**
+   * @brief Frequency tolerance of the source
+   *
+   * @return uint32_t parts per million
+   */
+  inline uint32_t getAccuracyPpm() const { return accuracyPpm; }
+
+ private:
+  uint8_t priority;
+  uint32_t accuracyPpm;
+};
+
+/**
+ * @brief Register access of I2C devices, implemented over Wire on device
+ * (WireI2CBus) and over a register map in tests.
+ *
+ */
+class I2CBus {
+ public:
+  virtual ~I2CBus() {}
+  /**
+   * @brief Read consecutive registers
+   *
+   * @param address 7-bit device address
+   * @param reg first register
+   * @param buf output buffer
+   * @param len registers to read
+   * @return true if the device acknowledged and all bytes were read
+   */
+  virtual bool readRegisters(const uint8_t address, const uint8_t reg,
+                             uint8_t* buf, const size_t len) = 0;
+  /**
+   * @brief Write consecutive registers
+   *
+   * @param address 7-bit device address
+   * @param reg first register
+   * @param data register values
+   * @param len registers to write
+   * @return true if the device acknowledged
+   */
+  virtual bool writeRegisters(const uint8_t address, const uint8_t reg,
+                              const uint8_t* data, const size_t len) = 0;
+};
+
+#ifdef ARDUINO
+/**
+ * @brief I2CBus over an Arduino TwoWire object, call Wire.begin() first
+ *
+ */
+class WireI2CBus : public I2CBus {
+ public:
+  /**
+   * @brief Construct a new bus
+   *
+   * @param _wire wire object, must outlive this object
+   */
+  explicit WireI2CBus(TwoWire& _wire = Wire) : wire(_wire) {}
+  bool readRegisters(const uint8_t address, const uint8_t reg, uint8_t* buf,
+                     const size_t len) override;
+  bool writeRegisters(const uint8_t address, const uint8_t reg,
+                      const uint8_t* data, const size_t len) override;
+
+ private:
+  TwoWire& wire;
+};
+#endif
+
+/**
+ * @brief Base of the BCD clock calendar chips. They count whole seconds, so
+ * read() waits for the next seconds tick to return the time at the edge,
+ * up to one second. write() rounds to the nearest second.
+ *
+ */
+class I2CRtcTimeSource : public TimeSource {
+ public:
+  /**
+   * @brief read() gives up waiting for the seconds tick after this long
+   *
+   */
+  constexpr static uint32_t EDGE_TIMEOUT_US = 1100 * 1000;
+  bool read(int64_t* utcUs) override;
+  bool write(const int64_t utcUs) override;
+  /**
+   * @brief Wait for the seconds tick in read(), or return the middle of the
+   * current second at once
+   *
+   * @param _waitEdge true by default
+   */
+  inline void setWaitEdge(const bool _waitEdge) { waitEdge = _waitEdge; }
+
+ protected:
+  /**
+   * @brief Register layout of the time keeping registers
+   *
+   */
+  struct Layout {
+    uint8_t address;  /**< 7-bit device address */
+    uint8_t timeReg;  /**< seconds register, followed by 6 more */
+    uint8_t mday;     /**< day of month index from timeReg */
+    uint8_t wday;     /**< weekday index from timeReg */
+    uint8_t wdayBase; /**< value of sunday */
+    uint8_t stopMask; /**< seconds bits marking the time invalid */
+  };
+  I2CRtcTimeSource(I2CBus& _bus, const Layout& _layout,
+                   const uint8_t _priority, const uint32_t _accuracyPpm)
+      : TimeSource(_priority, _accuracyPpm),
+        bus(_bus),
+        layout(_layout),
+        waitEdge(true) {}
+  /**
+   * @brief Check the oscillator kept running, the chip specific flags
+   *
+   * @return true if the time is valid
+   */
+  virtual bool isRunning() { return true; }
+  /**
+   * @brief Clear the oscillator stop flags after a write
+   *
+   * @return true if cleared
+   */
+  virtual bool clearStopped() { return true; }
+
+  I2CBus& bus;
+  Layout layout;
+
+ private:
+  bool waitEdge;
+
+  bool readSeconds(int64_t* secs);
+};
+
+/**
+ * @brief Maxim DS3231 TCXO RTC, +-2 ppm. The oscillator stop flag marks the
+ * time invalid after a power loss.
+ *
+ */
+class DS3231TimeSource : public I2CRtcTimeSource {
+ public:
+  constexpr static uint8_t ADDRESS = 0x68; /**< I2C address */
+  /**
+   * @brief Construct a new source
+   *
+   * @param _bus i2c bus, must outlive this object
+   * @param _priority lower is tried first
+   */
+  explicit DS3231TimeSource(I2CBus& _bus, const uint8_t _priority = 10)
+      : I2CRtcTimeSource(_bus, {ADDRESS, 0x00, 4, 3, 1, 0x00}, _priority, 2) {
+  }
+  inline const char* getName() const override { return "DS3231"; }
+
+ protected:
+  bool isRunning() override;
+  bool clearStopped() override;
+};
+
+/**
+ * @brief NXP PCF8563 RTC, crystal tolerance about 20 ppm. The voltage low
+ * flag marks the time invalid.
+ *
+ */
+class PCF8563TimeSource : public I2CRtcTimeSource {
+ public:
+  constexpr static uint8_t ADDRESS = 0x51; /**< I2C address */
+  /**
+   * @brief Construct a new source
+   *
+   * @param _bus i2c bus, must outlive this object
+   * @param _priority lower is tried first
+   */
+  explicit PCF8563TimeSource(I2CBus& _bus, const uint8_t _priority = 20)
+      : I2CRtcTimeSource(_bus, {ADDRESS, 0x02, 3, 4, 0, 0x80}, _priority,
+                         20) {}
+  inline const char* getName() const override { return "PCF8563"; }
+};
+
+/**
+ * @brief Maxim DS1307 RTC, crystal tolerance about 20 ppm. The clock halt
+ * flag marks the time invalid.
+ *
+ */
+class DS1307TimeSource : public I2CRtcTimeSource {
+ public:
+  constexpr static uint8_t ADDRESS = 0x68; /**< I2C address */
+  /**
+   * @brief Construct a new source
+   *
+   * @param _bus i2c bus, must outlive this object
+   * @param _priority lower is tried first
+   */
+  explicit DS1307TimeSource(I2CBus& _bus, const uint8_t _priority = 30)
+      : I2CRtcTimeSource(_bus, {ADDRESS, 0x00, 4, 3, 1, 0x80}, _priority, 20) {
+  }
+  inline const char* getName() const override { return "DS1307"; }
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "TimeStamp.h"
+#include <Arduino.h>
+#include "ClockBackend.h"
+
+StampAnchor& StampAnchor::operator=(const StampAnchor& other) {
+  int64_t epochUs;
+  uint32_t monoUs;
+  if (this != &other && other.read(&epochUs, &monoUs) != 0) {
+    publish(epochUs, monoUs);
+  }
+  return *this;
+}
+
+bool StampAnchor::publish(const int64_t epochUs, const uint32_t monoUs) {
+  bool expected = false;
+  if (!writing.compare_exchange_strong(expected, true,
+                                       std::memory_order_acquire)) {
+    return false;
+  }
+  const uint32_t next = seq.load(std::memory_order_relaxed) + 1;
+  Slot& slot = slots[next & 1];
+  // a late reader of this slot that sees any of the writes below also sees
+  // the last sequence store, and retries
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.epochLo.store((uint32_t)epochUs, std::memory_order_relaxed);
+  slot.epochHi.store((uint32_t)((uint64_t)epochUs >> 32),
+                     std::memory_order_relaxed);
+  slot.mono.store(monoUs, std::memory_order_relaxed);
+  // slot writes become visible before the new sequence
+  seq.store(next, std::memory_order_release);
+  writing.store(false, std::memory_order_release);
+  return true;
+}
+
+uint32_t IRAM_ATTR StampAnchor::read(int64_t* epochUs,
+                                     uint32_t* monoUs) const {
+  uint32_t before;
+  uint32_t lo, hi, mono;
+  do {
+    before = seq.load(std::memory_order_acquire);
+    const Slot& slot = slots[before & 1];
+    lo = slot.epochLo.load(std::memory_order_relaxed);
+    hi = slot.epochHi.load(std::memory_order_relaxed);
+    mono = slot.mono.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // a publish completed meanwhile, the slot may have been reused
+  } while (seq.load(std::memory_order_relaxed) != before);
+  *epochUs = (int64_t)((uint64_t)hi << 32 | lo);
+  *monoUs = mono;
+  return before;
+}
+
+int64_t IRAM_ATTR StampAnchor::at(const uint32_t monoUs) const {
+  int64_t epochUs;
+  uint32_t anchorUs;
+  read(&epochUs, &anchorUs);
+  return epochUs + (uint32_t)(monoUs - anchorUs);
+}
+
+int64_t IRAM_ATTR StampAnchor::now() const {
+  int64_t epochUs;
+  uint32_t anchorUs;
+  read(&epochUs, &anchorUs);
+  return epochUs + (uint32_t)(ClockBackend::micros() - anchorUs);
+}
@@ -0,0 +1,79 @@
+#ifndef ESP_DATE_TIME_TIME_STAMP_H
+#define ESP_DATE_TIME_TIME_STAMP_H
+
+/**
+ * @file TimeStamp.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime interrupt safe timestamp anchor
+ *
+ */
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief (epoch, micros()) pair published by one writer and read lock-free
+ * from tasks and interrupt handlers.
+ *
+ * Double buffered seqlock: the writer fills the slot readers are not using,
+ * then bumps the sequence. Readers never wait for the writer, so an
+ * interrupt that fires in the middle of publish() on the same core still
+ * reads the previous pair, and a reader on another core retries only if a
+ * publish completed while it was reading.
+ *
+ */
+class StampAnchor {
+ public:
+  StampAnchor() {}
+  /**
+   * @brief Copy the currently published pair
+   *
+   */
+  StampAnchor(const StampAnchor& other) { *this = other; }
+  StampAnchor& operator=(const StampAnchor& other);
+  /**
+   * @brief Publish a new pair, concurrent publish() calls are dropped
+   *
+   * @param epochUs microseconds since 1970 at monoUs
+   * @param monoUs micros() value
+   * @return true if published, false if another publish is running
+   */
+  bool publish(const int64_t epochUs, const uint32_t monoUs);
+  /**
+   * @brief Read a consistent pair, safe in interrupt handlers
+   *
+   * @param epochUs output microseconds since 1970
+   * @param monoUs output micros() value
+   * @return uint32_t sequence, 0 if nothing published yet
+   */
+  uint32_t read(int64_t* epochUs, uint32_t* monoUs) const;
+  /**
+   * @brief Epoch microseconds at the given micros() value, safe in interrupt
+   * handlers. Before the first publish() this is micros() since boot.
+   *
+   * @param monoUs micros() value, not before the anchor and at most ~71
+   * minutes after it
+   * @return int64_t microseconds since 1970
+   */
+  int64_t at(const uint32_t monoUs) const;
+  /**
+   * @brief Epoch microseconds now, safe in interrupt handlers. micros() is
+   * read after the anchor, so a concurrent publish() never makes it older
+   * than the anchor.
+   *
+   * @return int64_t microseconds since 1970
+   */
+  int64_t now() const;
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> epochLo{0};
+    std::atomic<uint32_t> epochHi{0};
+    std::atomic<uint32_t> mono{0};
+  };
+  Slot slots[2];
+  std::atomic<uint32_t> seq{0};
+  std::atomic<bool> writing{false};
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "TimeStorage.h"
+#include <Arduino.h>
+
+#ifdef ARDUINO
+#include <EEPROM.h>
+#endif
+
+static void putU32(uint8_t* p, const uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static void putU64(uint8_t* p, const uint64_t v) {
+  putU32(p, (uint32_t)v);
+  putU32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t getU32(const uint8_t* p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+         (uint32_t)p[3] << 24;
+}
+
+static uint64_t getU64(const uint8_t* p) {
+  return (uint64_t)getU32(p) | (uint64_t)getU32(p + 4) << 32;
+}
+
+// layout: magic, version, flags, 2 reserved, epoch, mono, freq, zone,
+// sleep, rtc, crc
+static const size_t OFFSET_FLAGS = 5;
+static const size_t OFFSET_EPOCH = 8;
+static const size_t OFFSET_MONO = 16;
+static const size_t OFFSET_FREQ = 24;
+static const size_t OFFSET_ZONE = 28;
+static const size_t OFFSET_SLEEP = OFFSET_ZONE + TimeRecord::ZONE_SIZE;
+static const size_t OFFSET_RTC = OFFSET_SLEEP + 8;
+static const size_t OFFSET_CRC = TimeRecord::SIZE - 4;
+
+void TimeRecord::encode(uint8_t* buf) const {
+  memset(buf, 0, SIZE);
+  putU32(buf, MAGIC);
+  buf[4] = VERSION;
+  buf[OFFSET_FLAGS] = flags;
+  putU64(buf + OFFSET_EPOCH, (uint64_t)epochUs);
+  putU64(buf + OFFSET_MONO, (uint64_t)monoUs);
+  putU32(buf + OFFSET_FREQ, (uint32_t)freqPpb);
+  memcpy(buf + OFFSET_ZONE, timeZone, ZONE_SIZE);
+  buf[OFFSET_ZONE + ZONE_SIZE - 1] = '\0';
+  putU64(buf + OFFSET_SLEEP, (uint64_t)sleepUs);
+  putU64(buf + OFFSET_RTC, (uint64_t)rtcUs);
+  putU32(buf + OFFSET_CRC, crc32(buf, OFFSET_CRC));
+}
+
+bool TimeRecord::decode(const uint8_t* buf, const size_t len) {
+  if (len < SIZE || getU32(buf) != MAGIC || buf[4] != VERSION ||
+      getU32(buf + OFFSET_CRC) != crc32(buf, OFFSET_CRC)) {
+    return false;
+  }
+  flags = buf[OFFSET_FLAGS];
+  epochUs = (int64_t)getU64(buf + OFFSET_EPOCH);
+  monoUs = (int64_t)getU64(buf + OFFSET_MONO);
+  freqPpb = (int32_t)getU32(buf + OFFSET_FREQ);
+  memcpy(timeZone, buf + OFFSET_ZONE, ZONE_SIZE);
+  timeZone[ZONE_SIZE - 1] = '\0';
+  sleepUs = (int64_t)getU64(buf + OFFSET_SLEEP);
+  rtcUs = (int64_t)getU64(buf + OFFSET_RTC);
+  return true;
+}
+
+uint32_t TimeRecord::crc32(const uint8_t* data, const size_t len) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int k = 0; k < 8; k++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+#ifdef ARDUINO
+#if defined(ESP32)
+// not cleared on reset or deep sleep wakeup, the CRC rejects garbage
+RTC_NOINIT_ATTR static uint32_t rtcRecord[TimeRecord::SIZE / 4];
+#endif
+
+bool RtcTimeStorage::read(uint8_t* buf, const size_t len) {
+  if (len > TimeRecord::SIZE) {
+    return false;
+  }
+#if defined(ESP8266)
+  uint32_t words[TimeRecord::SIZE / 4];
+  if (!ESP.rtcUserMemoryRead(block, words, sizeof(words))) {
+    return false;
+  }
+  memcpy(buf, words, len);
+  return true;
+#elif defined(ESP32)
+  (void)block;
+  memcpy(buf, rtcRecord, len);
+  return true;
+#endif
+}
+
+bool RtcTimeStorage::write(const uint8_t* buf, const size_t len) {
+  if (len > TimeRecord::SIZE) {
+    return false;
+  }
+#if defined(ESP8266)
+  uint32_t words[TimeRecord::SIZE / 4];
+  memset(words, 0, sizeof(words));
+  memcpy(words, buf, len);
+  return ESP.rtcUserMemoryWrite(block, words, sizeof(words));
+#elif defined(ESP32)
+  memcpy(rtcRecord, buf, len);
+  return true;
+#endif
+}
+
+bool EEPROMTimeStorage::read(uint8_t* buf, const size_t len) {
+  if (offset + len > EEPROM.length()) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = EEPROM.read(offset + i);
+  }
+  return true;
+}
+
+bool EEPROMTimeStorage::write(const uint8_t* buf, const size_t len) {
+  if (offset + len > EEPROM.length()) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    EEPROM.write(offset + i, buf[i]);
+  }
+  return EEPROM.commit();
+}
+#endif
@@ -0,0 +1,153 @@
+#ifndef ESP_DATE_TIME_TIME_STORAGE_H
+#define ESP_DATE_TIME_TIME_STORAGE_H
+
+/**
+ * @file TimeStorage.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime last known good time persistence
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Last known good time, drift and time zone, stored with a CRC so a
+ * torn write or uninitialized memory is never restored.
+ *
+ */
+struct TimeRecord {
+  /**
+   * @brief Encoded size, a multiple of 4 for RTC memory
+   *
+   */
+  constexpr static size_t SIZE = 112;
+  /**
+   * @brief Max length of the stored TZ string
+   *
+   */
+  constexpr static size_t ZONE_SIZE = 64;
+  /**
+   * @brief "EDTR", little endian
+   *
+   */
+  constexpr static uint32_t MAGIC = 0x52544445UL;
+  /**
+   * @brief Record layout version
+   *
+   */
+  constexpr static uint8_t VERSION = 2;
+  /**
+   * @brief Saved by prepareSleep(), sleepUs is set
+   *
+   */
+  constexpr static uint8_t FLAG_SLEEP = 0x01;
+  /**
+   * @brief rtcUs is set
+   *
+   */
+  constexpr static uint8_t FLAG_RTC = 0x02;
+
+  uint8_t flags;              /**< FLAG_SLEEP, FLAG_RTC */
+  int64_t epochUs;            /**< utc when saved, microseconds since 1970 */
+  int64_t monoUs;             /**< MonoClock::micros64() when saved */
+  int32_t freqPpb;            /**< drift estimate, parts per billion */
+  char timeZone[ZONE_SIZE];   /**< POSIX TZ string, may be empty */
+  int64_t sleepUs;            /**< requested deep sleep duration */
+  int64_t rtcUs;              /**< RTC timer when saved, counts in sleep */
+
+  /**
+   * @brief Write record with magic, version and CRC
+   *
+   * @param buf output buffer, at least SIZE bytes
+   */
+  void encode(uint8_t* buf) const;
+  /**
+   * @brief Read record, check magic, version and CRC
+   *
+   * @param buf input buffer
+   * @param len input length
+   * @return true if the record is valid
+   */
+  bool decode(const uint8_t* buf, const size_t len);
+  /**
+   * @brief CRC-32 (IEEE 802.3), as used by zlib
+   *
+   * @param data input bytes
+   * @param len input length
+   * @return uint32_t checksum
+   */
+  static uint32_t crc32(const uint8_t* data, const size_t len);
+};
+
+/**
+ * @brief Storage of one TimeRecord, implemented over RTC memory and EEPROM on
+ * device and over a file in tests.
+ *
+ */
+class TimeStorage {
+ public:
+  virtual ~TimeStorage() {}
+  /**
+   * @brief Read stored bytes
+   *
+   * @param buf output buffer
+   * @param len bytes to read
+   * @return true if read
+   */
+  virtual bool read(uint8_t* buf, const size_t len) = 0;
+  /**
+   * @brief Write bytes
+   *
+   * @param buf input buffer
+   * @param len bytes to write
+   * @return true if written
+   */
+  virtual bool write(const uint8_t* buf, const size_t len) = 0;
+};
+
+#ifdef ARDUINO
+/**
+ * @brief TimeStorage in RTC memory, survives deep sleep and software resets
+ * but not power loss. ESP8266 uses RTC user memory at the given block, ESP32
+ * a RTC_NOINIT_ATTR buffer.
+ *
+ */
+class RtcTimeStorage : public TimeStorage {
+ public:
+  /**
+   * @brief Construct a new storage
+   *
+   * @param _block first 4 byte block of RTC user memory (ESP8266 only),
+   * TimeRecord::SIZE / 4 blocks are used
+   */
+  explicit RtcTimeStorage(const uint32_t _block = 0) : block(_block) {}
+  bool read(uint8_t* buf, const size_t len) override;
+  bool write(const uint8_t* buf, const size_t len) override;
+
+ private:
+  uint32_t block;
+};
+
+/**
+ * @brief TimeStorage in the EEPROM emulation (flash), survives power loss.
+ * Call EEPROM.begin() with a size covering offset + TimeRecord::SIZE first.
+ *
+ */
+class EEPROMTimeStorage : public TimeStorage {
+ public:
+  /**
+   * @brief Construct a new storage
+   *
+   * @param _offset byte offset in EEPROM
+   */
+  explicit EEPROMTimeStorage(const size_t _offset = 0) : offset(_offset) {}
+  bool read(uint8_t* buf, const size_t len) override;
+  bool write(const uint8_t* buf, const size_t len) override;
+
+ private:
+  size_t offset;
+};
+#endif
+
+#endif
@@ -0,0 +1,39 @@
+#include "TimeZoneDB.h"
+#include <Arduino.h>
+#include "TimeZoneDBData.h"
+
+size_t TimeZoneDB::count() { return TZDB_ZONE_COUNT; }
+
+const char* TimeZoneDB::nameAt(const size_t index) {
+  if (index >= TZDB_ZONE_COUNT) {
+    return nullptr;
+  }
+  return TZDB_NAMES + pgm_read_word(&TZDB_INDEX[index][0]);
+}
+
+const char* TimeZoneDB::ruleAt(const size_t index) {
+  if (index >= TZDB_ZONE_COUNT) {
+    return nullptr;
+  }
+  return TZDB_RULES + pgm_read_word(&TZDB_INDEX[index][1]);
+}
+
+const char* TimeZoneDB::lookupZone(const char* name) {
+  if (name == nullptr) {
+    return nullptr;
+  }
+  size_t lo = 0;
+  size_t hi = TZDB_ZONE_COUNT;
+  while (lo < hi) {
+    const size_t mid = (lo + hi) / 2;
+    const int cmp = strcmp_P(name, nameAt(mid));
+    if (cmp == 0) {
+      return ruleAt(mid);
+    } else if (cmp < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return nullptr;
+}
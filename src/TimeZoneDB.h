@@ -0,0 +1,53 @@
+#ifndef ESP_DATE_TIME_TIME_ZONE_DB_H
+#define ESP_DATE_TIME_TIME_ZONE_DB_H
+
+/**
+ * @file TimeZoneDB.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime compact time zone database
+ *
+ * Deduplicated POSIX TZ rules of the zones in DateTimeTZ.h, stored in flash
+ * with a sorted name index, generated by tools/tzdb_gen.py.
+ *
+ */
+
+#include <stddef.h>
+
+/**
+ * @brief Time zone lookup by IANA name, like "Europe/Berlin".
+ *
+ * Returned strings point into flash (PSTR), they can be passed to
+ * DateTimeClass::setTimeZone() or TimeZoneRule directly, no RAM copies.
+ *
+ */
+struct TimeZoneDB {
+  /**
+   * @brief Find POSIX TZ rule of a zone, binary search by name
+   *
+   * @param name IANA zone name, like "Europe/Berlin", in RAM
+   * @return const char* POSIX TZ string in flash (PSTR), nullptr if unknown
+   */
+  static const char* lookupZone(const char* name);
+  /**
+   * @brief Number of zones in database
+   *
+   * @return size_t zone count
+   */
+  static size_t count();
+  /**
+   * @brief Zone name at index, sorted by name
+   *
+   * @param index zone index (0 to count() - 1)
+   * @return const char* IANA zone name in flash (PSTR), nullptr if invalid
+   */
+  static const char* nameAt(const size_t index);
+  /**
+   * @brief POSIX TZ rule of zone at index
+   *
+   * @param index zone index (0 to count() - 1)
+   * @return const char* POSIX TZ string in flash (PSTR), nullptr if invalid
+   */
+  static const char* ruleAt(const size_t index);
+};
+
+#endif
@@ -0,0 +1,1037 @@
+// autogenerated by tools/tzdb_gen.py from src/DateTimeTZ.h
+// do not edit, run python3 tools/tzdb_gen.py instead
+
+#ifndef ESP_DATE_TIME_TIME_ZONE_DB_DATA_H
+#define ESP_DATE_TIME_TIME_ZONE_DB_DATA_H
+
+// 460 zones, 99 unique rules
+#define TZDB_ZONE_COUNT 460
+
+static const char TZDB_RULES[] PROGMEM =
+    "GMT0\0"
+    "EAT-3\0"
+    "CET-1\0"
+    "WAT-1\0"
+    "CAT-2\0"
+    "EET-2\0"
+    "<+01>-1\0"
+    "CET-1CEST,M3.5.0,M10.5.0/3\0"
+    "SAST-2\0"
+    "HST10HDT,M3.2.0,M11.1.0\0"
+    "AKST9AKDT,M3.2.0,M11.1.0\0"
+    "AST4\0"
+    "<-03>3\0"
+    "<-04>4<-03>,M10.1.0/0,M3.4.0/0\0"
+    "EST5\0"
+    "CST6CDT,M4.1.0,M10.5.0\0"
+    "CST6\0"
+    "<-04>4\0"
+    "<-05>5\0"
+    "MST7MDT,M3.2.0,M11.1.0\0"
+    "CST6CDT,M3.2.0,M11.1.0\0"
+    "MST7MDT,M4.1.0,M10.5.0\0"
+    "MST7\0"
+    "EST5EDT,M3.2.0,M11.1.0\0"
+    "AST4ADT,M3.2.0,M11.1.0\0"
+    "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1\0"
+    "CST5CDT,M3.2.0/0,M11.1.0/1\0"
+    "PST8PDT,M3.2.0,M11.1.0\0"
+    "<-03>3<-02>,M3.2.0,M11.1.0\0"
+    "<-02>2\0"
+    "<-04>4<-03>,M9.1.6/24,M4.1.6/24\0"
+    "<-01>1<+00>,M3.5.0/0,M10.5.0/1\0"
+    "NST3:30NDT,M3.2.0,M11.1.0\0"
+    "<+11>-11\0"
+    "<+07>-7\0"
+    "<+10>-10\0"
+    "AEST-10AEDT,M10.1.0,M4.1.0/3\0"
+    "<+05>-5\0"
+    "NZST-12NZDT,M9.5.0,M4.1.0/3\0"
+    "<+03>-3\0"
+    "<+00>0<+02>-2,M3.5.0/1,M10.5.0/3\0"
+    "<+06>-6\0"
+    "EET-2EEST,M3.5.4/24,M10.5.5/1\0"
+    "<+12>-12\0"
+    "<+04>-4\0"
+    "EET-2EEST,M3.5.0/0,M10.5.0/0\0"
+    "<+08>-8\0"
+    "<+09>-9\0"
+    "<+0530>-5:30\0"
+    "EET-2EEST,M3.5.5/0,M10.5.5/0\0"
+    "EET-2EEST,M3.5.0/3,M10.5.0/4\0"
+    "EET-2EEST,M3.4.4/48,M10.4.4/49\0"
+    "HKT-8\0"
+    "WIB-7\0"
+    "WIT-9\0"
+    "IST-2IDT,M3.4.4/26,M10.5.0\0"
+    "<+0430>-4:30\0"
+    "PKT-5\0"
+    "<+0545>-5:45\0"
+    "IST-5:30\0"
+    "CST-8\0"
+    "WITA-8\0"
+    "PST-8\0"
+    "KST-9\0"
+    "<+0330>-3:30<+0430>,J79/24,J263/24\0"
+    "JST-9\0"
+    "<+0630>-6:30\0"
+    "WET0WEST,M3.5.0/1,M10.5.0\0"
+    "<-01>1\0"
+    "ACST-9:30ACDT,M10.1.0,M4.1.0/3\0"
+    "AEST-10\0"
+    "ACST-9:30\0"
+    "<+0845>-8:45\0"
+    "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0\0"
+    "AWST-8\0"
+    "<-10>10\0"
+    "<-11>11\0"
+    "<-12>12\0"
+    "<-06>6\0"
+    "<-07>7\0"
+    "<-08>8\0"
+    "<-09>9\0"
+    "<+13>-13\0"
+    "<+14>-14\0"
+    "<+02>-2\0"
+    "UTC0\0"
+    "EET-2EEST,M3.5.0,M10.5.0/3\0"
+    "IST-1GMT0,M10.5.0,M3.5.0/1\0"
+    "GMT0BST,M3.5.0/1,M10.5.0\0"
+    "MSK-3\0"
+    "<+13>-13<+14>,M9.5.0/3,M4.1.0/4\0"
+    "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45\0"
+    "<-06>6<-05>,M9.1.6/22,M4.1.6/22\0"
+    "<+12>-12<+13>,M11.2.0,M1.2.3/99\0"
+    "ChST-10\0"
+    "HST10\0"
+    "<-0930>9:30\0"
+    "SST11\0"
+    "<+11>-11<+12>,M10.1.0,M4.1.0/3\0";
+
+static const char TZDB_NAMES[] PROGMEM =
+    "Africa/Abidjan\0"
+    "Africa/Accra\0"
+    "Africa/Addis_Ababa\0"
+    "Africa/Algiers\0"
+    "Africa/Asmara\0"
+    "Africa/Bamako\0"
+    "Africa/Bangui\0"
+    "Africa/Banjul\0"
+    "Africa/Bissau\0"
+    "Africa/Blantyre\0"
+    "Africa/Brazzaville\0"
+    "Africa/Bujumbura\0"
+    "Africa/Cairo\0"
+    "Africa/Casablanca\0"
+    "Africa/Ceuta\0"
+    "Africa/Conakry\0"
+    "Africa/Dakar\0"
+    "Africa/Dar_es_Salaam\0"
+    "Africa/Djibouti\0"
+    "Africa/Douala\0"
+    "Africa/El_Aaiun\0"
+    "Africa/Freetown\0"
+    "Africa/Gaborone\0"
+    "Africa/Harare\0"
+    "Africa/Johannesburg\0"
+    "Africa/Juba\0"
+    "Africa/Kampala\0"
+    "Africa/Khartoum\0"
+    "Africa/Kigali\0"
+    "Africa/Kinshasa\0"
+    "Africa/Lagos\0"
+    "Africa/Libreville\0"
+    "Africa/Lome\0"
+    "Africa/Luanda\0"
+    "Africa/Lubumbashi\0"
+    "Africa/Lusaka\0"
+    "Africa/Malabo\0"
+    "Africa/Maputo\0"
+    "Africa/Maseru\0"
+    "Africa/Mbabane\0"
+    "Africa/Mogadishu\0"
+    "Africa/Monrovia\0"
+    "Africa/Nairobi\0"
+    "Africa/Ndjamena\0"
+    "Africa/Niamey\0"
+    "Africa/Nouakchott\0"
+    "Africa/Ouagadougou\0"
+    "Africa/PortomNovo\0"
+    "Africa/Sao_Tome\0"
+    "Africa/Tripoli\0"
+    "Africa/Tunis\0"
+    "Africa/Windhoek\0"
+    "America/Adak\0"
+    "America/Anchorage\0"
+    "America/Anguilla\0"
+    "America/Antigua\0"
+    "America/Araguaina\0"
+    "America/Argentina/Buenos_Aires\0"
+    "America/Argentina/Catamarca\0"
+    "America/Argentina/Cordoba\0"
+    "America/Argentina/Jujuy\0"
+    "America/Argentina/La_Rioja\0"
+    "America/Argentina/Mendoza\0"
+    "America/Argentina/Rio_Gallegos\0"
+    "America/Argentina/Salta\0"
+    "America/Argentina/San_Juan\0"
+    "America/Argentina/San_Luis\0"
+    "America/Argentina/Tucuman\0"
+    "America/Argentina/Ushuaia\0"
+    "America/Aruba\0"
+    "America/Asuncion\0"
+    "America/Atikokan\0"
+    "America/Bahia\0"
+    "America/Bahia_Banderas\0"
+    "America/Barbados\0"
+    "America/Belem\0"
+    "America/Belize\0"
+    "America/Blanc-Sablon\0"
+    "America/Boa_Vista\0"
+    "America/Bogota\0"
+    "America/Boise\0"
+    "America/Cambridge_Bay\0"
+    "America/Campo_Grande\0"
+    "America/Cancun\0"
+    "America/Caracas\0"
+    "America/Cayenne\0"
+    "America/Cayman\0"
+    "America/Chicago\0"
+    "America/Chihuahua\0"
+    "America/Costa_Rica\0"
+    "America/Creston\0"
+    "America/Cuiaba\0"
+    "America/Curacao\0"
+    "America/Danmarkshavn\0"
+    "America/Dawson\0"
+    "America/Dawson_Creek\0"
+    "America/Denver\0"
+    "America/Detroit\0"
+    "America/Dominica\0"
+    "America/Edmonton\0"
+    "America/Eirunepe\0"
+    "America/El_Salvador\0"
+    "America/Fort_Nelson\0"
+    "America/Fortaleza\0"
+    "America/Glace_Bay\0"
+    "America/Godthab\0"
+    "America/Goose_Bay\0"
+    "America/Grand_Turk\0"
+    "America/Grenada\0"
+    "America/Guadeloupe\0"
+    "America/Guatemala\0"
+    "America/Guayaquil\0"
+    "America/Guyana\0"
+    "America/Halifax\0"
+    "America/Havana\0"
+    "America/Hermosillo\0"
+    "America/Indiana/Indianapolis\0"
+    "America/Indiana/Knox\0"
+    "America/Indiana/Marengo\0"
+    "America/Indiana/Petersburg\0"
+    "America/Indiana/Tell_City\0"
+    "America/Indiana/Vevay\0"
+    "America/Indiana/Vincennes\0"
+    "America/Indiana/Winamac\0"
+    "America/Inuvik\0"
+    "America/Iqaluit\0"
+    "America/Jamaica\0"
+    "America/Juneau\0"
+    "America/Kentucky/Louisville\0"
+    "America/Kentucky/Monticello\0"
+    "America/Kralendijk\0"
+    "America/La_Paz\0"
+    "America/Lima\0"
+    "America/Los_Angeles\0"
+    "America/Lower_Princes\0"
+    "America/Maceio\0"
+    "America/Managua\0"
+    "America/Manaus\0"
+    "America/Marigot\0"
+    "America/Martinique\0"
+    "America/Matamoros\0"
+    "America/Mazatlan\0"
+    "America/Menominee\0"
+    "America/Merida\0"
+    "America/Metlakatla\0"
+    "America/Mexico_City\0"
+    "America/Miquelon\0"
+    "America/Moncton\0"
+    "America/Monterrey\0"
+    "America/Montevideo\0"
+    "America/Montreal\0"
+    "America/Montserrat\0"
+    "America/Nassau\0"
+    "America/New_York\0"
+    "America/Nipigon\0"
+    "America/Nome\0"
+    "America/Noronha\0"
+    "America/North_Dakota/Beulah\0"
+    "America/North_Dakota/Center\0"
+    "America/North_Dakota/New_Salem\0"
+    "America/Ojinaga\0"
+    "America/Panama\0"
+    "America/Pangnirtung\0"
+    "America/Paramaribo\0"
+    "America/Phoenix\0"
+    "America/Port-au-Prince\0"
+    "America/Port_of_Spain\0"
+    "America/Porto_Velho\0"
+    "America/Puerto_Rico\0"
+    "America/Punta_Arenas\0"
+    "America/Rainy_River\0"
+    "America/Rankin_Inlet\0"
+    "America/Recife\0"
+    "America/Regina\0"
+    "America/Resolute\0"
+    "America/Rio_Branco\0"
+    "America/Santarem\0"
+    "America/Santiago\0"
+    "America/Santo_Domingo\0"
+    "America/Sao_Paulo\0"
+    "America/Scoresbysund\0"
+    "America/Sitka\0"
+    "America/St_Barthelemy\0"
+    "America/St_Johns\0"
+    "America/St_Kitts\0"
+    "America/St_Lucia\0"
+    "America/St_Thomas\0"
+    "America/St_Vincent\0"
+    "America/Swift_Current\0"
+    "America/Tegucigalpa\0"
+    "America/Thule\0"
+    "America/Thunder_Bay\0"
+    "America/Tijuana\0"
+    "America/Toronto\0"
+    "America/Tortola\0"
+    "America/Vancouver\0"
+    "America/Whitehorse\0"
+    "America/Winnipeg\0"
+    "America/Yakutat\0"
+    "America/Yellowknife\0"
+    "Antarctica/Casey\0"
+    "Antarctica/Davis\0"
+    "Antarctica/DumontDUrville\0"
+    "Antarctica/Macquarie\0"
+    "Antarctica/Mawson\0"
+    "Antarctica/McMurdo\0"
+    "Antarctica/Palmer\0"
+    "Antarctica/Rothera\0"
+    "Antarctica/Syowa\0"
+    "Antarctica/Troll\0"
+    "Antarctica/Vostok\0"
+    "Arctic/Longyearbyen\0"
+    "Asia/Aden\0"
+    "Asia/Almaty\0"
+    "Asia/Amman\0"
+    "Asia/Anadyr\0"
+    "Asia/Aqtau\0"
+    "Asia/Aqtobe\0"
+    "Asia/Ashgabat\0"
+    "Asia/Atyrau\0"
+    "Asia/Baghdad\0"
+    "Asia/Bahrain\0"
+    "Asia/Baku\0"
+    "Asia/Bangkok\0"
+    "Asia/Barnaul\0"
+    "Asia/Beirut\0"
+    "Asia/Bishkek\0"
+    "Asia/Brunei\0"
+    "Asia/Chita\0"
+    "Asia/Choibalsan\0"
+    "Asia/Colombo\0"
+    "Asia/Damascus\0"
+    "Asia/Dhaka\0"
+    "Asia/Dili\0"
+    "Asia/Dubai\0"
+    "Asia/Dushanbe\0"
+    "Asia/Famagusta\0"
+    "Asia/Gaza\0"
+    "Asia/Hebron\0"
+    "Asia/Ho_Chi_Minh\0"
+    "Asia/Hong_Kong\0"
+    "Asia/Hovd\0"
+    "Asia/Irkutsk\0"
+    "Asia/Jakarta\0"
+    "Asia/Jayapura\0"
+    "Asia/Jerusalem\0"
+    "Asia/Kabul\0"
+    "Asia/Kamchatka\0"
+    "Asia/Karachi\0"
+    "Asia/Kathmandu\0"
+    "Asia/Khandyga\0"
+    "Asia/Kolkata\0"
+    "Asia/Krasnoyarsk\0"
+    "Asia/Kuala_Lumpur\0"
+    "Asia/Kuching\0"
+    "Asia/Kuwait\0"
+    "Asia/Macau\0"
+    "Asia/Magadan\0"
+    "Asia/Makassar\0"
+    "Asia/Manila\0"
+    "Asia/Muscat\0"
+    "Asia/Nicosia\0"
+    "Asia/Novokuznetsk\0"
+    "Asia/Novosibirsk\0"
+    "Asia/Omsk\0"
+    "Asia/Oral\0"
+    "Asia/Phnom_Penh\0"
+    "Asia/Pontianak\0"
+    "Asia/Pyongyang\0"
+    "Asia/Qatar\0"
+    "Asia/Qyzylorda\0"
+    "Asia/Riyadh\0"
+    "Asia/Sakhalin\0"
+    "Asia/Samarkand\0"
+    "Asia/Seoul\0"
+    "Asia/Shanghai\0"
+    "Asia/Singapore\0"
+    "Asia/Srednekolymsk\0"
+    "Asia/Taipei\0"
+    "Asia/Tashkent\0"
+    "Asia/Tbilisi\0"
+    "Asia/Tehran\0"
+    "Asia/Thimphu\0"
+    "Asia/Tokyo\0"
+    "Asia/Tomsk\0"
+    "Asia/Ulaanbaatar\0"
+    "Asia/Urumqi\0"
+    "Asia/Ust-Nera\0"
+    "Asia/Vientiane\0"
+    "Asia/Vladivostok\0"
+    "Asia/Yakutsk\0"
+    "Asia/Yangon\0"
+    "Asia/Yekaterinburg\0"
+    "Asia/Yerevan\0"
+    "Atlantic/Azores\0"
+    "Atlantic/Bermuda\0"
+    "Atlantic/Canary\0"
+    "Atlantic/Cape_Verde\0"
+    "Atlantic/Faroe\0"
+    "Atlantic/Madeira\0"
+    "Atlantic/Reykjavik\0"
+    "Atlantic/South_Georgia\0"
+    "Atlantic/St_Helena\0"
+    "Atlantic/Stanley\0"
+    "Australia/Adelaide\0"
+    "Australia/Brisbane\0"
+    "Australia/Broken_Hill\0"
+    "Australia/Currie\0"
+    "Australia/Darwin\0"
+    "Australia/Eucla\0"
+    "Australia/Hobart\0"
+    "Australia/Lindeman\0"
+    "Australia/Lord_Howe\0"
+    "Australia/Melbourne\0"
+    "Australia/Perth\0"
+    "Australia/Sydney\0"
+    "Etc/GMT\0"
+    "Etc/GMT+0\0"
+    "Etc/GMT+1\0"
+    "Etc/GMT+10\0"
+    "Etc/GMT+11\0"
+    "Etc/GMT+12\0"
+    "Etc/GMT+2\0"
+    "Etc/GMT+3\0"
+    "Etc/GMT+4\0"
+    "Etc/GMT+5\0"
+    "Etc/GMT+6\0"
+    "Etc/GMT+7\0"
+    "Etc/GMT+8\0"
+    "Etc/GMT+9\0"
+    "Etc/GMT-0\0"
+    "Etc/GMT-1\0"
+    "Etc/GMT-10\0"
+    "Etc/GMT-11\0"
+    "Etc/GMT-12\0"
+    "Etc/GMT-13\0"
+    "Etc/GMT-14\0"
+    "Etc/GMT-2\0"
+    "Etc/GMT-3\0"
+    "Etc/GMT-4\0"
+    "Etc/GMT-5\0"
+    "Etc/GMT-6\0"
+    "Etc/GMT-7\0"
+    "Etc/GMT-8\0"
+    "Etc/GMT-9\0"
+    "Etc/GMT0\0"
+    "Etc/Greenwich\0"
+    "Etc/UCT\0"
+    "Etc/UTC\0"
+    "Etc/Universal\0"
+    "Etc/Zulu\0"
+    "Europe/Amsterdam\0"
+    "Europe/Andorra\0"
+    "Europe/Astrakhan\0"
+    "Europe/Athens\0"
+    "Europe/Belgrade\0"
+    "Europe/Berlin\0"
+    "Europe/Bratislava\0"
+    "Europe/Brussels\0"
+    "Europe/Bucharest\0"
+    "Europe/Budapest\0"
+    "Europe/Busingen\0"
+    "Europe/Chisinau\0"
+    "Europe/Copenhagen\0"
+    "Europe/Dublin\0"
+    "Europe/Gibraltar\0"
+    "Europe/Guernsey\0"
+    "Europe/Helsinki\0"
+    "Europe/Isle_of_Man\0"
+    "Europe/Istanbul\0"
+    "Europe/Jersey\0"
+    "Europe/Kaliningrad\0"
+    "Europe/Kiev\0"
+    "Europe/Kirov\0"
+    "Europe/Lisbon\0"
+    "Europe/Ljubljana\0"
+    "Europe/London\0"
+    "Europe/Luxembourg\0"
+    "Europe/Madrid\0"
+    "Europe/Malta\0"
+    "Europe/Mariehamn\0"
+    "Europe/Minsk\0"
+    "Europe/Monaco\0"
+    "Europe/Moscow\0"
+    "Europe/Oslo\0"
+    "Europe/Paris\0"
+    "Europe/Podgorica\0"
+    "Europe/Prague\0"
+    "Europe/Riga\0"
+    "Europe/Rome\0"
+    "Europe/Samara\0"
+    "Europe/San_Marino\0"
+    "Europe/Sarajevo\0"
+    "Europe/Saratov\0"
+    "Europe/Simferopol\0"
+    "Europe/Skopje\0"
+    "Europe/Sofia\0"
+    "Europe/Stockholm\0"
+    "Europe/Tallinn\0"
+    "Europe/Tirane\0"
+    "Europe/Ulyanovsk\0"
+    "Europe/Uzhgorod\0"
+    "Europe/Vaduz\0"
+    "Europe/Vatican\0"
+    "Europe/Vienna\0"
+    "Europe/Vilnius\0"
+    "Europe/Volgograd\0"
+    "Europe/Warsaw\0"
+    "Europe/Zagreb\0"
+    "Europe/Zaporozhye\0"
+    "Europe/Zurich\0"
+    "Indian/Antananarivo\0"
+    "Indian/Chagos\0"
+    "Indian/Christmas\0"
+    "Indian/Cocos\0"
+    "Indian/Comoro\0"
+    "Indian/Kerguelen\0"
+    "Indian/Mahe\0"
+    "Indian/Maldives\0"
+    "Indian/Mauritius\0"
+    "Indian/Mayotte\0"
+    "Indian/Reunion\0"
+    "Pacific/Apia\0"
+    "Pacific/Auckland\0"
+    "Pacific/Bougainville\0"
+    "Pacific/Chatham\0"
+    "Pacific/Chuuk\0"
+    "Pacific/Easter\0"
+    "Pacific/Efate\0"
+    "Pacific/Enderbury\0"
+    "Pacific/Fakaofo\0"
+    "Pacific/Fiji\0"
+    "Pacific/Funafuti\0"
+    "Pacific/Galapagos\0"
+    "Pacific/Gambier\0"
+    "Pacific/Guadalcanal\0"
+    "Pacific/Guam\0"
+    "Pacific/Honolulu\0"
+    "Pacific/Kiritimati\0"
+    "Pacific/Kosrae\0"
+    "Pacific/Kwajalein\0"
+    "Pacific/Majuro\0"
+    "Pacific/Marquesas\0"
+    "Pacific/Midway\0"
+    "Pacific/Nauru\0"
+    "Pacific/Niue\0"
+    "Pacific/Norfolk\0"
+    "Pacific/Noumea\0"
+    "Pacific/Pago_Pago\0"
+    "Pacific/Palau\0"
+    "Pacific/Pitcairn\0"
+    "Pacific/Pohnpei\0"
+    "Pacific/Port_Moresby\0"
+    "Pacific/Rarotonga\0"
+    "Pacific/Saipan\0"
+    "Pacific/Tahiti\0"
+    "Pacific/Tarawa\0"
+    "Pacific/Tongatapu\0"
+    "Pacific/Wake\0"
+    "Pacific/Wallis\0";
+
+// {name offset, rule offset}, sorted by name
+static const uint16_t TZDB_INDEX[TZDB_ZONE_COUNT][2] PROGMEM = {
+    {0, 0},  // Africa/Abidjan
+    {15, 0},  // Africa/Accra
+    {28, 5},  // Africa/Addis_Ababa
+    {47, 11},  // Africa/Algiers
+    {62, 5},  // Africa/Asmara
+    {76, 0},  // Africa/Bamako
+    {90, 17},  // Africa/Bangui
+    {104, 0},  // Africa/Banjul
+    {118, 0},  // Africa/Bissau
+    {132, 23},  // Africa/Blantyre
+    {148, 17},  // Africa/Brazzaville
+    {167, 23},  // Africa/Bujumbura
+    {184, 29},  // Africa/Cairo
+    {197, 35},  // Africa/Casablanca
+    {215, 43},  // Africa/Ceuta
+    {228, 0},  // Africa/Conakry
+    {243, 0},  // Africa/Dakar
+    {256, 5},  // Africa/Dar_es_Salaam
+    {277, 5},  // Africa/Djibouti
+    {293, 17},  // Africa/Douala
+    {307, 35},  // Africa/El_Aaiun
+    {323, 0},  // Africa/Freetown
+    {339, 23},  // Africa/Gaborone
+    {355, 23},  // Africa/Harare
+    {369, 70},  // Africa/Johannesburg
+    {389, 5},  // Africa/Juba
+    {401, 5},  // Africa/Kampala
+    {416, 23},  // Africa/Khartoum
+    {432, 23},  // Africa/Kigali
+    {446, 17},  // Africa/Kinshasa
+    {462, 17},  // Africa/Lagos
+    {475, 17},  // Africa/Libreville
+    {493, 0},  // Africa/Lome
+    {505, 17},  // Africa/Luanda
+    {519, 23},  // Africa/Lubumbashi
+    {537, 23},  // Africa/Lusaka
+    {551, 17},  // Africa/Malabo
+    {565, 23},  // Africa/Maputo
+    {579, 70},  // Africa/Maseru
+    {593, 70},  // Africa/Mbabane
+    {608, 5},  // Africa/Mogadishu
+    {625, 0},  // Africa/Monrovia
+    {641, 5},  // Africa/Nairobi
+    {656, 17},  // Africa/Ndjamena
+    {672, 17},  // Africa/Niamey
+    {686, 0},  // Africa/Nouakchott
+    {704, 0},  // Africa/Ouagadougou
+    {723, 17},  // Africa/PortomNovo
+    {741, 0},  // Africa/Sao_Tome
+    {757, 29},  // Africa/Tripoli
+    {772, 11},  // Africa/Tunis
+    {785, 23},  // Africa/Windhoek
+    {801, 77},  // America/Adak
+    {814, 101},  // America/Anchorage
+    {832, 126},  // America/Anguilla
+    {849, 126},  // America/Antigua
+    {865, 131},  // America/Araguaina
+    {883, 131},  // America/Argentina/Buenos_Aires
+    {914, 131},  // America/Argentina/Catamarca
+    {942, 131},  // America/Argentina/Cordoba
+    {968, 131},  // America/Argentina/Jujuy
+    {992, 131},  // America/Argentina/La_Rioja
+    {1019, 131},  // America/Argentina/Mendoza
+    {1045, 131},  // America/Argentina/Rio_Gallegos
+    {1076, 131},  // America/Argentina/Salta
+    {1100, 131},  // America/Argentina/San_Juan
+    {1127, 131},  // America/Argentina/San_Luis
+    {1154, 131},  // America/Argentina/Tucuman
+    {1180, 131},  // America/Argentina/Ushuaia
+    {1206, 126},  // America/Aruba
+    {1220, 138},  // America/Asuncion
+    {1237, 169},  // America/Atikokan
+    {1254, 131},  // America/Bahia
+    {1268, 174},  // America/Bahia_Banderas
+    {1291, 126},  // America/Barbados
+    {1308, 131},  // America/Belem
+    {1322, 197},  // America/Belize
+    {1337, 126},  // America/Blanc-Sablon
+    {1358, 202},  // America/Boa_Vista
+    {1376, 209},  // America/Bogota
+    {1391, 216},  // America/Boise
+    {1405, 216},  // America/Cambridge_Bay
+    {1427, 202},  // America/Campo_Grande
+    {1448, 169},  // America/Cancun
+    {1463, 202},  // America/Caracas
+    {1479, 131},  // America/Cayenne
+    {1495, 169},  // America/Cayman
+    {1510, 239},  // America/Chicago
+    {1526, 262},  // America/Chihuahua
+    {1544, 197},  // America/Costa_Rica
+    {1563, 285},  // America/Creston
+    {1579, 202},  // America/Cuiaba
+    {1594, 126},  // America/Curacao
+    {1610, 0},  // America/Danmarkshavn
+    {1631, 285},  // America/Dawson
+    {1646, 285},  // America/Dawson_Creek
+    {1667, 216},  // America/Denver
+    {1682, 290},  // America/Detroit
+    {1698, 126},  // America/Dominica
+    {1715, 216},  // America/Edmonton
+    {1732, 209},  // America/Eirunepe
+    {1749, 197},  // America/El_Salvador
+    {1769, 285},  // America/Fort_Nelson
+    {1789, 131},  // America/Fortaleza
+    {1807, 313},  // America/Glace_Bay
+    {1825, 336},  // America/Godthab
+    {1841, 313},  // America/Goose_Bay
+    {1859, 290},  // America/Grand_Turk
+    {1878, 126},  // America/Grenada
+    {1894, 126},  // America/Guadeloupe
+    {1913, 197},  // America/Guatemala
+    {1931, 209},  // America/Guayaquil
+    {1949, 202},  // America/Guyana
+    {1964, 313},  // America/Halifax
+    {1980, 369},  // America/Havana
+    {1995, 285},  // America/Hermosillo
+    {2014, 290},  // America/Indiana/Indianapolis
+    {2043, 239},  // America/Indiana/Knox
+    {2064, 290},  // America/Indiana/Marengo
+    {2088, 290},  // America/Indiana/Petersburg
+    {2115, 239},  // America/Indiana/Tell_City
+    {2141, 290},  // America/Indiana/Vevay
+    {2163, 290},  // America/Indiana/Vincennes
+    {2189, 290},  // America/Indiana/Winamac
+    {2213, 216},  // America/Inuvik
+    {2228, 290},  // America/Iqaluit
+    {2244, 169},  // America/Jamaica
+    {2260, 101},  // America/Juneau
+    {2275, 290},  // America/Kentucky/Louisville
+    {2303, 290},  // America/Kentucky/Monticello
+    {2331, 126},  // America/Kralendijk
+    {2350, 202},  // America/La_Paz
+    {2365, 209},  // America/Lima
+    {2378, 396},  // America/Los_Angeles
+    {2398, 126},  // America/Lower_Princes
+    {2420, 131},  // America/Maceio
+    {2435, 197},  // America/Managua
+    {2451, 202},  // America/Manaus
+    {2466, 126},  // America/Marigot
+    {2482, 126},  // America/Martinique
+    {2501, 239},  // America/Matamoros
+    {2519, 262},  // America/Mazatlan
+    {2536, 239},  // America/Menominee
+    {2554, 174},  // America/Merida
+    {2569, 101},  // America/Metlakatla
+    {2588, 174},  // America/Mexico_City
+    {2608, 419},  // America/Miquelon
+    {2625, 313},  // America/Moncton
+    {2641, 174},  // America/Monterrey
+    {2659, 131},  // America/Montevideo
+    {2678, 290},  // America/Montreal
+    {2695, 126},  // America/Montserrat
+    {2714, 290},  // America/Nassau
+    {2729, 290},  // America/New_York
+    {2746, 290},  // America/Nipigon
+    {2762, 101},  // America/Nome
+    {2775, 446},  // America/Noronha
+    {2791, 239},  // America/North_Dakota/Beulah
+    {2819, 239},  // America/North_Dakota/Center
+    {2847, 239},  // America/North_Dakota/New_Salem
+    {2878, 216},  // America/Ojinaga
+    {2894, 169},  // America/Panama
+    {2909, 290},  // America/Pangnirtung
+    {2929, 131},  // America/Paramaribo
+    {2948, 285},  // America/Phoenix
+    {2964, 290},  // America/Port-au-Prince
+    {2987, 126},  // America/Port_of_Spain
+    {3009, 202},  // America/Porto_Velho
+    {3029, 126},  // America/Puerto_Rico
+    {3049, 131},  // America/Punta_Arenas
+    {3070, 239},  // America/Rainy_River
+    {3090, 239},  // America/Rankin_Inlet
+    {3111, 131},  // America/Recife
+    {3126, 197},  // America/Regina
+    {3141, 239},  // America/Resolute
+    {3158, 209},  // America/Rio_Branco
+    {3177, 131},  // America/Santarem
+    {3194, 453},  // America/Santiago
+    {3211, 126},  // America/Santo_Domingo
+    {3233, 131},  // America/Sao_Paulo
+    {3251, 485},  // America/Scoresbysund
+    {3272, 101},  // America/Sitka
+    {3286, 126},  // America/St_Barthelemy
+    {3308, 516},  // America/St_Johns
+    {3325, 126},  // America/St_Kitts
+    {3342, 126},  // America/St_Lucia
+    {3359, 126},  // America/St_Thomas
+    {3377, 126},  // America/St_Vincent
+    {3396, 197},  // America/Swift_Current
+    {3418, 197},  // America/Tegucigalpa
+    {3438, 313},  // America/Thule
+    {3452, 290},  // America/Thunder_Bay
+    {3472, 396},  // America/Tijuana
+    {3488, 290},  // America/Toronto
+    {3504, 126},  // America/Tortola
+    {3520, 396},  // America/Vancouver
+    {3538, 285},  // America/Whitehorse
+    {3557, 239},  // America/Winnipeg
+    {3574, 101},  // America/Yakutat
+    {3590, 216},  // America/Yellowknife
+    {3610, 542},  // Antarctica/Casey
+    {3627, 551},  // Antarctica/Davis
+    {3644, 559},  // Antarctica/DumontDUrville
+    {3670, 568},  // Antarctica/Macquarie
+    {3691, 597},  // Antarctica/Mawson
+    {3709, 605},  // Antarctica/McMurdo
+    {3728, 131},  // Antarctica/Palmer
+    {3746, 131},  // Antarctica/Rothera
+    {3765, 633},  // Antarctica/Syowa
+    {3782, 641},  // Antarctica/Troll
+    {3799, 674},  // Antarctica/Vostok
+    {3817, 43},  // Arctic/Longyearbyen
+    {3837, 633},  // Asia/Aden
+    {3847, 674},  // Asia/Almaty
+    {3859, 682},  // Asia/Amman
+    {3870, 712},  // Asia/Anadyr
+    {3882, 597},  // Asia/Aqtau
+    {3893, 597},  // Asia/Aqtobe
+    {3905, 597},  // Asia/Ashgabat
+    {3919, 597},  // Asia/Atyrau
+    {3931, 633},  // Asia/Baghdad
+    {3944, 633},  // Asia/Bahrain
+    {3957, 721},  // Asia/Baku
+    {3967, 551},  // Asia/Bangkok
+    {3980, 551},  // Asia/Barnaul
+    {3993, 729},  // Asia/Beirut
+    {4005, 674},  // Asia/Bishkek
+    {4018, 758},  // Asia/Brunei
+    {4030, 766},  // Asia/Chita
+    {4041, 758},  // Asia/Choibalsan
+    {4057, 774},  // Asia/Colombo
+    {4070, 787},  // Asia/Damascus
+    {4084, 674},  // Asia/Dhaka
+    {4095, 766},  // Asia/Dili
+    {4105, 721},  // Asia/Dubai
+    {4116, 597},  // Asia/Dushanbe
+    {4130, 816},  // Asia/Famagusta
+    {4145, 845},  // Asia/Gaza
+    {4155, 845},  // Asia/Hebron
+    {4167, 551},  // Asia/Ho_Chi_Minh
+    {4184, 876},  // Asia/Hong_Kong
+    {4199, 551},  // Asia/Hovd
+    {4209, 758},  // Asia/Irkutsk
+    {4222, 882},  // Asia/Jakarta
+    {4235, 888},  // Asia/Jayapura
+    {4249, 894},  // Asia/Jerusalem
+    {4264, 921},  // Asia/Kabul
+    {4275, 712},  // Asia/Kamchatka
+    {4290, 934},  // Asia/Karachi
+    {4303, 940},  // Asia/Kathmandu
+    {4318, 766},  // Asia/Khandyga
+    {4332, 953},  // Asia/Kolkata
+    {4345, 551},  // Asia/Krasnoyarsk
+    {4362, 758},  // Asia/Kuala_Lumpur
+    {4380, 758},  // Asia/Kuching
+    {4393, 633},  // Asia/Kuwait
+    {4405, 962},  // Asia/Macau
+    {4416, 542},  // Asia/Magadan
+    {4429, 968},  // Asia/Makassar
+    {4443, 975},  // Asia/Manila
+    {4455, 721},  // Asia/Muscat
+    {4467, 816},  // Asia/Nicosia
+    {4480, 551},  // Asia/Novokuznetsk
+    {4498, 551},  // Asia/Novosibirsk
+    {4515, 674},  // Asia/Omsk
+    {4525, 597},  // Asia/Oral
+    {4535, 551},  // Asia/Phnom_Penh
+    {4551, 882},  // Asia/Pontianak
+    {4566, 981},  // Asia/Pyongyang
+    {4581, 633},  // Asia/Qatar
+    {4592, 597},  // Asia/Qyzylorda
+    {4607, 633},  // Asia/Riyadh
+    {4619, 542},  // Asia/Sakhalin
+    {4633, 597},  // Asia/Samarkand
+    {4648, 981},  // Asia/Seoul
+    {4659, 962},  // Asia/Shanghai
+    {4673, 758},  // Asia/Singapore
+    {4688, 542},  // Asia/Srednekolymsk
+    {4707, 962},  // Asia/Taipei
+    {4719, 597},  // Asia/Tashkent
+    {4733, 721},  // Asia/Tbilisi
+    {4746, 987},  // Asia/Tehran
+    {4758, 674},  // Asia/Thimphu
+    {4771, 1022},  // Asia/Tokyo
+    {4782, 551},  // Asia/Tomsk
+    {4793, 758},  // Asia/Ulaanbaatar
+    {4810, 674},  // Asia/Urumqi
+    {4822, 559},  // Asia/Ust-Nera
+    {4836, 551},  // Asia/Vientiane
+    {4851, 559},  // Asia/Vladivostok
+    {4868, 766},  // Asia/Yakutsk
+    {4881, 1028},  // Asia/Yangon
+    {4893, 597},  // Asia/Yekaterinburg
+    {4912, 721},  // Asia/Yerevan
+    {4925, 485},  // Atlantic/Azores
+    {4941, 313},  // Atlantic/Bermuda
+    {4958, 1041},  // Atlantic/Canary
+    {4974, 1067},  // Atlantic/Cape_Verde
+    {4994, 1041},  // Atlantic/Faroe
+    {5009, 1041},  // Atlantic/Madeira
+    {5026, 0},  // Atlantic/Reykjavik
+    {5045, 446},  // Atlantic/South_Georgia
+    {5068, 0},  // Atlantic/St_Helena
+    {5087, 131},  // Atlantic/Stanley
+    {5104, 1074},  // Australia/Adelaide
+    {5123, 1105},  // Australia/Brisbane
+    {5142, 1074},  // Australia/Broken_Hill
+    {5164, 568},  // Australia/Currie
+    {5181, 1113},  // Australia/Darwin
+    {5198, 1123},  // Australia/Eucla
+    {5214, 568},  // Australia/Hobart
+    {5231, 1105},  // Australia/Lindeman
+    {5250, 1136},  // Australia/Lord_Howe
+    {5270, 568},  // Australia/Melbourne
+    {5290, 1173},  // Australia/Perth
+    {5306, 568},  // Australia/Sydney
+    {5323, 0},  // Etc/GMT
+    {5331, 0},  // Etc/GMT+0
+    {5341, 1067},  // Etc/GMT+1
+    {5351, 1180},  // Etc/GMT+10
+    {5362, 1188},  // Etc/GMT+11
+    {5373, 1196},  // Etc/GMT+12
+    {5384, 446},  // Etc/GMT+2
+    {5394, 131},  // Etc/GMT+3
+    {5404, 202},  // Etc/GMT+4
+    {5414, 209},  // Etc/GMT+5
+    {5424, 1204},  // Etc/GMT+6
+    {5434, 1211},  // Etc/GMT+7
+    {5444, 1218},  // Etc/GMT+8
+    {5454, 1225},  // Etc/GMT+9
+    {5464, 0},  // Etc/GMT-0
+    {5474, 35},  // Etc/GMT-1
+    {5484, 559},  // Etc/GMT-10
+    {5495, 542},  // Etc/GMT-11
+    {5506, 712},  // Etc/GMT-12
+    {5517, 1232},  // Etc/GMT-13
+    {5528, 1241},  // Etc/GMT-14
+    {5539, 1250},  // Etc/GMT-2
+    {5549, 633},  // Etc/GMT-3
+    {5559, 721},  // Etc/GMT-4
+    {5569, 597},  // Etc/GMT-5
+    {5579, 674},  // Etc/GMT-6
+    {5589, 551},  // Etc/GMT-7
+    {5599, 758},  // Etc/GMT-8
+    {5609, 766},  // Etc/GMT-9
+    {5619, 0},  // Etc/GMT0
+    {5628, 0},  // Etc/Greenwich
+    {5642, 1258},  // Etc/UCT
+    {5650, 1258},  // Etc/UTC
+    {5658, 1258},  // Etc/Universal
+    {5672, 1258},  // Etc/Zulu
+    {5681, 43},  // Europe/Amsterdam
+    {5698, 43},  // Europe/Andorra
+    {5713, 721},  // Europe/Astrakhan
+    {5730, 816},  // Europe/Athens
+    {5744, 43},  // Europe/Belgrade
+    {5760, 43},  // Europe/Berlin
+    {5774, 43},  // Europe/Bratislava
+    {5792, 43},  // Europe/Brussels
+    {5808, 816},  // Europe/Bucharest
+    {5825, 43},  // Europe/Budapest
+    {5841, 43},  // Europe/Busingen
+    {5857, 1263},  // Europe/Chisinau
+    {5873, 43},  // Europe/Copenhagen
+    {5891, 1290},  // Europe/Dublin
+    {5905, 43},  // Europe/Gibraltar
+    {5922, 1317},  // Europe/Guernsey
+    {5938, 816},  // Europe/Helsinki
+    {5954, 1317},  // Europe/Isle_of_Man
+    {5973, 633},  // Europe/Istanbul
+    {5989, 1317},  // Europe/Jersey
+    {6003, 29},  // Europe/Kaliningrad
+    {6022, 816},  // Europe/Kiev
+    {6034, 633},  // Europe/Kirov
+    {6047, 1041},  // Europe/Lisbon
+    {6061, 43},  // Europe/Ljubljana
+    {6078, 1317},  // Europe/London
+    {6092, 43},  // Europe/Luxembourg
+    {6110, 43},  // Europe/Madrid
+    {6124, 43},  // Europe/Malta
+    {6137, 816},  // Europe/Mariehamn
+    {6154, 633},  // Europe/Minsk
+    {6167, 43},  // Europe/Monaco
+    {6181, 1342},  // Europe/Moscow
+    {6195, 43},  // Europe/Oslo
+    {6207, 43},  // Europe/Paris
+    {6220, 43},  // Europe/Podgorica
+    {6237, 43},  // Europe/Prague
+    {6251, 816},  // Europe/Riga
+    {6263, 43},  // Europe/Rome
+    {6275, 721},  // Europe/Samara
+    {6289, 43},  // Europe/San_Marino
+    {6307, 43},  // Europe/Sarajevo
+    {6323, 721},  // Europe/Saratov
+    {6338, 1342},  // Europe/Simferopol
+    {6356, 43},  // Europe/Skopje
+    {6370, 816},  // Europe/Sofia
+    {6383, 43},  // Europe/Stockholm
+    {6400, 816},  // Europe/Tallinn
+    {6415, 43},  // Europe/Tirane
+    {6429, 721},  // Europe/Ulyanovsk
+    {6446, 816},  // Europe/Uzhgorod
+    {6462, 43},  // Europe/Vaduz
+    {6475, 43},  // Europe/Vatican
+    {6490, 43},  // Europe/Vienna
+    {6504, 816},  // Europe/Vilnius
+    {6519, 721},  // Europe/Volgograd
+    {6536, 43},  // Europe/Warsaw
+    {6550, 43},  // Europe/Zagreb
+    {6564, 816},  // Europe/Zaporozhye
+    {6582, 43},  // Europe/Zurich
+    {6596, 5},  // Indian/Antananarivo
+    {6616, 674},  // Indian/Chagos
+    {6630, 551},  // Indian/Christmas
+    {6647, 1028},  // Indian/Cocos
+    {6660, 5},  // Indian/Comoro
+    {6674, 597},  // Indian/Kerguelen
+    {6691, 721},  // Indian/Mahe
+    {6703, 597},  // Indian/Maldives
+    {6719, 721},  // Indian/Mauritius
+    {6736, 5},  // Indian/Mayotte
+    {6751, 721},  // Indian/Reunion
+    {6766, 1348},  // Pacific/Apia
+    {6779, 605},  // Pacific/Auckland
+    {6796, 542},  // Pacific/Bougainville
+    {6817, 1380},  // Pacific/Chatham
+    {6833, 559},  // Pacific/Chuuk
+    {6847, 1425},  // Pacific/Easter
+    {6862, 542},  // Pacific/Efate
+    {6876, 1232},  // Pacific/Enderbury
+    {6894, 1232},  // Pacific/Fakaofo
+    {6910, 1457},  // Pacific/Fiji
+    {6923, 712},  // Pacific/Funafuti
+    {6940, 1204},  // Pacific/Galapagos
+    {6958, 1225},  // Pacific/Gambier
+    {6974, 542},  // Pacific/Guadalcanal
+    {6994, 1489},  // Pacific/Guam
+    {7007, 1497},  // Pacific/Honolulu
+    {7024, 1241},  // Pacific/Kiritimati
+    {7043, 542},  // Pacific/Kosrae
+    {7058, 712},  // Pacific/Kwajalein
+    {7076, 712},  // Pacific/Majuro
+    {7091, 1503},  // Pacific/Marquesas
+    {7109, 1515},  // Pacific/Midway
+    {7124, 712},  // Pacific/Nauru
+    {7138, 1188},  // Pacific/Niue
+    {7151, 1521},  // Pacific/Norfolk
+    {7167, 542},  // Pacific/Noumea
+    {7182, 1515},  // Pacific/Pago_Pago
+    {7200, 766},  // Pacific/Palau
+    {7214, 1218},  // Pacific/Pitcairn
+    {7231, 542},  // Pacific/Pohnpei
+    {7247, 559},  // Pacific/Port_Moresby
+    {7268, 1180},  // Pacific/Rarotonga
+    {7286, 1489},  // Pacific/Saipan
+    {7301, 1180},  // Pacific/Tahiti
+    {7316, 712},  // Pacific/Tarawa
+    {7331, 1232},  // Pacific/Tongatapu
+    {7349, 712},  // Pacific/Wake
+    {7362, 712},  // Pacific/Wallis
+};
+
+#endif
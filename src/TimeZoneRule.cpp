@@ -0,0 +1,316 @@
+#include "TimeZoneRule.h"
+#include <Arduino.h>
+#include "DateTimeCivil.h"
+
+static bool isAlpha(const char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+
+static const char* parseNumber(const char* p, int32_t* value,
+                               const int32_t maxValue) {
+  if (!isDigit(*p)) {
+    return nullptr;
+  }
+  int32_t v = 0;
+  while (isDigit(*p)) {
+    v = v * 10 + (*p++ - '0');
+    if (v > maxValue) {
+      return nullptr;
+    }
+  }
+  *value = v;
+  return p;
+}
+
+// zone abbreviation, alphabetic (CST) or quoted (<+0530>)
+static const char* parseName(const char* p, char* name) {
+  size_t len = 0;
+  if (*p == '<') {
+    p++;
+    while (*p && *p != '>') {
+      if (len < TimeZoneRule::NAME_SIZE - 1) {
+        name[len] = *p;
+      }
+      len++;
+      p++;
+    }
+    if (*p++ != '>') {
+      return nullptr;
+    }
+  } else {
+    while (isAlpha(*p)) {
+      if (len < TimeZoneRule::NAME_SIZE - 1) {
+        name[len] = *p;
+      }
+      len++;
+      p++;
+    }
+  }
+  if (len < 3) {
+    return nullptr;
+  }
+  name[len < TimeZoneRule::NAME_SIZE ? len : TimeZoneRule::NAME_SIZE - 1] =
+      '\0';
+  return p;
+}
+
+// [+|-]hh[:mm[:ss]], returns seconds
+static const char* parseTime(const char* p, int32_t* secs,
+                             const int32_t maxHours) {
+  int32_t sign = 1;
+  if (*p == '+' || *p == '-') {
+    sign = *p++ == '-' ? -1 : 1;
+  }
+  int32_t h = 0, m = 0, s = 0;
+  p = parseNumber(p, &h, maxHours);
+  if (p && *p == ':') {
+    p = parseNumber(p + 1, &m, 59);
+    if (p && *p == ':') {
+      p = parseNumber(p + 1, &s, 59);
+    }
+  }
+  if (p) {
+    *secs = sign * (h * 3600 + m * 60 + s);
+  }
+  return p;
+}
+
+// Mm.w.d[/time], Jn[/time] or n[/time]
+static const char* parseRule(const char* p, TimeZoneDstRule* rule) {
+  int32_t v = 0;
+  memset(rule, 0, sizeof(*rule));
+  if (*p == 'M') {
+    rule->kind = 'M';
+    p = parseNumber(p + 1, &v, 12);
+    if (!p || v < 1 || *p != '.') return nullptr;
+    rule->month = (uint8_t)v;
+    p = parseNumber(p + 1, &v, 5);
+    if (!p || v < 1 || *p != '.') return nullptr;
+    rule->week = (uint8_t)v;
+    p = parseNumber(p + 1, &v, 6);
+    if (!p) return nullptr;
+    rule->wday = (uint8_t)v;
+  } else if (*p == 'J') {
+    rule->kind = 'J';
+    p = parseNumber(p + 1, &v, 365);
+    if (!p || v < 1) return nullptr;
+    rule->day = (uint16_t)v;
+  } else {
+    rule->kind = 'D';
+    p = parseNumber(p, &v, 365);
+    if (!p) return nullptr;
+    rule->day = (uint16_t)v;
+  }
+  rule->time = 2 * 3600;
+  if (*p == '/') {
+    // extended POSIX allows -167..167 hours
+    p = parseTime(p + 1, &rule->time, 167);
+  }
+  return p;
+}
+
+// day of year the rule applies, as days since epoch
+static int32_t ruleDay(const TimeZoneDstRule& rule, const int32_t year) {
+  const int32_t jan1 = DateTimeCivil::daysFromCivil(year, 1, 1);
+  if (rule.kind == 'J') {
+    const bool afterLeapDay =
+        DateTimeCivil::isLeapYear(year) && rule.day >= 60;
+    return jan1 + rule.day - 1 + (afterLeapDay ? 1 : 0);
+  }
+  if (rule.kind == 'D') {
+    return jan1 + rule.day;
+  }
+  const int32_t first = DateTimeCivil::daysFromCivil(year, rule.month, 1);
+  const int32_t next =
+      rule.month == 12 ? DateTimeCivil::daysFromCivil(year + 1, 1, 1)
+                       : DateTimeCivil::daysFromCivil(year, rule.month + 1, 1);
+  int32_t day = first +
+                (rule.wday - DateTimeCivil::weekDayFromDays(first) + 7) % 7 +
+                (rule.week - 1) * 7;
+  while (day >= next) {
+    day -= 7;
+  }
+  return day;
+}
+
+TimeZoneRule::TimeZoneRule() { reset(); }
+
+TimeZoneRule::TimeZoneRule(const char* tz) { parse(tz); }
+
+void TimeZoneRule::reset() {
+  source = nullptr;
+  stdOffset = 0;
+  dstOffset = 0;
+  memset(&startRule, 0, sizeof(startRule));
+  memset(&endRule, 0, sizeof(endRule));
+  strcpy(stdName, "UTC");
+  dstName[0] = '\0';
+  dst = false;
+  valid = true;
+  yearBegin = 0;
+  yearEnd = 0;
+  dstStart = 0;
+  dstEnd = 0;
+}
+
+bool TimeZoneRule::parse(const char* tz) {
+  reset();
+  source = tz;
+  valid = false;
+  if (tz == nullptr) {
+    return false;
+  }
+  // TZ strings may be PSTR (see DateTimeTZ.h), copy to RAM before parsing
+  if (strlen_P(tz) > MAX_LENGTH) {
+    return false;
+  }
+  char buf[MAX_LENGTH + 1];
+  strcpy_P(buf, tz);
+  const char* p = parseName(buf, stdName);
+  int32_t offset = 0;
+  if (p) {
+    p = parseTime(p, &offset, 24);
+  }
+  if (!p) {
+    strcpy(stdName, "UTC");
+    return false;
+  }
+  // POSIX offsets are west of UTC, store east of UTC like tm_gmtoff
+  stdOffset = -offset;
+  dstOffset = stdOffset;
+  if (*p != '\0') {
+    p = parseName(p, dstName);
+    if (!p) {
+      return false;
+    }
+    dst = true;
+    dstOffset = stdOffset + 3600;
+    if (*p != '\0' && *p != ',') {
+      p = parseTime(p, &offset, 24);
+      if (!p) {
+        return false;
+      }
+      dstOffset = -offset;
+    }
+    if (*p == ',') {
+      p = parseRule(p + 1, &startRule);
+      if (!p || *p != ',') {
+        return false;
+      }
+      p = parseRule(p + 1, &endRule);
+      if (!p || *p != '\0') {
+        return false;
+      }
+    } else if (*p == '\0') {
+      // no rules, use the US rules like glibc and newlib
+      startRule = {'M', 3, 2, 0, 0, 2 * 3600};
+      endRule = {'M', 11, 1, 0, 0, 2 * 3600};
+    } else {
+      return false;
+    }
+  }
+  valid = true;
+  return true;
+}
+
+void TimeZoneRule::transitions(const int32_t year, int64_t* start,
+                               int64_t* end) const {
+  // start is given in standard time, end in daylight saving time
+  *start = (int64_t)ruleDay(startRule, year) * DateTimeCivil::SECS_PER_DAY +
+           startRule.time - stdOffset;
+  *end = (int64_t)ruleDay(endRule, year) * DateTimeCivil::SECS_PER_DAY +
+         endRule.time - dstOffset;
+}
+
+int32_t TimeZoneRule::yearAt(const int64_t utc) const {
+  int32_t secs;
+  const int32_t days = DateTimeCivil::splitDays(utc + stdOffset, &secs);
+  return DateTimeCivil::civilFromDays(days).year;
+}
+
+void TimeZoneRule::updateCache(const int64_t utc) const {
+  const int32_t year = yearAt(utc);
+  yearBegin = (int64_t)DateTimeCivil::daysFromCivil(year, 1, 1) *
+                  DateTimeCivil::SECS_PER_DAY -
+              stdOffset;
+  yearEnd = (int64_t)DateTimeCivil::daysFromCivil(year + 1, 1, 1) *
+                DateTimeCivil::SECS_PER_DAY -
+            stdOffset;
+  transitions(year, &dstStart, &dstEnd);
+}
+
+// southern hemisphere zones have dst over the new year
+static bool inDstRange(const int64_t t, const int64_t start,
+                       const int64_t end) {
+  return start < end ? (t >= start && t < end) : (t < end || t >= start);
+}
+
+int32_t TimeZoneRule::offsetAt(const time_t utc, int8_t* isdst) const {
+  bool inDst = false;
+  if (dst) {
+    const int64_t t = (int64_t)utc;
+    if (t < yearBegin || t >= yearEnd) {
+      updateCache(t);
+    }
+    inDst = inDstRange(t, dstStart, dstEnd);
+  }
+  if (isdst) {
+    *isdst = inDst ? 1 : 0;
+  }
+  return inDst ? dstOffset : stdOffset;
+}
+
+int32_t TimeZoneRule::sharedOffsetAt(const time_t utc, int8_t* isdst) const {
+  bool inDst = false;
+  if (dst) {
+    const int64_t t = (int64_t)utc;
+    if (t >= yearBegin && t < yearEnd) {
+      inDst = inDstRange(t, dstStart, dstEnd);
+    } else {
+      int64_t start, end;
+      transitions(yearAt(t), &start, &end);
+      inDst = inDstRange(t, start, end);
+    }
+  }
+  if (isdst) {
+    *isdst = inDst ? 1 : 0;
+  }
+  return inDst ? dstOffset : stdOffset;
+}
+
+int32_t TimeZoneRule::offsetSpan(const time_t utc, int64_t* begin,
+                                 int64_t* end, int8_t* isdst) const {
+  const int64_t t = (int64_t)utc;
+  if (!dst) {
+    *begin = INT64_MIN;
+    *end = INT64_MAX;
+    if (isdst) {
+      *isdst = 0;
+    }
+    return stdOffset;
+  }
+  if (t < yearBegin || t >= yearEnd) {
+    updateCache(t);
+  }
+  // the year splits at both transitions, in either order
+  const int64_t lo = dstStart < dstEnd ? dstStart : dstEnd;
+  const int64_t hi = dstStart < dstEnd ? dstEnd : dstStart;
+  int64_t b = t < lo ? yearBegin : t < hi ? lo : hi;
+  int64_t e = t < lo ? lo : t < hi ? hi : yearEnd;
+  b = b > yearBegin ? b : yearBegin;
+  e = e < yearEnd ? e : yearEnd;
+  if (b > t || e <= t) {
+    // transition outside its year, no span
+    b = t;
+    e = t + 1;
+  }
+  *begin = b;
+  *end = e;
+  const bool inDst = inDstRange(t, dstStart, dstEnd);
+  if (isdst) {
+    *isdst = inDst ? 1 : 0;
+  }
+  return inDst ? dstOffset : stdOffset;
+}
@@ -0,0 +1,178 @@
+#ifndef ESP_DATE_TIME_TIME_ZONE_RULE_H
+#define ESP_DATE_TIME_TIME_ZONE_RULE_H
+
+/**
+ * @file TimeZoneRule.h
+ * @author Zhang Xiaoke (github@mcxiaoke.com)
+ * @brief ESPDateTime POSIX TZ rule engine
+ *
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Daylight saving time start or end rule of a POSIX TZ string.
+ *
+ */
+struct TimeZoneDstRule {
+  uint8_t kind;  /**< 'M' (Mm.w.d), 'J' (Jn, 1-365 no leap day) or 'D' (n) */
+  uint8_t month; /**< month of year (1-12), for 'M' */
+  uint8_t week;  /**< week of month (1-5, 5 means last), for 'M' */
+  uint8_t wday;  /**< days since Sunday (0-6), for 'M' */
+  uint16_t day;  /**< day of year, for 'J' and 'D' */
+  int32_t time;  /**< local transition time in seconds, default 02:00:00 */
+};
+
+/**
+ * @brief Parsed POSIX TZ string, like "CST-8" or
+ * "CET-1CEST,M3.5.0,M10.5.0/3".
+ *
+ * The string is parsed once, the two DST transition instants of the last
+ * converted year are cached, so UTC to local conversion is a compare plus an
+ * add, without the libc global TZ state.
+ *
+ */
+class TimeZoneRule {
+ public:
+  /**
+   * @brief Max length of the zone abbreviations, longer names are truncated
+   *
+   */
+  constexpr static size_t NAME_SIZE = 8;
+  /**
+   * @brief Max length of the TZ string
+   *
+   */
+  constexpr static size_t MAX_LENGTH = 63;
+  /**
+   * @brief Construct a UTC rule
+   *
+   */
+  TimeZoneRule();
+  /**
+   * @brief Construct a rule by parsing POSIX TZ string
+   *
+   * @param tz POSIX TZ string, must outlive this object
+   */
+  explicit TimeZoneRule(const char* tz);
+  /**
+   * @brief Parse POSIX TZ string, replace current rule
+   *
+   * @param tz POSIX TZ string (RAM or PSTR), must outlive this object
+   * @return true if tz is valid
+   * @return false if tz is not valid, rule becomes UTC and isValid() false
+   */
+  bool parse(const char* tz);
+  /**
+   * @brief Check the last parse() result
+   *
+   * @return true if TZ string valid
+   */
+  inline bool isValid() const { return valid; }
+  /**
+   * @brief Check the zone has daylight saving time rules
+   *
+   * @return true if zone has dst
+   */
+  inline bool hasDst() const { return dst; }
+  /**
+   * @brief Get the source TZ string
+   *
+   * @return const char* TZ string passed to parse()
+   */
+  inline const char* getSource() const { return source; }
+  /**
+   * @brief Get standard time offset, seconds east of UTC
+   *
+   * @return int32_t offset seconds
+   */
+  inline int32_t getStdOffset() const { return stdOffset; }
+  /**
+   * @brief Get daylight saving time offset, seconds east of UTC
+   *
+   * @return int32_t offset seconds
+   */
+  inline int32_t getDstOffset() const { return dstOffset; }
+  /**
+   * @brief Get zone abbreviation, like "CET" or "CEST"
+   *
+   * @param isdst daylight saving time name if true
+   * @return const char* zone abbreviation
+   */
+  inline const char* getName(const bool isdst = false) const {
+    return isdst && dst ? dstName : stdName;
+  }
+  /**
+   * @brief Get offset from UTC at the given instant, the DST transitions of
+   * that year are computed once and cached.
+   *
+   * @param utc timestamp in seconds since 1970
+   * @param isdst output daylight saving time flag, may be nullptr
+   * @return int32_t offset seconds east of UTC
+   */
+  int32_t offsetAt(const time_t utc, int8_t* isdst = nullptr) const;
+  /**
+   * @brief Same as offsetAt() but never writes the cache, safe to call from
+   * several tasks on a shared rule. Call offsetAt() once before sharing to
+   * prime the cache, other years are computed on the stack.
+   *
+   * @param utc timestamp in seconds since 1970
+   * @param isdst output daylight saving time flag, may be nullptr
+   * @return int32_t offset seconds east of UTC
+   */
+  int32_t sharedOffsetAt(const time_t utc, int8_t* isdst = nullptr) const;
+  /**
+   * @brief Check the cached year is over at the given instant, prime a
+   * shared rule again with offsetAt() so sharedOffsetAt() stays fast
+   *
+   * @param utc timestamp in seconds since 1970
+   * @return true if the zone has DST and utc is after the cached year
+   */
+  inline bool isCacheExpired(const time_t utc) const {
+    return dst && (int64_t)utc >= yearEnd;
+  }
+  /**
+   * @brief Offset at the given instant and the span it holds for, so a
+   * sorted batch resolves the offset once per DST segment. Uses the cache
+   * like offsetAt().
+   *
+   * @param utc timestamp in seconds since 1970
+   * @param begin output first second of the span, in UTC
+   * @param end output end of the span, exclusive, in UTC
+   * @param isdst output daylight saving time flag, may be nullptr
+   * @return int32_t offset seconds east of UTC
+   */
+  int32_t offsetSpan(const time_t utc, int64_t* begin, int64_t* end,
+                     int8_t* isdst = nullptr) const;
+  /**
+   * @brief Compute DST transition instants of a year, in UTC
+   *
+   * @param year calendar year
+   * @param start output DST start instant
+   * @param end output DST end instant
+   */
+  void transitions(const int32_t year, int64_t* start, int64_t* end) const;
+
+ private:
+  const char* source;
+  int32_t stdOffset;
+  int32_t dstOffset;
+  TimeZoneDstRule startRule;
+  TimeZoneDstRule endRule;
+  char stdName[NAME_SIZE];
+  char dstName[NAME_SIZE];
+  bool dst;
+  bool valid;
+  // transition cache, [yearBegin, yearEnd) in UTC of the cached year
+  mutable int64_t yearBegin;
+  mutable int64_t yearEnd;
+  mutable int64_t dstStart;
+  mutable int64_t dstEnd;
+
+  void reset();
+  int32_t yearAt(const int64_t utc) const;
+  void updateCache(const int64_t utc) const;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include <Arduino.h>
+#include <ClockDrift.h>
+#include <unity.h>
+
+static const int64_t T_BASE_US = 1669680000LL * 1000000;  // 2022-11-29
+static const int64_t HOUR_US = 3600LL * 1000000;
+
+// synthetic trace: the local clock runs slow by ppm, samples carry noise
+struct DriftTrace {
+  double ppm;
+  int64_t noiseUs;
+  uint32_t seed;
+
+  int64_t utcAt(const int64_t monoUs) const {
+    return T_BASE_US + monoUs + (int64_t)((double)monoUs * ppm * 1e-6);
+  }
+  int64_t sample(const int64_t monoUs) {
+    seed = seed * 1103515245UL + 12345UL;
+    const int64_t noise =
+        noiseUs == 0 ? 0 : (int64_t)((seed >> 8) % (2 * noiseUs + 1)) - noiseUs;
+    return utcAt(monoUs) + noise;
+  }
+};
+
+void test_model_mapping() {
+  ClockModel m = {1000, T_BASE_US, 0, 0, true};
+  TEST_ASSERT_TRUE(m.utcAt(1000) == T_BASE_US);
+  TEST_ASSERT_TRUE(m.utcAt(2000) == T_BASE_US + 1000);
+  m.freq = 100e-6;
+  TEST_ASSERT_TRUE(m.utcAt(1000 + 1000000) == T_BASE_US + 1000000 + 100);
+  // 1 ms slew at 500 ppm takes 2 seconds
+  m.freq = 0;
+  m.slewUs = 1000;
+  TEST_ASSERT_TRUE(m.utcAt(1000) == T_BASE_US + 1000);
+  TEST_ASSERT_TRUE(m.utcAt(1000 + 1000000) == T_BASE_US + 1000000 + 500);
+  TEST_ASSERT_TRUE(m.utcAt(1000 + 3000000) == T_BASE_US + 3000000);
+  m.slewUs = -1000;
+  TEST_ASSERT_TRUE(m.utcAt(1000 + 1000000) == T_BASE_US + 1000000 - 500);
+  TEST_ASSERT_TRUE(m.utcAt(1000 + 3000000) == T_BASE_US + 3000000);
+}
+
+static void checkTrace(const double ppm) {
+  DriftTrace trace = {ppm, 1000, 42};
+  ClockDrift drift;
+  int64_t mono = 5 * 1000000;
+  for (int i = 0; i < 12; i++) {
+    drift.addSample(mono, trace.sample(mono));
+    mono += HOUR_US;
+  }
+  TEST_ASSERT_EQUAL(ClockDrift::MAX_SAMPLES, drift.getCount());
+  TEST_ASSERT_FLOAT_WITHIN(0.5, ppm, drift.getPpm());
+  TEST_ASSERT_TRUE(drift.getRmsResidual() <= 1000);
+  for (size_t i = 0; i < drift.getCount(); i++) {
+    TEST_ASSERT_INT_WITHIN(1500, 0, (int32_t)drift.getResidual(i));
+  }
+  // one hour after the last sample, the slew is long done
+  const int64_t ahead = mono;
+  TEST_ASSERT_INT_WITHIN(
+      3000, 0, (int32_t)(drift.getModel().utcAt(ahead) - trace.utcAt(ahead)));
+}
+
+void test_constant_drift() {
+  // ~3.5 seconds per day
+  checkTrace(40);
+  checkTrace(-40);
+  checkTrace(-150);
+  checkTrace(0);
+}
+
+void test_drift_clamped() {
+  DriftTrace trace = {2000, 0, 1};
+  ClockDrift drift;
+  drift.addSample(1000000, trace.sample(1000000));
+  drift.addSample(1000000 + 60000000, trace.sample(1000000 + 60000000));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 500, drift.getPpm());
+}
+
+void test_slew_monotonic() {
+  DriftTrace trace = {0, 0, 1};
+  ClockDrift drift;
+  TEST_ASSERT_TRUE(drift.addSample(0, trace.utcAt(0)));
+  const int64_t mono = HOUR_US;
+  const ClockModel before = drift.getModel();
+  // reference 50 ms ahead, slewed rather than stepped
+  TEST_ASSERT_FALSE(drift.addSample(mono, trace.utcAt(mono) + 50000));
+  const ClockModel& after = drift.getModel();
+  TEST_ASSERT_TRUE(after.utcAt(mono) == before.utcAt(mono));
+  int64_t last = after.utcAt(mono);
+  for (int64_t t = mono; t < mono + 200 * 1000000LL; t += 10000) {
+    const int64_t now = after.utcAt(t);
+    TEST_ASSERT_TRUE(now > last || t == mono);
+    last = now;
+  }
+  // converged to the fitted line after 50 ms / 500 ppm = 100 seconds
+  const int64_t later = mono + 150 * 1000000LL;
+  const int64_t fitted = after.utcUs + (later - mono) +
+                         (int64_t)((double)(later - mono) * after.freq);
+  TEST_ASSERT_TRUE(after.utcAt(later) == fitted);
+}
+
+void test_step_and_reset() {
+  ClockDrift drift;
+  TEST_ASSERT_FALSE(drift.getModel().valid);
+  TEST_ASSERT_TRUE(drift.addSample(0, T_BASE_US));
+  TEST_ASSERT_TRUE(drift.getModel().valid);
+  // 300 ms off is stepped
+  TEST_ASSERT_TRUE(drift.addSample(HOUR_US, T_BASE_US + HOUR_US + 300000));
+  TEST_ASSERT_EQUAL(2, drift.getCount());
+  TEST_ASSERT_TRUE(drift.getModel().utcAt(HOUR_US) ==
+                   T_BASE_US + HOUR_US + 300000);
+  // far off the fitted line, the clock was set elsewhere
+  TEST_ASSERT_TRUE(drift.addSample(2 * HOUR_US, T_BASE_US + 10 * HOUR_US));
+  TEST_ASSERT_EQUAL(1, drift.getCount());
+  // monotonic time went back, device rebooted
+  drift.addSample(3 * HOUR_US, T_BASE_US + 11 * HOUR_US);
+  TEST_ASSERT_EQUAL(2, drift.getCount());
+  drift.addSample(1000, T_BASE_US + 12 * HOUR_US);
+  TEST_ASSERT_EQUAL(1, drift.getCount());
+  drift.reset();
+  TEST_ASSERT_EQUAL(0, drift.getCount());
+  TEST_ASSERT_FALSE(drift.getModel().valid);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_model_mapping);
+  RUN_TEST(test_constant_drift);
+  RUN_TEST(test_drift_clamped);
+  RUN_TEST(test_slew_monotonic);
+  RUN_TEST(test_step_and_reset);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,99 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <DateTimeCivil.h>
+#include <unity.h>
+
+// 2106-02-07, last day of the unsigned 32 bit range
+static const int32_t LAST_DAY = 49709;
+
+void test_every_day_matches_gmtime() {
+  for (int32_t days = 0; days <= LAST_DAY; days++) {
+    // vary the time of day so hours/minutes/seconds are covered too
+    time_t ts = (time_t)days * 86400 + (days * 7919L) % 86400;
+    struct tm t;
+    gmtime_r(&ts, &t);
+    auto f = DateTimeFields::fromTime(ts);
+    TEST_ASSERT_EQUAL(t.tm_year + 1900, f.year);
+    TEST_ASSERT_EQUAL(t.tm_mon, f.month);
+    TEST_ASSERT_EQUAL(t.tm_mday, f.mday);
+    TEST_ASSERT_EQUAL(t.tm_yday, f.yday);
+    TEST_ASSERT_EQUAL(t.tm_wday, f.wday);
+    TEST_ASSERT_EQUAL(t.tm_hour, f.hour);
+    TEST_ASSERT_EQUAL(t.tm_min, f.minute);
+    TEST_ASSERT_EQUAL(t.tm_sec, f.second);
+    TEST_ASSERT_EQUAL(days, DateTimeCivil::daysFromCivil(
+                                t.tm_year + 1900, t.tm_mon + 1, t.tm_mday));
+  }
+}
+
+void test_civil_round_trip() {
+  for (int32_t days = -800000; days <= 800000; days += 37) {
+    CivilDate d = DateTimeCivil::civilFromDays(days);
+    TEST_ASSERT_EQUAL(days, DateTimeCivil::daysFromCivil(d.year, d.month,
+                                                         d.day));
+  }
+}
+
+void test_known_dates() {
+  CivilDate d = DateTimeCivil::civilFromDays(0);
+  TEST_ASSERT_EQUAL(1970, d.year);
+  TEST_ASSERT_EQUAL(1, d.month);
+  TEST_ASSERT_EQUAL(1, d.day);
+  TEST_ASSERT_EQUAL(4, DateTimeCivil::weekDayFromDays(0));
+  // 2000-02-29 leap day
+  TEST_ASSERT_EQUAL(11016, DateTimeCivil::daysFromCivil(2000, 2, 29));
+  TEST_ASSERT_TRUE(DateTimeCivil::isLeapYear(2000));
+  TEST_ASSERT_FALSE(DateTimeCivil::isLeapYear(2100));
+  // 1969-12-31 23:59:59
+  auto f = DateTimeFields::fromTime(-1);
+  TEST_ASSERT_EQUAL(1969, f.year);
+  TEST_ASSERT_EQUAL(11, f.month);
+  TEST_ASSERT_EQUAL(31, f.mday);
+  TEST_ASSERT_EQUAL(23, f.hour);
+  TEST_ASSERT_EQUAL(59, f.second);
+  TEST_ASSERT_EQUAL(3, f.wday);
+  TEST_ASSERT_EQUAL(364, f.yday);
+}
+
+void test_offset_fields() {
+  // 2019-11-29 15:29:55 UTC at +08:00
+  auto f = DateTimeFields::fromTime(1575041395, 8 * 3600);
+  TEST_ASSERT_EQUAL(23, f.hour);
+  TEST_ASSERT_EQUAL(8 * 3600, f.offset);
+  f = DateTimeFields::fromTime(1575041395, 10 * 3600);
+  TEST_ASSERT_EQUAL(30, f.mday);
+  TEST_ASSERT_EQUAL(1, f.hour);
+  TEST_ASSERT_EQUAL(6, f.wday);
+}
+
+void test_format_utc() {
+  setenv("TZ", "CST-8", 1);
+  tzset();
+  auto p = DateTimeParts::from(1575041395, "CST-8");
+  TEST_ASSERT_EQUAL_STRING("Fri, 29 Nov 2019 15:29:55 GMT",
+                           p.formatUTC(DateFormatter::HTTP).c_str());
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T15:29:55+0000",
+                           p.formatUTC(DateFormatter::ISO8601).c_str());
+  TEST_ASSERT_EQUAL_STRING("333 15h",
+                           p.formatUTC("%j %Hh").c_str());
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_every_day_matches_gmtime);
+  RUN_TEST(test_civil_round_trip);
+  RUN_TEST(test_known_dates);
+  RUN_TEST(test_offset_fields);
+  RUN_TEST(test_format_utc);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,112 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <unity.h>
+
+// 2019-11-29 00:00:00 UTC
+static const time_t T_BASE = 1574985600;
+
+static void useTimeZone(const char* tz) {
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+static const char* TZ_CET = "CET-1CEST,M3.5.0,M10.5.0/3";
+
+void test_fields_match_localtime() {
+  useTimeZone(TZ_CET);
+  // step 7h13m over ~3 years, crossing several DST transitions
+  for (time_t ts = T_BASE; ts < T_BASE + 3 * 366 * 86400L; ts += 25980) {
+    struct tm t;
+    localtime_r(&ts, &t);
+    auto p = DateTimeParts::from(ts, TZ_CET);
+    TEST_ASSERT_EQUAL(t.tm_year + 1900, p.getYear());
+    TEST_ASSERT_EQUAL(t.tm_mon, p.getMonth());
+    TEST_ASSERT_EQUAL(t.tm_yday, p.getYearDay());
+    TEST_ASSERT_EQUAL(t.tm_mday, p.getMonthDay());
+    TEST_ASSERT_EQUAL(t.tm_wday, p.getWeekDay());
+    TEST_ASSERT_EQUAL(t.tm_hour, p.getHours());
+    TEST_ASSERT_EQUAL(t.tm_min, p.getMinutes());
+    TEST_ASSERT_EQUAL(t.tm_sec, p.getSeconds());
+    TEST_ASSERT_EQUAL(t.tm_isdst > 0 ? 7200 : 3600, p.getOffset());
+  }
+}
+
+void test_format_uses_cached_fields() {
+  useTimeZone("CST-8");
+  auto p = DateTimeParts::from(T_BASE, "CST-8");
+  // changing global TZ after from() must not change the cached result
+  useTimeZone("UTC0");
+  TEST_ASSERT_EQUAL(8, p.getHours());
+  TEST_ASSERT_EQUAL(8 * 3600, p.getOffset());
+  TEST_ASSERT_EQUAL_STRING("2019-11-29 08:00:00",
+                           p.format(DateFormatter::SIMPLE).c_str());
+  TEST_ASSERT_EQUAL_STRING("20191129_080000",
+                           p.format(DateFormatter::COMPAT).c_str());
+}
+
+void test_utc_parts() {
+  useTimeZone("UTC0");
+  auto p = DateTimeParts::from(T_BASE);
+  TEST_ASSERT_EQUAL(2019, p.getYear());
+  TEST_ASSERT_EQUAL(10, p.getMonth());
+  TEST_ASSERT_EQUAL(29, p.getMonthDay());
+  TEST_ASSERT_EQUAL(5, p.getWeekDay());
+  TEST_ASSERT_EQUAL(332, p.getYearDay());
+  TEST_ASSERT_EQUAL(0, p.getOffset());
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T00:00:00+0000", p.toString().c_str());
+}
+
+void test_sub_second_parts() {
+  auto p = DateTimeParts::fromUs((int64_t)T_BASE * 1000000 + 123456, TZ_CET);
+  TEST_ASSERT_EQUAL(T_BASE, p.getTime());
+  TEST_ASSERT_EQUAL(1, p.getHours());
+  TEST_ASSERT_EQUAL(123, p.getMilliseconds());
+  TEST_ASSERT_EQUAL(123456, p.getMicroseconds());
+  TEST_ASSERT_TRUE(p.getTimeMs() == (int64_t)T_BASE * 1000 + 123);
+  TEST_ASSERT_TRUE(p.getTimeUs() == (int64_t)T_BASE * 1000000 + 123456);
+  // floored before 1970
+  auto q = DateTimeParts::fromUs(-1, "UTC0");
+  TEST_ASSERT_EQUAL(-1, q.getTime());
+  TEST_ASSERT_EQUAL(1969, q.getYear());
+  TEST_ASSERT_EQUAL(59, q.getSeconds());
+  TEST_ASSERT_EQUAL(999999, q.getMicroseconds());
+}
+
+void test_now_us() {
+  DateTimeClass d(0, "UTC0");
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  const int64_t sys = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+  int64_t last = d.nowUs();
+  if (tv.tv_sec > DateTimeClass::SECS_START_POINT) {
+    TEST_ASSERT_TRUE(last - sys >= 0 && last - sys < 10000);
+  }
+  for (int i = 0; i < 1000; i++) {
+    const int64_t now = d.nowUs();
+    TEST_ASSERT_TRUE(now >= last);
+    last = now;
+  }
+  TEST_ASSERT_TRUE(d.nowMs() - last / 1000 < 10);
+  auto p = d.getParts();
+  TEST_ASSERT_TRUE(p.getTimeUs() - last >= 0 && p.getTimeUs() - last < 10000);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fields_match_localtime);
+  RUN_TEST(test_format_uses_cached_fields);
+  RUN_TEST(test_utc_parts);
+  RUN_TEST(test_sub_second_parts);
+  RUN_TEST(test_now_us);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,148 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <DateTimeFormat.h>
+#include <DateTimePattern.h>
+#include <FixedZone.h>
+#include <unity.h>
+
+// 2019-11-29 15:29:55 UTC
+static const time_t T_BASE = 1575041395;
+
+constexpr char LOG_PATTERN[] = "%Y-%m-%d %H:%M:%S.%L %z";
+constexpr char ZONE_PATTERN[] = "%H:%M %z %Z";
+
+typedef FixedZone<8 * 3600> ZoneCST;
+typedef FixedZone<-(3 * 3600 + 30 * 60)> ZoneNST;
+typedef FixedZone<5 * 3600 + 45 * 60> ZoneNPT;
+
+static_assert(ZoneCST::OFFSET_SECS == 28800, "offset");
+static_assert(ZoneNST::OFFSET_TEXT[0] == '-', "constexpr %z");
+
+static void assertSameFields(const DateTimeParts& a, const DateTimeParts& b) {
+  TEST_ASSERT_EQUAL(a.getTime(), b.getTime());
+  TEST_ASSERT_EQUAL(a.getOffset(), b.getOffset());
+  TEST_ASSERT_EQUAL(a.getYear(), b.getYear());
+  TEST_ASSERT_EQUAL(a.getYearDay(), b.getYearDay());
+  TEST_ASSERT_EQUAL(a.getMonth(), b.getMonth());
+  TEST_ASSERT_EQUAL(a.getMonthDay(), b.getMonthDay());
+  TEST_ASSERT_EQUAL(a.getWeekDay(), b.getWeekDay());
+  TEST_ASSERT_EQUAL(a.getHours(), b.getHours());
+  TEST_ASSERT_EQUAL(a.getMinutes(), b.getMinutes());
+  TEST_ASSERT_EQUAL(a.getSeconds(), b.getSeconds());
+  TEST_ASSERT_EQUAL(a.getMicroseconds(), b.getMicroseconds());
+}
+
+void test_offset_text() {
+  TEST_ASSERT_EQUAL_STRING("+0800", ZoneCST::OFFSET_TEXT);
+  TEST_ASSERT_EQUAL_STRING("<+0800>-08:00", ZoneCST::TIME_ZONE);
+  TEST_ASSERT_EQUAL_STRING("-0330", ZoneNST::OFFSET_TEXT);
+  TEST_ASSERT_EQUAL_STRING("<-0330>+03:30", ZoneNST::TIME_ZONE);
+  TEST_ASSERT_EQUAL_STRING("+0545", ZoneNPT::OFFSET_TEXT);
+  TEST_ASSERT_EQUAL_STRING("+0000", FixedUTC::OFFSET_TEXT);
+  TEST_ASSERT_EQUAL_STRING("-1200", FixedZone<-12 * 3600>::OFFSET_TEXT);
+  TEST_ASSERT_EQUAL_STRING("+1400", FixedZone<14 * 3600>::OFFSET_TEXT);
+  int8_t isdst = 1;
+  TEST_ASSERT_EQUAL(28800, ZoneCST::offsetAt(T_BASE, &isdst));
+  TEST_ASSERT_EQUAL(0, isdst);
+}
+
+void test_parts_match_rule() {
+  const TimeZoneRule cst(ZoneCST::TIME_ZONE);
+  const TimeZoneRule nst(ZoneNST::TIME_ZONE);
+  TEST_ASSERT_TRUE(cst.isValid());
+  TEST_ASSERT_TRUE(nst.isValid());
+  // both sides of 1970, 32-bit time_t on older cores
+  for (int64_t ts = -2147483000LL; ts < 2147483000LL; ts += 7777777) {
+    assertSameFields(DateTimeParts::from((time_t)ts, ZoneCST()),
+                     DateTimeParts::from((time_t)ts, cst));
+    assertSameFields(DateTimeParts::from((time_t)ts, ZoneNST()),
+                     DateTimeParts::from((time_t)ts, nst));
+  }
+  const int64_t us = (int64_t)T_BASE * 1000000 + 123456;
+  const TimeZoneRule npt(ZoneNPT::TIME_ZONE);
+  assertSameFields(DateTimeParts::fromUs(us, ZoneNPT()),
+                   DateTimeParts::fromUs(us, npt));
+  const DateTimeParts p = DateTimeParts::from(T_BASE, ZoneCST());
+  TEST_ASSERT_EQUAL_STRING(ZoneCST::TIME_ZONE, p.getTimeZone());
+}
+
+void test_format_fixed_zone() {
+  char buf[40];
+  TEST_ASSERT_EQUAL(24, DateFormatter::formatTo<FormatISO8601>(
+                            buf, sizeof(buf), T_BASE, ZoneCST()));
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T23:29:55+0800", buf);
+  TEST_ASSERT_TRUE(DateFormatter::format<FormatISO8601>(T_BASE, ZoneNST()) ==
+                   "2019-11-29T11:59:55-0330");
+  TEST_ASSERT_TRUE(DateFormatter::format<CompiledFormat<LOG_PATTERN>>(
+                       T_BASE, ZoneNPT()) == "2019-11-29 21:14:55.000 +0545");
+  // runtime format strings go through the parts
+  TEST_ASSERT_TRUE(DateFormatter::format(DateFormatter::SIMPLE, T_BASE,
+                                         ZoneCST()) == "2019-11-29 23:29:55");
+  TEST_ASSERT_EQUAL(24, DateFormatter::formatTo(buf, sizeof(buf), "%FT%T%z",
+                                                T_BASE, ZoneNST()));
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T11:59:55-0330", buf);
+  // %z and %Z of the zone, not of the libc TZ
+  setenv("TZ", "UTC0", 1);
+  tzset();
+  DateFormatter::formatTo(buf, sizeof(buf), "%R %z %Z", T_BASE, ZoneNPT());
+  TEST_ASSERT_EQUAL_STRING("21:14 +0545 +0545", buf);
+  DateFormatter::formatTo<CompiledFormat<ZONE_PATTERN>>(buf, sizeof(buf),
+                                                        T_BASE, ZoneCST());
+  TEST_ASSERT_EQUAL_STRING("23:29 +0800 +0800", buf);
+  char records[2 * 24];
+  const time_t stamps[] = {T_BASE, T_BASE + 60};
+  DateFormatter::formatBatch(stamps, 2, records, 24, "%R %z %Z", ZoneNST());
+  TEST_ASSERT_EQUAL_STRING("11:59 -0330 -0330", records);
+  TEST_ASSERT_EQUAL_STRING("12:00 -0330 -0330", records + 24);
+  // does not fit
+  TEST_ASSERT_EQUAL(0, DateFormatter::formatTo<FormatISO8601>(buf, 10, T_BASE,
+                                                              ZoneCST()));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+void test_format_matches_rule() {
+  const TimeZoneRule nst(ZoneNST::TIME_ZONE);
+  char fixed[40];
+  char rule[40];
+  for (time_t ts = 0; ts < 2000000000; ts += 86413 * 97) {
+    DateFormatter::formatTo<FormatISO8601>(fixed, sizeof(fixed), ts,
+                                           ZoneNST());
+    DateTimeParts::from(ts, nst).formatTo<FormatISO8601>(rule, sizeof(rule));
+    TEST_ASSERT_EQUAL_STRING(rule, fixed);
+  }
+}
+
+void test_runtime_zone_coexists() {
+  DateTimeClass dt(DateTimeClass::TIME_ZERO, "UTC0");
+  TEST_ASSERT_EQUAL(0, dt.getParts().getOffset());
+  // the same zone set at runtime from the fixed zone string
+  TEST_ASSERT_TRUE(dt.setTimeZone(ZoneCST::TIME_ZONE));
+  TEST_ASSERT_EQUAL_STRING(ZoneCST::TIME_ZONE, dt.getTimeZone());
+  const DateTimeParts p = dt.getParts();
+  TEST_ASSERT_TRUE(p.format<FormatISO8601>() ==
+                   DateFormatter::format<FormatISO8601>(p.getTime(),
+                                                        ZoneCST()));
+  // the fixed zone does not touch the runtime zone
+  DateFormatter::format<FormatISO8601>(p.getTime(), ZoneNST());
+  TEST_ASSERT_EQUAL(28800, dt.getParts().getOffset());
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_offset_text);
+  RUN_TEST(test_parts_match_rule);
+  RUN_TEST(test_format_fixed_zone);
+  RUN_TEST(test_format_matches_rule);
+  RUN_TEST(test_runtime_zone_coexists);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
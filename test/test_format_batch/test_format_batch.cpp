@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <DateTimeFormat.h>
+#include <DateTimePattern.h>
+#include <unity.h>
+
+// 2024-01-01 00:00:00 UTC
+static const time_t T_2024 = 1704067200;
+static const char* TZ_CET = "CET-1CEST,M3.5.0,M10.5.0/3";
+static const char* TZ_SYDNEY = "AEST-10AEDT,M10.1.0,M4.1.0/3";
+static const size_t COUNT = 500;
+static const size_t STRIDE = 32;
+
+constexpr char LOG_PATTERN[] = "%d.%m.%Y %H:%M:%S %z";
+
+static time_t stamps[COUNT];
+static DateTimeFields fields[COUNT];
+static char records[COUNT * STRIDE];
+
+static void assertFields(const DateTimeFields& e, const DateTimeFields& a) {
+  TEST_ASSERT_EQUAL(e.offset, a.offset);
+  TEST_ASSERT_EQUAL(e.year, a.year);
+  TEST_ASSERT_EQUAL(e.yday, a.yday);
+  TEST_ASSERT_EQUAL(e.month, a.month);
+  TEST_ASSERT_EQUAL(e.mday, a.mday);
+  TEST_ASSERT_EQUAL(e.hour, a.hour);
+  TEST_ASSERT_EQUAL(e.minute, a.minute);
+  TEST_ASSERT_EQUAL(e.second, a.second);
+  TEST_ASSERT_EQUAL(e.wday, a.wday);
+  TEST_ASSERT_EQUAL(e.isdst, a.isdst);
+  TEST_ASSERT_EQUAL(e.usec, a.usec);
+}
+
+static void assertBatchMatches(const char* tz) {
+  const TimeZoneRule zone(tz);
+  DateFormatter::toPartsBatch(stamps, COUNT, fields, zone);
+  for (size_t i = 0; i < COUNT; i++) {
+    assertFields(DateTimeParts::from(stamps[i], zone)._fields, fields[i]);
+  }
+}
+
+static void fillSorted(const time_t start, const uint32_t step) {
+  for (size_t i = 0; i < COUNT; i++) {
+    stamps[i] = start + (time_t)(i * step);
+  }
+}
+
+void test_sorted_batch() {
+  // every 17 hours for ~1 year, all DST transitions and month ends
+  fillSorted(T_2024 - 3600, 17 * 3600 + 13);
+  assertBatchMatches(TZ_CET);
+  assertBatchMatches(TZ_SYDNEY);
+  assertBatchMatches("UTC0");
+  // one sample a second around the CET spring gap
+  fillSorted(1711846740 - 250, 1);
+  assertBatchMatches(TZ_CET);
+}
+
+void test_day_rollover() {
+  // hourly over new year and the leap day, both sides of 1970
+  const time_t starts[] = {T_2024 - 40 * 3600, 1709078400, 951696000,
+                           -86400 * 3};
+  for (const time_t start : starts) {
+    fillSorted(start, 3600);
+    DateTimeFields::fromTimeBatch(stamps, COUNT, fields, 5 * 3600 + 1800);
+    for (size_t i = 0; i < COUNT; i++) {
+      assertFields(DateTimeFields::fromTime(stamps[i], 5 * 3600 + 1800),
+                   fields[i]);
+    }
+  }
+}
+
+void test_unsorted_batch() {
+  uint32_t seed = 12345;
+  for (size_t i = 0; i < COUNT; i++) {
+    seed = seed * 1103515245 + 12345;
+    // random order, repeats and day jumps within ~6 years
+    stamps[i] = T_2024 - 94608000 + (time_t)(seed % 189216000);
+  }
+  assertBatchMatches(TZ_CET);
+  assertBatchMatches(TZ_SYDNEY);
+  stamps[COUNT / 2] = stamps[COUNT / 2 - 1];
+  assertBatchMatches(TZ_CET);
+}
+
+void test_format_batch() {
+  fillSorted(T_2024 - 3600, 7 * 3600 + 59);
+  const TimeZoneRule zone(TZ_CET);
+  const char* formats[] = {DateFormatter::ISO8601, DateFormatter::HTTP,
+                           DateFormatter::SIMPLE, "%d.%m.%Y %H:%M"};
+  char expected[STRIDE];
+  for (const char* fmt : formats) {
+    memset(records, 'x', sizeof(records));
+    TEST_ASSERT_EQUAL(COUNT, DateFormatter::formatBatch(
+                                 stamps, COUNT, records, STRIDE, fmt, TZ_CET));
+    for (size_t i = 0; i < COUNT; i++) {
+      DateTimeParts::from(stamps[i], zone).formatTo(expected, STRIDE, fmt);
+      TEST_ASSERT_EQUAL_STRING(expected, records + i * STRIDE);
+    }
+  }
+  // records that do not fit are empty
+  TEST_ASSERT_EQUAL(0, DateFormatter::formatBatch(stamps, 4, records, 8,
+                                                  DateFormatter::SIMPLE,
+                                                  zone));
+  TEST_ASSERT_EQUAL_STRING("", records + 3 * 8);
+  TEST_ASSERT_EQUAL(4, DateFormatter::formatBatch(stamps, 4, records, 9,
+                                                  DateFormatter::TIME_ONLY,
+                                                  zone));
+}
+
+void test_format_batch_compiled() {
+  fillSorted(T_2024 - 3600, 7 * 3600 + 59);
+  const TimeZoneRule zone(TZ_SYDNEY);
+  char expected[STRIDE];
+  TEST_ASSERT_EQUAL(COUNT, DateFormatter::formatBatch<FormatISO8601>(
+                               stamps, COUNT, records, STRIDE, zone));
+  for (size_t i = 0; i < COUNT; i++) {
+    DateTimeParts::from(stamps[i], zone).formatTo<FormatISO8601>(expected,
+                                                                 STRIDE);
+    TEST_ASSERT_EQUAL_STRING(expected, records + i * STRIDE);
+  }
+  typedef FixedZone<-(3 * 3600 + 30 * 60)> ZoneNST;
+  TEST_ASSERT_EQUAL(COUNT,
+                    DateFormatter::formatBatch<CompiledFormat<LOG_PATTERN>>(
+                        stamps, COUNT, records, STRIDE, ZoneNST()));
+  for (size_t i = 0; i < COUNT; i++) {
+    DateFormatter::formatTo<CompiledFormat<LOG_PATTERN>>(
+        expected, STRIDE, stamps[i], ZoneNST());
+    TEST_ASSERT_EQUAL_STRING(expected, records + i * STRIDE);
+  }
+  // runtime format string in a fixed zone
+  TEST_ASSERT_EQUAL(COUNT, DateFormatter::formatBatch(stamps, COUNT, records,
+                                                      STRIDE, "%F %R",
+                                                      ZoneNST()));
+  for (size_t i = 0; i < COUNT; i++) {
+    DateTimeParts::from(stamps[i], ZoneNST()).formatTo(expected, STRIDE,
+                                                       "%F %R");
+    TEST_ASSERT_EQUAL_STRING(expected, records + i * STRIDE);
+  }
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_sorted_batch);
+  RUN_TEST(test_day_rollover);
+  RUN_TEST(test_unsorted_batch);
+  RUN_TEST(test_format_batch);
+  RUN_TEST(test_format_batch_compiled);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,310 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <DateTimeFormat.h>
+#include <DateTimePattern.h>
+#include <unity.h>
+
+// 2019-11-29 15:29:55 UTC
+static const time_t T_BASE = 1575041395;
+
+struct BufferPrint : public Print {
+  char buf[128];
+  size_t len = 0;
+  size_t write(uint8_t c) override {
+    if (len + 1 >= sizeof(buf)) return 0;
+    buf[len++] = (char)c;
+    buf[len] = '\0';
+    return 1;
+  }
+};
+
+static void useTimeZone(const char* tz) {
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+void test_format_to_buffer() {
+  useTimeZone("CST-8");
+  auto p = DateTimeParts::from(T_BASE, "CST-8");
+  char buf[32];
+  TEST_ASSERT_EQUAL(19, p.formatTo(buf, sizeof(buf), DateFormatter::SIMPLE));
+  TEST_ASSERT_EQUAL_STRING("2019-11-29 23:29:55", buf);
+  TEST_ASSERT_EQUAL(29, p.formatUTCTo(buf, sizeof(buf), DateFormatter::HTTP));
+  TEST_ASSERT_EQUAL_STRING("Fri, 29 Nov 2019 15:29:55 GMT", buf);
+  TEST_ASSERT_EQUAL(10, DateFormatter::formatTo(buf, sizeof(buf),
+                                                DateFormatter::DATE_ONLY,
+                                                T_BASE, "CST-8"));
+  TEST_ASSERT_EQUAL_STRING("2019-11-29", buf);
+}
+
+void test_format_to_small_buffer() {
+  useTimeZone("UTC0");
+  auto p = DateTimeParts::from(T_BASE);
+  char buf[8] = "xxxxxxx";
+  TEST_ASSERT_EQUAL(0, p.formatTo(buf, sizeof(buf), DateFormatter::SIMPLE));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+  TEST_ASSERT_EQUAL(0, p.formatTo(buf, 0, DateFormatter::SIMPLE));
+}
+
+void test_format_to_print() {
+  useTimeZone("UTC0");
+  auto p = DateTimeParts::from(T_BASE);
+  BufferPrint out;
+  TEST_ASSERT_EQUAL(8, p.formatTo(out, DateFormatter::TIME_ONLY));
+  TEST_ASSERT_EQUAL(1, out.print(" "));
+  TEST_ASSERT_EQUAL(15, p.formatUTCTo(out, DateFormatter::COMPAT));
+  TEST_ASSERT_EQUAL_STRING("15:29:55 20191129_152955", out.buf);
+}
+
+void test_format_to_string() {
+  useTimeZone("UTC0");
+  auto p = DateTimeParts::from(T_BASE);
+  String s("[");
+  TEST_ASSERT_EQUAL(24, p.formatTo(s, DateFormatter::ISO8601));
+  s += "]";
+  TEST_ASSERT_EQUAL_STRING("[2019-11-29T15:29:55+0000]", s.c_str());
+  TEST_ASSERT_EQUAL_STRING(p.format(DateFormatter::SIMPLE).c_str(),
+                           "2019-11-29 15:29:55");
+}
+
+#ifdef ARDUINO
+static const time_t EQ_STEP = 86400L * 7 + 3671;
+#else
+static const time_t EQ_STEP = 3671;
+#endif
+
+static const char* const BUILTIN_FORMATS[] = {
+    DateFormatter::ISO8601, DateFormatter::HTTP,      DateFormatter::SIMPLE,
+    DateFormatter::COMPAT,  DateFormatter::DATE_ONLY, DateFormatter::TIME_ONLY};
+
+static void assertBuiltinMatchesStrftime(const char* tz) {
+  useTimeZone(tz);
+  char fast[64];
+  char slow[64];
+  // 1970-01-01 to 2106-02-07, the whole unsigned 32 bit range
+  for (time_t ts = 0; ts < 0xFFFFFFFFLL - EQ_STEP; ts += EQ_STEP) {
+    struct tm t;
+    localtime_r(&ts, &t);
+    auto p = DateTimeParts::from(ts, tz);
+    for (const char* fmt : BUILTIN_FORMATS) {
+      size_t n = strftime(slow, sizeof(slow), fmt, &t);
+      TEST_ASSERT_EQUAL(n, p.formatTo(fast, sizeof(fast), fmt));
+      TEST_ASSERT_EQUAL_STRING(slow, fast);
+    }
+    gmtime_r(&ts, &t);
+    strftime(slow, sizeof(slow), DateFormatter::ISO8601, &t);
+    p.formatUTCTo(fast, sizeof(fast), DateFormatter::ISO8601);
+    TEST_ASSERT_EQUAL_STRING(slow, fast);
+  }
+}
+
+void test_builtin_equivalence_utc() { assertBuiltinMatchesStrftime("UTC0"); }
+
+void test_builtin_equivalence_dst() {
+  assertBuiltinMatchesStrftime("CET-1CEST,M3.5.0,M10.5.0/3");
+}
+
+void test_builtin_equivalence_negative_offset() {
+  assertBuiltinMatchesStrftime("NST3:30NDT,M3.2.0,M11.1.0");
+}
+
+void test_builtin_tags() {
+  useTimeZone("CST-8");
+  auto p = DateTimeParts::from(T_BASE, "CST-8");
+  char buf[32];
+  TEST_ASSERT_EQUAL(24, p.formatTo<FormatISO8601>(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T23:29:55+0800", buf);
+  TEST_ASSERT_EQUAL(29, p.formatTo<FormatHTTP>(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("Fri, 29 Nov 2019 23:29:55 GMT", buf);
+  TEST_ASSERT_EQUAL(15, DateFormatter::formatTo<FormatCompat>(
+                            buf, sizeof(buf), T_BASE, "CST-8"));
+  TEST_ASSERT_EQUAL_STRING("20191129_232955", buf);
+  // exact fit needs room for the terminator, like strftime
+  TEST_ASSERT_EQUAL(0, p.formatTo<FormatTimeOnly>(buf, 8));
+  TEST_ASSERT_EQUAL(8, p.formatTo<FormatTimeOnly>(buf, 9));
+  TEST_ASSERT_EQUAL_STRING("23:29:55", buf);
+}
+
+void test_builtin_fast_path() {
+  const DateTimeFields f = DateTimeFields::fromTime(T_BASE, 8 * 3600);
+  const char* formats[] = {DateFormatter::ISO8601,   DateFormatter::ISO8601_MS,
+                           DateFormatter::HTTP,      DateFormatter::SIMPLE,
+                           DateFormatter::COMPAT,    DateFormatter::DATE_ONLY,
+                           DateFormatter::TIME_ONLY};
+  char buf[40];
+  // every constant takes the precompiled writer, not strftime
+  for (const char* fmt : formats) {
+    TEST_ASSERT_TRUE(DateTimeFormat::formatBuiltin(buf, sizeof(buf), fmt, f) >
+                     0);
+  }
+  // a copy with the same content is a runtime string
+  char copy[16];
+  strcpy(copy, DateFormatter::ISO8601);
+  TEST_ASSERT_EQUAL(-1, DateTimeFormat::formatBuiltin(buf, sizeof(buf), copy,
+                                                      f));
+}
+
+constexpr char ZONE_PATTERN[] = "%H:%M %z %Z";
+
+void test_zone_from_fields() {
+  // the libc zone is another one, newlib strftime would print it
+  useTimeZone("UTC0");
+  const char* tz = "CET-1CEST,M3.5.0,M10.5.0/3";
+  char buf[40];
+  auto winter = DateTimeParts::from(T_BASE, tz);
+  TEST_ASSERT_EQUAL(15, winter.formatTo(buf, sizeof(buf), "%H:%M %z %Z"));
+  TEST_ASSERT_EQUAL_STRING("16:29 +0100 CET", buf);
+  auto summer = DateTimeParts::from(T_BASE - 150 * 86400, tz);
+  summer.formatTo(buf, sizeof(buf), "%FT%T%z (%Z) %L");
+  TEST_ASSERT_EQUAL_STRING("2019-07-02T17:29:55+0200 (CEST) 000", buf);
+  summer.formatTo<CompiledFormat<ZONE_PATTERN>>(buf, sizeof(buf));
+  // compiled patterns have only the fields, %Z is the libc name
+  TEST_ASSERT_EQUAL_STRING("17:29 +0200 UTC", buf);
+  winter.formatUTCTo(buf, sizeof(buf), "%R %z %Z");
+  TEST_ASSERT_EQUAL_STRING("15:29 +0000 GMT", buf);
+  // %% stays a literal
+  winter.formatTo(buf, sizeof(buf), "%%z %z");
+  TEST_ASSERT_EQUAL_STRING("%z +0100", buf);
+}
+
+constexpr char FILE_PATTERN[] = "%Y%m%d-%H";
+constexpr char TOPIC_PATTERN[] = "sensors/%Y/%j/%H%M";
+constexpr char FULL_PATTERN[] =
+    "%Y %y %C %m %d %e %j %H %I %M %S %w %u %a %b %h %p %F %T %R %D %r %z "
+    "%% %n %t";
+constexpr char FALLBACK_PATTERN[] = "%A, %B %d %Y (%Z) %U/%W %s";
+
+template <typename F>
+static void assertCompiledMatchesStrftime(const char* tz) {
+  useTimeZone(tz);
+  char fast[160];
+  char slow[160];
+  for (time_t ts = 0; ts < 0xFFFFFFFFLL - EQ_STEP; ts += EQ_STEP * 13) {
+    struct tm t;
+    localtime_r(&ts, &t);
+    auto p = DateTimeParts::from(ts, tz);
+    size_t n = strftime(slow, sizeof(slow), F::pattern(), &t);
+    TEST_ASSERT_EQUAL(n, p.formatTo<F>(fast, sizeof(fast)));
+    TEST_ASSERT_EQUAL_STRING(slow, fast);
+    TEST_ASSERT_TRUE(n <= F::LENGTH);
+  }
+}
+
+void test_compiled_pattern_length() {
+  TEST_ASSERT_EQUAL(5, CompiledFormat<FILE_PATTERN>::COUNT);
+  TEST_ASSERT_EQUAL(11, CompiledFormat<FILE_PATTERN>::LENGTH);
+  TEST_ASSERT_EQUAL(21, CompiledFormat<TOPIC_PATTERN>::LENGTH);
+}
+
+void test_compiled_pattern() {
+  useTimeZone("CST-8");
+  auto p = DateTimeParts::from(T_BASE, "CST-8");
+  char buf[32];
+  TEST_ASSERT_EQUAL(11,
+                    p.formatTo<CompiledFormat<FILE_PATTERN>>(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("20191129-23", buf);
+  TEST_ASSERT_EQUAL_STRING(
+      "sensors/2019/333/2329",
+      DateFormatter::format<CompiledFormat<TOPIC_PATTERN>>(T_BASE, "CST-8")
+          .c_str());
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T23:29:55+0800",
+                           p.format<FormatISO8601>().c_str());
+  // too small buffer behaves like strftime
+  TEST_ASSERT_EQUAL(0, p.formatTo<CompiledFormat<FILE_PATTERN>>(buf, 11));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+void test_compiled_equivalence() {
+  assertCompiledMatchesStrftime<CompiledFormat<FULL_PATTERN>>("UTC0");
+  assertCompiledMatchesStrftime<CompiledFormat<FULL_PATTERN>>(
+      "NST3:30NDT,M3.2.0,M11.1.0");
+  assertCompiledMatchesStrftime<CompiledFormat<FALLBACK_PATTERN>>(
+      "CET-1CEST,M3.5.0,M10.5.0/3");
+}
+
+constexpr char MILLIS_PATTERN[] = "%H:%M:%S.%L";
+constexpr char MICROS_PATTERN[] = "%T.%f%z";
+
+void test_fractional_seconds() {
+  // 2019-11-29 23:29:55.012345 +0800
+  auto p = DateTimeParts::fromUs((int64_t)T_BASE * 1000000 + 12345, "CST-8");
+  char buf[40];
+  TEST_ASSERT_EQUAL(28,
+                    p.formatTo(buf, sizeof(buf), DateFormatter::ISO8601_MS));
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T23:29:55.012+0800", buf);
+  TEST_ASSERT_EQUAL(28, p.formatTo<FormatISO8601Ms>(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T23:29:55.012+0800", buf);
+  // same pattern in RAM takes the strftime path
+  char fmt[32];
+  strcpy(fmt, DateFormatter::ISO8601_MS);
+  p.formatTo(buf, sizeof(buf), fmt);
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T23:29:55.012+0800", buf);
+  p.formatTo(buf, sizeof(buf), "%S.%f %%f %%%L");
+  TEST_ASSERT_EQUAL_STRING("55.012345 %f %012", buf);
+  p.formatUTCTo(buf, sizeof(buf), "%T.%f");
+  TEST_ASSERT_EQUAL_STRING("15:29:55.012345", buf);
+  TEST_ASSERT_EQUAL(7, CompiledFormat<MILLIS_PATTERN>::COUNT);
+  TEST_ASSERT_EQUAL(12, CompiledFormat<MILLIS_PATTERN>::LENGTH);
+  TEST_ASSERT_EQUAL_STRING("23:29:55.012",
+                           p.format<CompiledFormat<MILLIS_PATTERN>>().c_str());
+  TEST_ASSERT_EQUAL_STRING("23:29:55.012345+0800",
+                           p.format<CompiledFormat<MICROS_PATTERN>>().c_str());
+  // whole seconds print zeros
+  auto q = DateTimeParts::from(T_BASE, "CST-8");
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T23:29:55.000+0800",
+                           q.format(DateFormatter::ISO8601_MS).c_str());
+}
+
+void test_long_pattern() {
+  auto p = DateTimeParts::fromUs((int64_t)T_BASE * 1000000 + 12345, "CST-8");
+  char buf[128];
+  // longer than the expansion buffer, formatted in pieces
+  const char* fmt =
+      "event logged at local time %Y-%m-%d %H:%M:%S.%L %z %Z, "
+      "%f us into the second %%L";
+  TEST_ASSERT_EQUAL(90, p.formatTo(buf, sizeof(buf), fmt));
+  TEST_ASSERT_EQUAL_STRING(
+      "event logged at local time 2019-11-29 23:29:55.012 +0800 CST, "
+      "012345 us into the second %L",
+      buf);
+  TEST_ASSERT_EQUAL_STRING("event logged at local time 2019-11-29 "
+                           "23:29:55.012 +0800",
+                           p.format("event logged at local time %Y-%m-%d "
+                                    "%H:%M:%S.%L %z")
+                               .c_str());
+  // only pieces of it fit
+  TEST_ASSERT_EQUAL(0, p.formatTo(buf, 80, fmt));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+  TEST_ASSERT_EQUAL(0, p.formatTo(buf, 90, fmt));
+  TEST_ASSERT_EQUAL(90, p.formatTo(buf, 91, fmt));
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_format_to_buffer);
+  RUN_TEST(test_format_to_small_buffer);
+  RUN_TEST(test_format_to_print);
+  RUN_TEST(test_format_to_string);
+  RUN_TEST(test_builtin_equivalence_utc);
+  RUN_TEST(test_builtin_equivalence_dst);
+  RUN_TEST(test_builtin_equivalence_negative_offset);
+  RUN_TEST(test_builtin_tags);
+  RUN_TEST(test_builtin_fast_path);
+  RUN_TEST(test_zone_from_fields);
+  RUN_TEST(test_compiled_pattern_length);
+  RUN_TEST(test_compiled_pattern);
+  RUN_TEST(test_compiled_equivalence);
+  RUN_TEST(test_fractional_seconds);
+  RUN_TEST(test_long_pattern);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,131 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <MonoClock.h>
+#include <TimeElapsed.h>
+#include <unity.h>
+
+static const uint64_t WRAP = 0x100000000ULL;
+
+void test_rollover_counter() {
+  RolloverCounter counter;
+  TEST_ASSERT_TRUE(counter.extend(0) == 0);
+  TEST_ASSERT_TRUE(counter.extend(1000) == 1000);
+  // five wraps of a 32-bit millis(), in steps of ~9 days
+  const uint64_t step = 0x30000000ULL;
+  uint64_t t = 1000;
+  for (int i = 0; i < 30; i++) {
+    t += step;
+    TEST_ASSERT_TRUE(counter.extend((uint32_t)t) == t);
+  }
+  TEST_ASSERT_TRUE(t > 5 * WRAP);
+  TEST_ASSERT_TRUE(counter.get() == t);
+  // right before and after a wrap
+  t = 6 * WRAP - 1;
+  TEST_ASSERT_TRUE(counter.extend((uint32_t)t) == t);
+  TEST_ASSERT_TRUE(counter.extend(0) == 6 * WRAP);
+  TEST_ASSERT_TRUE(counter.extend(5) == 6 * WRAP + 5);
+}
+
+void test_rollover_stale_read() {
+  RolloverCounter counter;
+  counter.extend(0xFFFFFF00UL);
+  counter.extend(0x10);
+  const uint64_t now = WRAP + 0x10;
+  TEST_ASSERT_TRUE(counter.get() == now);
+  // raw values read before the wrap by a preempted task
+  TEST_ASSERT_TRUE(counter.extend(0xFFFFFFF0UL) == WRAP - 0x10);
+  TEST_ASSERT_TRUE(counter.extend(0x08) == WRAP + 0x08);
+  // the stored value never moves back
+  TEST_ASSERT_TRUE(counter.get() == now);
+  TEST_ASSERT_TRUE(counter.extend(0x20) == WRAP + 0x20);
+}
+
+void test_millis64() {
+  const uint64_t a = MonoClock::millis64();
+  delay(20);
+  const uint64_t b = MonoClock::millis64();
+  TEST_ASSERT_TRUE(b >= a + 19 && b < a + 200);
+  // same clock as millis(), in the low 32 bits
+  const uint32_t diff = (uint32_t)MonoClock::millis64() - (uint32_t)millis();
+  TEST_ASSERT_TRUE(diff <= 2 || diff >= 0xFFFFFFFEUL);
+  TEST_ASSERT_TRUE(MonoClock::seconds() == MonoClock::millis64() / 1000);
+}
+
+void test_time_elapsed() {
+  TimeElapsed e;
+  TEST_ASSERT_TRUE(e.elapsed() < 10);
+  e = 5000;
+  TEST_ASSERT_TRUE(e >= 5000UL && e < 5100UL);
+  e += 1000;
+  TEST_ASSERT_TRUE(e.elapsed() >= 6000 && e.elapsed() < 6100);
+  e -= 6000;
+  TEST_ASSERT_TRUE((unsigned long)e < 100UL);
+  const TimeElapsed later = e + 2000UL;
+  TEST_ASSERT_TRUE(later.elapsed() >= 2000 && later.elapsed() < 2100);
+  const TimeElapsed earlier = later - 1500;
+  TEST_ASSERT_TRUE(earlier.elapsed() >= 500 && earlier.elapsed() < 600);
+}
+
+void test_boot_time() {
+  const time_t now = 1669680000;  // 2022-11-29
+  DateTimeClass d(now);
+  TEST_ASSERT_TRUE(d.isTimeValid());
+  TEST_ASSERT_TRUE(d.getBootTime() == now - (time_t)MonoClock::seconds());
+  d.setTime(now + 100);
+  TEST_ASSERT_TRUE(d.getBootTime() == now + 100 - (time_t)MonoClock::seconds());
+}
+
+#ifndef ARDUINO
+static uint64_t simUs = 0;
+static uint64_t simClock() { return simUs; }
+
+void test_native_clock() {
+  // a frozen clock only moves by delay() and advance()
+  NativeClock::freeze();
+  TEST_ASSERT_TRUE(NativeClock::isFrozen());
+  const uint64_t start = MonoClock::micros64();
+  TimeElapsed e;
+  delay(24UL * 3600 * 1000);
+  TEST_ASSERT_TRUE(MonoClock::micros64() - start == 24ULL * 3600 * 1000000);
+  TEST_ASSERT_TRUE(e.elapsed() == 24UL * 3600 * 1000);
+  NativeClock::advance(1500);
+  TEST_ASSERT_TRUE(MonoClock::micros64() - start ==
+                   24ULL * 3600 * 1000000 + 1500);
+  // the host clock continues from there
+  NativeClock::release();
+  TEST_ASSERT_FALSE(NativeClock::isFrozen());
+  const uint64_t released = MonoClock::micros64();
+  TEST_ASSERT_TRUE(released >= start + 24ULL * 3600 * 1000000 + 1500);
+  // a simulated clock, never behind the time already read
+  NativeClock::setSource(simClock);
+  const uint64_t base = MonoClock::micros64();
+  TEST_ASSERT_TRUE(base >= released);
+  simUs += 250;
+  TEST_ASSERT_TRUE(MonoClock::micros64() == base + 250);
+  NativeClock::setSource(nullptr);
+  TEST_ASSERT_TRUE(MonoClock::micros64() >= base + 250);
+}
+#endif
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_rollover_counter);
+  RUN_TEST(test_rollover_stale_read);
+  RUN_TEST(test_millis64);
+  RUN_TEST(test_time_elapsed);
+  RUN_TEST(test_boot_time);
+#ifndef ARDUINO
+  RUN_TEST(test_native_clock);
+#endif
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
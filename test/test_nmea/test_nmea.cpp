@@ -0,0 +1,285 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <NMEA.h>
+#include <unity.h>
+
+// recorded from a u-blox M8 receiver, one epoch with RMC and ZDA
+static const char LOG[] =
+    "$GNRMC,083559.00,A,4717.11437,N,00833.91522,E,0.004,77.52,091202,,,A*49"
+    "\r\n"
+    "$GNVTG,77.52,T,,M,0.004,N,0.008,K,A*18\r\n"
+    "$GNGGA,083559.00,4717.11437,N,00833.91522,E,1,08,1.01,499.6,M,48.0,M,,*46"
+    "\r\n"
+    "$GNGSA,A,3,10,23,29,07,08,09,18,26,,,,,1.94,1.01,1.66*11\r\n"
+    "$GPGSV,3,1,10,23,38,230,44,29,71,156,47,07,29,116,41,08,09,081,36*7F\r\n"
+    "$GLGSV,1,1,02,65,41,060,30,72,15,318,27*6A\r\n"
+    "$GNGLL,4717.11437,N,00833.91522,E,083559.00,A,A*75\r\n"
+    "$GNZDA,083559.00,09,12,2002,00,00*70\r\n";
+// 2002-12-09 08:35:59 UTC
+static const int64_t LOG_SECS = 1039422959LL;
+
+static const char RMC_2024[] =
+    "$GPRMC,235959.500,A,4807.038,N,01131.000,E,022.4,084.4,311224,003.1,W*75"
+    "\r\n";
+static const char ZDA_2025[] = "$GPZDA,000000.25,01,01,2025,00,00*64\r\n";
+static const char RMC_2025[] =
+    "$GPRMC,000000.00,A,4807.038,N,01131.000,E,022.4,084.4,010125,003.1,W*41"
+    "\r\n";
+// 2024-12-31 23:59:59 UTC
+static const int64_t NEW_YEAR_SECS = 1735689599LL;
+
+static int feedAll(NMEAParser& p, const char* s) {
+  int found = 0;
+  for (; *s; s++) {
+    found += p.feed(*s) ? 1 : 0;
+  }
+  return found;
+}
+
+static int feedAll(GPSTimeSource& gps, const char* s) {
+  int found = 0;
+  for (; *s; s++) {
+    found += gps.feed(*s) ? 1 : 0;
+  }
+  return found;
+}
+
+// ZDA of 2025-01-01 at a second of the day, with the checksum
+static const char* zdaAt(const uint32_t secs, const uint8_t centis = 0) {
+  static char line[48];
+  const int len =
+      snprintf(line, sizeof(line), "$GPZDA,%02u%02u%02u.%02u,01,01,2025,00,00",
+               (unsigned)(secs / 3600), (unsigned)(secs / 60 % 60),
+               (unsigned)(secs % 60), (unsigned)centis);
+  uint8_t sum = 0;
+  for (int i = 1; i < len; i++) {
+    sum ^= (uint8_t)line[i];
+  }
+  snprintf(line + len, sizeof(line) - len, "*%02X\r\n", sum);
+  return line;
+}
+
+static int64_t zdaUs(const uint32_t secs) {
+  return (NEW_YEAR_SECS + 1 + secs) * 1000000;
+}
+
+void test_parse() {
+  NMEAParser p;
+  TEST_ASSERT_EQUAL(NMEAParser::NONE, p.getSentence());
+  TEST_ASSERT_EQUAL(2, feedAll(p, LOG));
+  TEST_ASSERT_EQUAL(8, p.getCount());
+  TEST_ASSERT_EQUAL(0, p.getErrors());
+  TEST_ASSERT_EQUAL(NMEAParser::ZDA, p.getSentence());
+  TEST_ASSERT_TRUE(p.getTimeUs() == LOG_SECS * 1000000);
+  // fractions of a second, across the new year
+  TEST_ASSERT_EQUAL(1, feedAll(p, RMC_2024));
+  TEST_ASSERT_EQUAL(NMEAParser::RMC, p.getSentence());
+  TEST_ASSERT_TRUE(p.getTimeUs() == NEW_YEAR_SECS * 1000000 + 500000);
+  TEST_ASSERT_EQUAL(1, feedAll(p, ZDA_2025));
+  TEST_ASSERT_TRUE(p.getTimeUs() == (NEW_YEAR_SECS + 1) * 1000000 + 250000);
+  // the time is ready at the last checksum digit, before the line end
+  const char* rmc = RMC_2024;
+  bool done = false;
+  while (*rmc != '\r') {
+    TEST_ASSERT_FALSE(done);
+    done = p.feed(*rmc++);
+  }
+  TEST_ASSERT_TRUE(done);
+}
+
+void test_reject() {
+  NMEAParser p;
+  // void fix
+  TEST_ASSERT_EQUAL(0,
+                    feedAll(p, "$GPRMC,120000.00,V,,,,,,,290224,,,N*71\r\n"));
+  // no time yet
+  TEST_ASSERT_EQUAL(0, feedAll(p, "$GPZDA,,,,,,*48\r\n"));
+  TEST_ASSERT_EQUAL(2, p.getCount());
+  // bad checksum, lowercase hex is fine
+  TEST_ASSERT_EQUAL(0, feedAll(p, "$GPZDA,000000.25,01,01,2025,00,00*65\r\n"));
+  TEST_ASSERT_EQUAL(1, p.getErrors());
+  TEST_ASSERT_EQUAL(1, feedAll(p, "$GPZDA,000000.25,01,01,2025,00,00*64\r\n"));
+  // no checksum
+  TEST_ASSERT_EQUAL(0, feedAll(p, "$GPZDA,000000.25,01,01,2025,00,00\r\n"));
+  TEST_ASSERT_EQUAL(2, p.getErrors());
+  // cut off by the next sentence
+  TEST_ASSERT_EQUAL(1, feedAll(p, "$GPZDA,0000$GPZDA,000000.25,01,01,2025,00,00"
+                                  "*64\r\n"));
+  // too long
+  char longLine[120];
+  memset(longLine, '1', sizeof(longLine));
+  memcpy(longLine, "$GPZDA,", 7);
+  longLine[sizeof(longLine) - 1] = '\0';
+  TEST_ASSERT_EQUAL(0, feedAll(p, longLine));
+  TEST_ASSERT_EQUAL(3, p.getErrors());
+  TEST_ASSERT_TRUE(p.getTimeUs() == (NEW_YEAR_SECS + 1) * 1000000 + 250000);
+}
+
+static uint32_t rng = 0x2545F491UL;
+static uint32_t nextRandom() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+void test_fuzz() {
+  NMEAParser p;
+  // random bytes with a sprinkle of $ and commas
+  for (int i = 0; i < 200000; i++) {
+    const uint32_t r = nextRandom();
+    const uint32_t kind = r & 0x300;
+    const char c = kind == 0 ? '$' : kind == 0x100 ? ',' : (char)r;
+    p.feed(c);
+  }
+  // any single bit flip of a valid sentence is dropped or still correct
+  const size_t len = strlen(RMC_2024);
+  for (size_t i = 0; i < len - 2; i++) {
+    for (int bit = 0; bit < 8; bit++) {
+      char line[sizeof(RMC_2024)];
+      memcpy(line, RMC_2024, sizeof(line));
+      line[i] ^= (char)(1 << bit);
+      NMEAParser q;
+      if (feedAll(q, line) > 0) {
+        TEST_ASSERT_TRUE(q.getTimeUs() == NEW_YEAR_SECS * 1000000 + 500000);
+      }
+    }
+  }
+  // recovers after garbage
+  TEST_ASSERT_EQUAL(2, feedAll(p, LOG));
+  TEST_ASSERT_TRUE(p.getTimeUs() == LOG_SECS * 1000000);
+}
+
+void test_pps() {
+  GPSTimeSource gps;
+  int64_t utcUs;
+  TEST_ASSERT_FALSE(gps.read(&utcUs));
+  // no pulse, the time the sentence arrived
+  TEST_ASSERT_EQUAL(1, feedAll(gps, ZDA_2025));
+  TEST_ASSERT_FALSE(gps.isAligned());
+  TEST_ASSERT_TRUE(gps.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs >= zdaUs(0) + 250000 && utcUs < zdaUs(0) + 260000);
+  // pulse 300 ms before the sentence of the next second
+  gps.pulseAt(micros() - 300000);
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(1)));
+  TEST_ASSERT_TRUE(gps.isAligned());
+  TEST_ASSERT_TRUE(gps.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs >= zdaUs(1) + 300000 && utcUs < zdaUs(1) + 310000);
+  // another sentence of the same second keeps the edge
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(1)));
+  TEST_ASSERT_TRUE(gps.isAligned());
+  // the pulse is used once
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(2)));
+  TEST_ASSERT_FALSE(gps.isAligned());
+  // a pulse older than a second is not the edge of this sentence
+  gps.pulseAt(micros() - 1200000);
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(3)));
+  TEST_ASSERT_FALSE(gps.isAligned());
+  // not a whole second
+  gps.pulseAt(micros() - 300000);
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(4, 50)));
+  TEST_ASSERT_FALSE(gps.isAligned());
+  gps.onPulse();
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(5)));
+  TEST_ASSERT_TRUE(gps.isAligned());
+  // a jump in time does not match the pulses counted
+  gps.onPulse();
+  TEST_ASSERT_EQUAL(2, feedAll(gps, LOG));
+  TEST_ASSERT_FALSE(gps.isAligned());
+}
+
+void test_pps_late_sentence() {
+  GPSTimeSource gps;
+  int64_t utcUs;
+  // the first sentence has nothing to count the pulses from
+  gps.pulseAt(micros() - 300000);
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(10)));
+  TEST_ASSERT_FALSE(gps.isAligned());
+  // loop() was blocked, the sentence of second 11 is read after pulse 12
+  gps.pulseAt(micros() - 1500000);
+  gps.pulseAt(micros() - 500000);
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(11)));
+  TEST_ASSERT_TRUE(gps.isAligned());
+  TEST_ASSERT_TRUE(gps.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs >= zdaUs(11) + 1500000 &&
+                   utcUs < zdaUs(11) + 1510000);
+  // the sentence of second 12 takes the pulse left over
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(12)));
+  TEST_ASSERT_TRUE(gps.isAligned());
+  TEST_ASSERT_TRUE(gps.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs >= zdaUs(12) + 500000 && utcUs < zdaUs(12) + 510000);
+  // two pulses ahead, no edge can be trusted
+  gps.pulseAt(micros() - 2400000);
+  gps.pulseAt(micros() - 1400000);
+  gps.pulseAt(micros() - 400000);
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(13)));
+  TEST_ASSERT_FALSE(gps.isAligned());
+  // a pulse missed
+  gps.pulseAt(micros() - 400000);
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(15)));
+  TEST_ASSERT_FALSE(gps.isAligned());
+  // counting again from there
+  gps.pulseAt(micros() - 200000);
+  TEST_ASSERT_EQUAL(1, feedAll(gps, zdaAt(16)));
+  TEST_ASSERT_TRUE(gps.isAligned());
+}
+
+void test_sync_from() {
+  GPSTimeSource gps;
+  DateTimeClass d(0, "UTC0");
+  TEST_ASSERT_FALSE(d.syncFrom(gps));
+  // 2002 is before SECS_START_POINT
+  feedAll(gps, LOG);
+  TEST_ASSERT_FALSE(d.syncFrom(gps));
+  TEST_ASSERT_FALSE(d.isTimeValid());
+  feedAll(gps, zdaAt(0));
+  gps.pulseAt(micros() - 100000);
+  feedAll(gps, zdaAt(1));
+  TEST_ASSERT_TRUE(gps.isAligned());
+  TEST_ASSERT_TRUE(d.syncFrom(gps));
+  TEST_ASSERT_TRUE(d.isTimeValid());
+  TEST_ASSERT_EQUAL(1, d.getClockDrift().getCount());
+  const int64_t nowUs = d.nowUs();
+  TEST_ASSERT_TRUE(nowUs >= zdaUs(1) + 100000 && nowUs < zdaUs(1) + 110000);
+}
+
+void test_benchmark() {
+  NMEAParser p;
+  const size_t len = strlen(LOG);
+  const int rounds = 2000;
+  const uint32_t start = micros();
+  int found = 0;
+  for (int i = 0; i < rounds; i++) {
+    found += feedAll(p, LOG);
+  }
+  const uint32_t elapsed = micros() - start;
+  TEST_ASSERT_EQUAL(2 * rounds, found);
+  char msg[64];
+  snprintf(msg, sizeof(msg), "%.1f ns/byte",
+           elapsed * 1000.0 / ((double)len * rounds));
+  TEST_MESSAGE(msg);
+  // 115200 baud is 87 us per byte, keep far below
+  TEST_ASSERT_TRUE(elapsed / ((double)len * rounds) < 5);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse);
+  RUN_TEST(test_reject);
+  RUN_TEST(test_fuzz);
+  RUN_TEST(test_pps);
+  RUN_TEST(test_pps_late_sentence);
+  RUN_TEST(test_sync_from);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
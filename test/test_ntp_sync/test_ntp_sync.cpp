@@ -0,0 +1,165 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <NTPSync.h>
+#include <unity.h>
+
+static const time_t VALID = DateTimeClass::SECS_START_POINT;
+
+void test_idle() {
+  NTPSync sync;
+  TEST_ASSERT_EQUAL(NTPSync::IDLE, sync.getState());
+  TEST_ASSERT_EQUAL(NTPSync::IDLE, sync.poll(0, VALID + 1, VALID));
+  TEST_ASSERT_EQUAL(0, sync.getAttempts());
+  TEST_ASSERT_EQUAL(0, sync.nextCheckIn(0));
+}
+
+void test_synced_immediately() {
+  NTPSync sync;
+  sync.start(1000, 5000);
+  TEST_ASSERT_TRUE(sync.isSyncing());
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, sync.poll(1000, VALID, VALID));
+  TEST_ASSERT_EQUAL(1, sync.getAttempts());
+  TEST_ASSERT_EQUAL(0, sync.getElapsed());
+  TEST_ASSERT_EQUAL(VALID, sync.getTime());
+}
+
+void test_backoff() {
+  NTPSync sync;
+  unsigned long now = 1000;
+  sync.start(now, 100000);
+  // checks at +0, +50, +150, +300, +500, same as the old delay() loop
+  const unsigned long checks[] = {0, 50, 150, 300, 500};
+  for (size_t i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+    // not due yet, state unchanged and no check done
+    if (i > 0) {
+      TEST_ASSERT_EQUAL(NTPSync::SYNCING,
+                        sync.poll(1000 + checks[i] - 1, VALID, VALID));
+      TEST_ASSERT_EQUAL(1, sync.nextCheckIn(1000 + checks[i] - 1));
+    }
+    TEST_ASSERT_EQUAL(i, sync.getAttempts());
+    TEST_ASSERT_EQUAL(NTPSync::SYNCING, sync.poll(1000 + checks[i], 0, VALID));
+    TEST_ASSERT_EQUAL(i + 1, sync.getAttempts());
+  }
+  TEST_ASSERT_EQUAL(250, sync.nextCheckIn(1500));
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, sync.poll(1750, VALID + 10, VALID));
+  TEST_ASSERT_EQUAL(750, sync.getElapsed());
+  TEST_ASSERT_EQUAL(VALID + 10, sync.getTime());
+  // done, later polls do nothing
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, sync.poll(5000, 0, VALID));
+  TEST_ASSERT_EQUAL(6, sync.getAttempts());
+}
+
+void test_timeout() {
+  NTPSync sync;
+  sync.start(0, 1000);
+  unsigned long now = 0;
+  while (sync.poll(now, 0, VALID) == NTPSync::SYNCING) {
+    now += sync.nextCheckIn(now);
+    TEST_ASSERT_TRUE(now < 5000);
+  }
+  TEST_ASSERT_EQUAL(NTPSync::TIMEOUT, sync.getState());
+  // last check after 1050ms, like the blocking loop overshoots the timeout
+  TEST_ASSERT_EQUAL(1050, sync.getElapsed());
+  TEST_ASSERT_EQUAL(7, sync.getAttempts());
+  // restart
+  sync.start(now, 1000);
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, sync.poll(now, VALID, VALID));
+}
+
+void test_millis_rollover() {
+  NTPSync sync;
+  const unsigned long start = (unsigned long)-60;
+  sync.start(start, 1000);
+  TEST_ASSERT_EQUAL(NTPSync::SYNCING, sync.poll(start, 0, VALID));
+  TEST_ASSERT_EQUAL(50, sync.nextCheckIn(start));
+  TEST_ASSERT_EQUAL(NTPSync::SYNCING, sync.poll(start + 49, VALID, VALID));
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, sync.poll(start + 50, VALID, VALID));
+  TEST_ASSERT_EQUAL(50, sync.getElapsed());
+}
+
+void test_begin_async() {
+  DateTimeClass d;
+  int calls = 0;
+  bool result = false;
+  TEST_ASSERT_TRUE(d.beginAsync(
+      [&](bool synced) {
+        calls++;
+        result = synced;
+      },
+      500));
+  TEST_ASSERT_TRUE(d.isSyncing());
+  TEST_ASSERT_FALSE(d.beginAsync(nullptr, 500));
+  const unsigned long start = millis();
+  while (d.poll() == NTPSync::SYNCING) {
+    TEST_ASSERT_TRUE(millis() - start < 2000);
+    delay(1);
+  }
+  TEST_ASSERT_FALSE(d.isSyncing());
+  TEST_ASSERT_EQUAL(1, calls);
+  TEST_ASSERT_EQUAL(d.isTimeValid(), result);
+  d.poll();
+  TEST_ASSERT_EQUAL(1, calls);
+}
+
+void test_ntp_time() {
+  DateTimeClass d;
+  const bool valid = time(nullptr) >= VALID;
+  const unsigned long start = millis();
+  NTPResult r = d.ntpTime(500);
+  TEST_ASSERT_EQUAL(valid, r.isValid());
+  TEST_ASSERT_EQUAL_STRING(DateTimeClass::NTP_SERVER_1, r.server);
+  if (valid) {
+    // returns at the first check, not after the timeout
+    TEST_ASSERT_EQUAL(1, r.attempts);
+    TEST_ASSERT_TRUE(millis() - start < 50);
+    TEST_ASSERT_TRUE(r.time >= VALID);
+  } else {
+    TEST_ASSERT_TRUE(r.waitMs >= 500);
+  }
+}
+
+void test_ntp_time_async() {
+  DateTimeClass d;
+  int calls = 0;
+  NTPResult result = {};
+  TEST_ASSERT_TRUE(d.ntpTimeAsync(
+      [&](const NTPResult& r) {
+        calls++;
+        result = r;
+      },
+      500));
+  TEST_ASSERT_FALSE(d.beginAsync(nullptr, 500));
+  const unsigned long start = millis();
+  while (d.poll() == NTPSync::SYNCING) {
+    TEST_ASSERT_TRUE(millis() - start < 2000);
+    delay(1);
+  }
+  TEST_ASSERT_EQUAL(1, calls);
+  TEST_ASSERT_EQUAL(time(nullptr) >= VALID, result.isValid());
+  TEST_ASSERT_TRUE(result.attempts >= 1);
+  // ntpTimeAsync() not call setTime()
+  TEST_ASSERT_FALSE(d.isTimeValid());
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_idle);
+  RUN_TEST(test_synced_immediately);
+  RUN_TEST(test_backoff);
+  RUN_TEST(test_timeout);
+  RUN_TEST(test_millis_rollover);
+  RUN_TEST(test_begin_async);
+  RUN_TEST(test_ntp_time);
+  RUN_TEST(test_ntp_time_async);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,200 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <math.h>
+#include <unity.h>
+
+// needs the library built with -DESP_DATE_TIME_SIMULATED_CLOCK
+// pio test -e nativesim
+
+// 2024-06-01 00:00:00 UTC
+static const int64_t T0_US = 1717200000LL * 1000000;
+static const uint64_t SECOND_US = 1000000ULL;
+static const uint64_t DAY_US = 86400ULL * SECOND_US;
+
+static uint32_t chainedSyncs = 0;
+
+static int64_t errorUs(const DateTimeClass& d) {
+  return d.nowUs() - SimulatedClock::trueUs();
+}
+
+void test_boot_sync() {
+  SimulatedClock::reset(T0_US);
+  SimulatedClock::setSntpDelay(250);
+  DateTimeClass d(DateTimeClass::TIME_ZERO, "UTC0");
+  TEST_ASSERT_FALSE(d.isTimeValid());
+  // uptime since 1970 before the first sync
+  TEST_ASSERT_TRUE(SimulatedClock::time() == 0);
+  TEST_ASSERT_TRUE(d.begin());
+  TEST_ASSERT_EQUAL(1, SimulatedClock::getSntpCount());
+  // the blocking wait moved the clock, checks are at +0, +50, +150, +300
+  TEST_ASSERT_TRUE(SimulatedClock::trueUs() - T0_US == 300000);
+  TEST_ASSERT_TRUE(llabs(errorUs(d)) < 1000);
+}
+
+void test_chain_sync() {
+  SimulatedClock::reset(T0_US);
+  SimulatedClock::chainSync([]() { chainedSyncs++; });
+  chainedSyncs = 0;
+  DateTimeClass d(DateTimeClass::TIME_ZERO, "UTC0");
+  TEST_ASSERT_TRUE(d.begin());
+  TEST_ASSERT_TRUE(d.forceUpdate());
+  // the resync request, then the hourly update
+  SimulatedClock::advance(3601 * SECOND_US);
+  // the sketch callback still sees every sntp update
+  TEST_ASSERT_EQUAL(SimulatedClock::getSntpCount(), chainedSyncs);
+  TEST_ASSERT_EQUAL(3, chainedSyncs);
+  SimulatedClock::chainSync(nullptr);
+}
+
+void test_sntp_unreachable() {
+  SimulatedClock::reset(T0_US);
+  SimulatedClock::setSntpReachable(false);
+  DateTimeClass d(DateTimeClass::TIME_ZERO, "UTC0");
+  TEST_ASSERT_FALSE(d.begin(2000));
+  TEST_ASSERT_TRUE(SimulatedClock::trueUs() - T0_US >= 2000000);
+  TEST_ASSERT_EQUAL(0, SimulatedClock::getSntpCount());
+  SimulatedClock::setSntpReachable(true);
+  TEST_ASSERT_TRUE(d.beginAsync());
+  NTPSync::State state = d.poll();
+  for (int i = 0; i < 100 && state == NTPSync::SYNCING; i++) {
+    SimulatedClock::advance(10000);
+    state = d.poll();
+  }
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, state);
+  TEST_ASSERT_TRUE(llabs(errorUs(d)) < 1000);
+}
+
+void test_auto_sync_after_begin() {
+  SimulatedClock::reset(T0_US);
+  DateTimeClass d(DateTimeClass::TIME_ZERO, "UTC0");
+  // not synced yet, the first sync is due at once
+  d.setAutoSync(true);
+  TEST_ASSERT_TRUE(d.isSyncDue());
+  d.setAutoSync(false);
+  TEST_ASSERT_TRUE(d.begin());
+  d.setAutoSync(true);
+  // begin() synced, no second sync right after it
+  TEST_ASSERT_FALSE(d.isSyncDue());
+  d.poll();
+  TEST_ASSERT_FALSE(d.isSyncing());
+  TEST_ASSERT_TRUE(d.getScheduler().dueIn(SimulatedClock::millis()) >=
+                   SyncScheduler::MIN_INTERVAL_MS * 9 / 10);
+}
+
+void test_soak_drift() {
+  SimulatedClock::reset(T0_US);
+  // the local oscillator is 40 ppm fast, 3.5 seconds a day
+  SimulatedClock::setDriftPpm(40);
+  DateTimeClass d(DateTimeClass::TIME_ZERO, "UTC0");
+  TEST_ASSERT_TRUE(d.begin());
+  d.setAutoSync(true);
+  int64_t last = d.nowUs();
+  int64_t worstUs = 0;
+  // past the millis() wrap at 49.7 days
+  const int64_t endUs = SimulatedClock::trueUs() + 60 * (int64_t)DAY_US;
+  while (SimulatedClock::trueUs() < endUs) {
+    SimulatedClock::advance(d.isSyncing() ? 10000 : SECOND_US);
+    d.poll();
+    const int64_t now = d.nowUs();
+    TEST_ASSERT_TRUE(now >= last);
+    last = now;
+    if (d.getClockDrift().getCount() >= 3) {
+      const int64_t err = llabs(now - SimulatedClock::trueUs());
+      worstUs = err > worstUs ? err : worstUs;
+    }
+  }
+  // the model corrects the drift between the syncs
+  TEST_ASSERT_TRUE(fabs(d.getDriftPpm() + 40) < 1);
+  TEST_ASSERT_TRUE(worstUs < 10000);
+  TEST_ASSERT_EQUAL(ClockDrift::MAX_SAMPLES, d.getClockDrift().getCount());
+  char msg[80];
+  snprintf(msg, sizeof(msg), "drift %.3f ppm, worst error %ld us",
+           d.getDriftPpm(), (long)worstUs);
+  TEST_MESSAGE(msg);
+}
+
+void test_soak_core_sntp() {
+  SimulatedClock::reset(T0_US);
+  SimulatedClock::setDriftPpm(40);
+  DateTimeClass d(DateTimeClass::TIME_ZERO, "UTC0");
+  TEST_ASSERT_TRUE(d.begin());
+  // no auto sync, only the hourly core sntp updates
+  int64_t worstUs = 0;
+  const int64_t endUs = SimulatedClock::trueUs() + 7 * (int64_t)DAY_US;
+  while (SimulatedClock::trueUs() < endUs) {
+    SimulatedClock::advance(60 * SECOND_US);
+    d.poll();
+    if (d.getClockDrift().getCount() >= 3) {
+      const int64_t err = llabs(errorUs(d));
+      worstUs = err > worstUs ? err : worstUs;
+    }
+  }
+  TEST_ASSERT_TRUE(fabs(d.getDriftPpm() + 40) < 1);
+  TEST_ASSERT_TRUE(worstUs < 10000);
+  TEST_ASSERT_TRUE(llabs((int64_t)d.getTime() * 1000000 -
+                         SimulatedClock::trueUs()) < 1000000);
+  char msg[80];
+  snprintf(msg, sizeof(msg), "core sntp: drift %.3f ppm, worst error %ld us",
+           d.getDriftPpm(), (long)worstUs);
+  TEST_MESSAGE(msg);
+}
+
+void test_core_sntp_without_poll() {
+  SimulatedClock::reset(T0_US);
+  SimulatedClock::setDriftPpm(40);
+  DateTimeClass d(DateTimeClass::TIME_ZERO, "UTC0");
+  TEST_ASSERT_TRUE(d.begin());
+  // the readers follow the system clock the core sntp corrects
+  for (int i = 0; i < 2 * 24 * 60; i++) {
+    SimulatedClock::advance(60 * SECOND_US);
+    // at most an hour of 40 ppm since the last update
+    TEST_ASSERT_TRUE(llabs(errorUs(d)) < 150000);
+    TEST_ASSERT_TRUE(llabs(d.getParts().getTime() * 1000000LL -
+                           SimulatedClock::trueUs()) < 1000000);
+  }
+}
+
+void test_dst_change() {
+  // 2024-03-31 00:59:00 UTC, a minute before CET moves to CEST
+  SimulatedClock::reset(1711846740LL * 1000000);
+  DateTimeClass d(DateTimeClass::TIME_ZERO, "CET-1CEST,M3.5.0,M10.5.0/3");
+  TEST_ASSERT_TRUE(d.begin());
+  const DateTimeParts before = d.getParts();
+  TEST_ASSERT_EQUAL(3600, before.getOffset());
+  TEST_ASSERT_EQUAL(1, before.getHours());
+  TEST_ASSERT_EQUAL(59, before.getMinutes());
+  SimulatedClock::advance(60 * SECOND_US);
+  const DateTimeParts after = d.getParts();
+  TEST_ASSERT_EQUAL(7200, after.getOffset());
+  TEST_ASSERT_EQUAL(3, after.getHours());
+  TEST_ASSERT_EQUAL(0, after.getMinutes());
+  // and back in October, a week of polls at a time
+  while (d.getParts().getOffset() == 7200) {
+    SimulatedClock::advance(7 * DAY_US);
+    d.poll();
+  }
+  TEST_ASSERT_EQUAL(10, d.getParts().getMonth() + 1);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_sync);
+  RUN_TEST(test_chain_sync);
+  RUN_TEST(test_sntp_unreachable);
+  RUN_TEST(test_auto_sync_after_begin);
+  RUN_TEST(test_soak_drift);
+  RUN_TEST(test_soak_core_sntp);
+  RUN_TEST(test_core_sntp_without_poll);
+  RUN_TEST(test_dst_change);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
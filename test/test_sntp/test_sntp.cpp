@@ -0,0 +1,255 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <SNTP.h>
+#include <unity.h>
+
+#ifndef ARDUINO
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+void test_timestamp_conversion() {
+  // 2019-11-29 15:29:55.5 UTC
+  const int64_t us = 1575041395500000LL;
+  const uint64_t ntp = SNTPPacket::toNtp(us);
+  TEST_ASSERT_EQUAL_UINT32(1575041395UL + SNTPPacket::UNIX_OFFSET,
+                           (uint32_t)(ntp >> 32));
+  TEST_ASSERT_EQUAL_UINT32(0x80000000UL, (uint32_t)ntp);
+  TEST_ASSERT_TRUE(SNTPPacket::toUnixUs(ntp) == us);
+  TEST_ASSERT_TRUE(SNTPPacket::toUnixUs(SNTPPacket::toNtp(0)) == 0);
+  // era 1, after 2036-02-07 06:28:16 UTC
+  const int64_t era1 = (2085978496LL + 10) * 1000000 + 1;
+  TEST_ASSERT_EQUAL_UINT32(10, (uint32_t)(SNTPPacket::toNtp(era1) >> 32));
+  TEST_ASSERT_TRUE(SNTPPacket::toUnixUs(SNTPPacket::toNtp(era1)) == era1);
+  for (int64_t v = 0; v < 1000000; v += 997) {
+    const int64_t t = us + v;
+    TEST_ASSERT_TRUE(SNTPPacket::toUnixUs(SNTPPacket::toNtp(t)) == t);
+  }
+}
+
+void test_packet_encode_decode() {
+  uint8_t buf[SNTPPacket::SIZE];
+  const SNTPPacket req = SNTPPacket::request(1575041395500000LL);
+  req.encode(buf);
+  // LI 0, VN 4, mode 3
+  TEST_ASSERT_EQUAL_HEX8(0x23, buf[0]);
+  for (size_t i = 1; i < 40; i++) {
+    TEST_ASSERT_EQUAL_HEX8(0, buf[i]);
+  }
+  TEST_ASSERT_EQUAL_HEX8(0x80, buf[44]);
+  SNTPPacket res;
+  TEST_ASSERT_FALSE(res.decode(buf, SNTPPacket::SIZE - 1));
+  buf[0] = 0xE4;  // LI 3, VN 4, mode 4
+  buf[1] = 2;
+  buf[2] = 6;
+  buf[3] = 0xEC;  // -20
+  buf[12] = 'G';
+  buf[13] = 'P';
+  buf[14] = 'S';
+  TEST_ASSERT_TRUE(res.decode(buf, SNTPPacket::SIZE));
+  TEST_ASSERT_EQUAL(3, res.leap);
+  TEST_ASSERT_EQUAL(4, res.version);
+  TEST_ASSERT_EQUAL(4, res.mode);
+  TEST_ASSERT_EQUAL(2, res.stratum);
+  TEST_ASSERT_EQUAL(6, res.poll);
+  TEST_ASSERT_EQUAL(-20, res.precision);
+  TEST_ASSERT_EQUAL_HEX32(0x47505300UL, res.refId);
+  TEST_ASSERT_TRUE(res.txTime == req.txTime);
+  uint8_t out[SNTPPacket::SIZE];
+  res.encode(out);
+  for (size_t i = 0; i < SNTPPacket::SIZE; i++) {
+    TEST_ASSERT_EQUAL_HEX8(buf[i], out[i]);
+  }
+}
+
+#ifndef ARDUINO
+// local udp stand-in servers, served from receive() so no threads needed
+struct StandInServer {
+  const char* name;
+  int64_t offsetUs;
+  unsigned int delayMs;
+  uint8_t stratum;
+  int fd;
+  uint16_t port;
+};
+
+class LoopbackTransport : public SNTPTransport {
+ public:
+  LoopbackTransport(StandInServer* _servers, size_t _count)
+      : servers(_servers), count(_count) {
+    fd = openSocket(nullptr);
+    for (size_t i = 0; i < count; i++) {
+      servers[i].fd = openSocket(&servers[i].port);
+    }
+  }
+  ~LoopbackTransport() {
+    close(fd);
+    for (size_t i = 0; i < count; i++) {
+      close(servers[i].fd);
+    }
+  }
+  bool send(const char* host, const uint16_t, const uint8_t* data,
+            const size_t len) override {
+    // host names resolve to the stand-in server ports
+    for (size_t i = 0; i < count; i++) {
+      if (strcmp(host, servers[i].name) == 0) {
+        sockaddr_in addr = loopback(servers[i].port);
+        return sendto(fd, data, len, 0, (sockaddr*)&addr, sizeof(addr)) ==
+               (ssize_t)len;
+      }
+    }
+    return false;
+  }
+  int receive(uint8_t* buf, const size_t cap) override {
+    for (size_t i = 0; i < count; i++) {
+      serve(servers[i]);
+    }
+    const ssize_t n = recv(fd, buf, cap, 0);
+    return n > 0 ? (int)n : 0;
+  }
+
+ private:
+  StandInServer* servers;
+  size_t count;
+  int fd;
+
+  static sockaddr_in loopback(uint16_t port) {
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    return addr;
+  }
+  static int openSocket(uint16_t* port) {
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = loopback(0);
+    bind(s, (sockaddr*)&addr, sizeof(addr));
+    fcntl(s, F_SETFL, O_NONBLOCK);
+    if (port) {
+      socklen_t len = sizeof(addr);
+      getsockname(s, (sockaddr*)&addr, &len);
+      *port = ntohs(addr.sin_port);
+    }
+    return s;
+  }
+  static void serve(const StandInServer& server) {
+    uint8_t buf[SNTPPacket::SIZE];
+    sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+    const ssize_t n =
+        recvfrom(server.fd, buf, sizeof(buf), 0, (sockaddr*)&from, &fromLen);
+    if (n != (ssize_t)SNTPPacket::SIZE) {
+      return;
+    }
+    SNTPPacket req;
+    req.decode(buf, sizeof(buf));
+    // symmetric path delay
+    delay(server.delayMs / 2);
+    SNTPPacket res;
+    memset(&res, 0, sizeof(res));
+    res.version = 4;
+    res.mode = SNTPPacket::MODE_SERVER;
+    res.stratum = server.stratum;
+    res.origTime = req.txTime;
+    res.rxTime = SNTPPacket::toNtp(SNTPClient::localUs() + server.offsetUs);
+    res.refTime = res.rxTime;
+    res.txTime = SNTPPacket::toNtp(SNTPClient::localUs() + server.offsetUs);
+    res.encode(buf);
+    delay(server.delayMs / 2);
+    sendto(server.fd, buf, sizeof(buf), 0, (sockaddr*)&from, fromLen);
+  }
+};
+
+void test_client_offset_delay() {
+  StandInServer servers[] = {{"a.test", 1500000, 20, 2, -1, 0}};
+  LoopbackTransport transport(servers, 1);
+  SNTPClient client(transport);
+  SNTPSample sample;
+  TEST_ASSERT_TRUE(client.request("a.test", &sample, 500));
+  TEST_ASSERT_EQUAL_STRING("a.test", sample.server);
+  TEST_ASSERT_EQUAL(2, sample.stratum);
+  TEST_ASSERT_INT_WITHIN(5000, 1500000, (int32_t)sample.offsetUs);
+  TEST_ASSERT_INT_WITHIN(10000, 20000, (int32_t)sample.delayUs);
+  TEST_ASSERT_INT_WITHIN(
+      10000, 0, (int32_t)(sample.timeUs - SNTPClient::localUs() - 1500000));
+  // unknown host
+  TEST_ASSERT_FALSE(client.request("x.test", &sample, 100));
+}
+
+void test_client_rejects_bad_reply() {
+  // stratum 0 is kiss-o'-death
+  StandInServer servers[] = {{"kod.test", 0, 0, 0, -1, 0}};
+  LoopbackTransport transport(servers, 1);
+  SNTPClient client(transport);
+  SNTPSample sample;
+  TEST_ASSERT_FALSE(client.request("kod.test", &sample, 200));
+}
+
+void test_best_server() {
+  StandInServer servers[] = {
+      {"a.test", -250000, 40, 2, -1, 0},
+      {"b.test", -250000, 4, 1, -1, 0},
+      {"c.test", -250000, 16, 3, -1, 0},
+      {"d.test", 0, 0, 0, -1, 0},
+  };
+  LoopbackTransport transport(servers, 4);
+  SNTPClient client(transport);
+  const char* names[] = {"a.test", nullptr, "d.test", "c.test", "b.test"};
+  SNTPSample best;
+  TEST_ASSERT_EQUAL(4, client.query(names, 5, &best, 500));
+  TEST_ASSERT_EQUAL_STRING("b.test", best.server);
+  TEST_ASSERT_INT_WITHIN(3000, -250000, (int32_t)best.offsetUs);
+  const char* none[] = {"d.test", "x.test"};
+  TEST_ASSERT_EQUAL(-1, client.query(none, 2, &best, 100));
+}
+
+void test_sntp_update() {
+  StandInServer servers[] = {
+      {"a.test", 7200000000LL, 30, 2, -1, 0},
+      {"b.test", 7200000000LL, 6, 2, -1, 0},
+      {"c.test", 0, 0, 0, -1, 0},
+  };
+  LoopbackTransport transport(servers, 3);
+  DateTimeClass d;
+  d.setServer("a.test", "b.test", "c.test");
+  SNTPSample sample;
+  TEST_ASSERT_TRUE(d.sntpUpdate(transport, &sample, 500));
+  TEST_ASSERT_EQUAL_STRING("b.test", sample.server);
+  TEST_ASSERT_TRUE(d.isTimeValid());
+  // host builds do not set the system clock, check the boot time
+  TEST_ASSERT_INT_WITHIN(2, time(nullptr) + 7200,
+                         d.getBootTime() + (time_t)(millis() / 1000));
+  // now() follows the synced clock model
+  TEST_ASSERT_INT_WITHIN(2, time(nullptr) + 7200, d.now());
+  TEST_ASSERT_EQUAL(1, d.getClockDrift().getCount());
+  d.setServer("c.test", "x.test", "y.test");
+  TEST_ASSERT_FALSE(d.sntpUpdate(transport, nullptr, 100));
+}
+#endif
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_timestamp_conversion);
+  RUN_TEST(test_packet_encode_decode);
+#ifndef ARDUINO
+  RUN_TEST(test_client_offset_delay);
+  RUN_TEST(test_client_rejects_bad_reply);
+  RUN_TEST(test_best_server);
+  RUN_TEST(test_sntp_update);
+#endif
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,163 @@
+#include <Arduino.h>
+#include <ClockDrift.h>
+#include <DateTime.h>
+#include <SyncScheduler.h>
+#include <unity.h>
+
+static bool withinJitter(const uint32_t actual, const uint32_t expected) {
+  const uint32_t span = expected / 100 * SyncScheduler::JITTER_PERCENT;
+  return actual >= expected - span && actual <= expected + span;
+}
+
+void test_due() {
+  SyncScheduler s;
+  TEST_ASSERT_FALSE(s.isRunning());
+  TEST_ASSERT_FALSE(s.isDue(1000));
+  s.start(1000);
+  TEST_ASSERT_TRUE(s.isDue(1000));
+  TEST_ASSERT_EQUAL(0, s.dueIn(1000));
+  const uint32_t d = s.onSuccess(2000, 50, 0);
+  TEST_ASSERT_FALSE(s.isDue(2000 + d - 1));
+  TEST_ASSERT_EQUAL(1, s.dueIn(2000 + d - 1));
+  TEST_ASSERT_TRUE(s.isDue(2000 + d));
+  s.stop();
+  TEST_ASSERT_FALSE(s.isDue(2000 + d));
+  // millis() wraps between the sync and the due time
+  s.start(0);
+  const unsigned long nearWrap = (unsigned long)0 - 1000;
+  const uint32_t w = s.onSuccess(nearWrap, 50, 0);
+  TEST_ASSERT_FALSE(s.isDue(nearWrap + 2000));
+  TEST_ASSERT_TRUE(s.isDue(nearWrap + w));
+}
+
+void test_interval_from_drift() {
+  SyncScheduler s(100);
+  s.start(0);
+  // unknown drift, 100 ms / 50 ppm = 2000 seconds
+  TEST_ASSERT_TRUE(withinJitter(s.onSuccess(0, 50, 0), 2000UL * 1000));
+  TEST_ASSERT_EQUAL(2000UL * 1000, s.getInterval());
+  // 1 ppm would allow 25 hours, grows 2x per sync instead
+  TEST_ASSERT_TRUE(withinJitter(s.onSuccess(0, 1, 10000), 4000UL * 1000));
+  TEST_ASSERT_TRUE(withinJitter(s.onSuccess(0, 1, 10000), 8000UL * 1000));
+  for (int i = 0; i < 4; i++) {
+    s.onSuccess(0, 1, 10000);
+  }
+  TEST_ASSERT_EQUAL(90000UL * 1000, s.getInterval());
+  // clamped to the max interval
+  for (int i = 0; i < 4; i++) {
+    s.onSuccess(0, 0.1, 0);
+  }
+  TEST_ASSERT_EQUAL(SyncScheduler::MAX_INTERVAL_MS, s.getInterval());
+  // residual above the budget, sync as often as allowed
+  s.onSuccess(0, 1, 200000);
+  TEST_ASSERT_EQUAL(SyncScheduler::MIN_INTERVAL_MS, s.getInterval());
+  // tighter budget, shorter interval
+  SyncScheduler tight(10);
+  tight.start(0);
+  tight.onSuccess(0, 50, 0);
+  TEST_ASSERT_EQUAL(200UL * 1000, tight.getInterval());
+}
+
+void test_failure_backoff() {
+  SyncScheduler s;
+  s.start(0);
+  uint32_t expected = SyncScheduler::RETRY_MS;
+  for (int i = 0; i < 20; i++) {
+    const uint32_t d = s.onFailure(0);
+    TEST_ASSERT_TRUE(withinJitter(d, expected));
+    TEST_ASSERT_EQUAL(i + 1, s.getFailures());
+    expected = expected * 2 < SyncScheduler::MAX_RETRY_MS
+                   ? expected * 2
+                   : SyncScheduler::MAX_RETRY_MS;
+  }
+  s.onSuccess(0, 50, 0);
+  TEST_ASSERT_EQUAL(0, s.getFailures());
+  TEST_ASSERT_TRUE(withinJitter(s.onFailure(0), SyncScheduler::RETRY_MS));
+}
+
+void test_fleet_jitter() {
+  // devices booted together must not sync in lockstep
+  const int FLEET = 1000;
+  uint32_t delays[FLEET];
+  uint32_t minDelay = 0xFFFFFFFFUL;
+  uint32_t maxDelay = 0;
+  for (int i = 0; i < FLEET; i++) {
+    SyncScheduler s;
+    s.setSeed(0x12345678UL * (i + 1));
+    s.start(0);
+    delays[i] = s.onSuccess(0, 50, 0);
+    TEST_ASSERT_TRUE(withinJitter(delays[i], 2000UL * 1000));
+    minDelay = delays[i] < minDelay ? delays[i] : minDelay;
+    maxDelay = delays[i] > maxDelay ? delays[i] : maxDelay;
+  }
+  // spread over most of the +-10% window, 200 seconds each side
+  TEST_ASSERT_TRUE(minDelay < 2000UL * 1000 - 150UL * 1000);
+  TEST_ASSERT_TRUE(maxDelay > 2000UL * 1000 + 150UL * 1000);
+  // evenly spread over 20 second buckets, 50 devices each on average
+  int buckets[20] = {0};
+  for (int i = 0; i < FLEET; i++) {
+    const uint32_t offset = delays[i] - (2000UL * 1000 - 200UL * 1000);
+    buckets[offset / 20000 < 20 ? offset / 20000 : 19]++;
+  }
+  for (int i = 0; i < 20; i++) {
+    TEST_ASSERT_TRUE(buckets[i] >= 25 && buckets[i] <= 80);
+  }
+}
+
+void test_drift_uncertainty() {
+  ClockDrift drift;
+  const int64_t base = 1669680000LL * 1000000;
+  const int64_t hour = 3600LL * 1000000;
+  TEST_ASSERT_FLOAT_WITHIN(0.001, ClockDrift::UNKNOWN_PPM,
+                           drift.getUncertaintyPpm());
+  // 20 ppm, +-1 ms of noise
+  const int64_t noise[] = {800, -600, 1000, -900, 100, 400, -300, -1000};
+  for (int i = 0; i < 8; i++) {
+    const int64_t mono = i * hour;
+    drift.addSample(mono, base + mono + mono / 50000 + noise[i]);
+  }
+  TEST_ASSERT_TRUE(drift.getUncertaintyPpm() < 0.2);
+  TEST_ASSERT_TRUE(drift.getUncertaintyPpm() >= ClockDrift::MIN_PPM);
+}
+
+void test_auto_sync() {
+  DateTimeClass d(0, "UTC0");
+  TEST_ASSERT_FALSE(d.isSyncDue());
+  d.setAutoSync(true, 100);
+  TEST_ASSERT_TRUE(d.isSyncDue());
+  // host builds have a valid system clock, the sync completes at once
+  NTPSync::State state = d.poll();
+  for (int i = 0; i < 10 && state == NTPSync::SYNCING; i++) {
+    delay(d.isSyncing() ? 10 : 0);
+    state = d.poll();
+  }
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, state);
+  TEST_ASSERT_FALSE(d.isSyncDue());
+  TEST_ASSERT_EQUAL(2000UL * 1000, d.getScheduler().getInterval());
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, d.poll());
+  d.setAutoSync(false);
+  TEST_ASSERT_FALSE(d.getScheduler().isRunning());
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_due);
+  RUN_TEST(test_interval_from_drift);
+  RUN_TEST(test_failure_backoff);
+  RUN_TEST(test_fleet_jitter);
+  RUN_TEST(test_drift_uncertainty);
+#ifndef ARDUINO
+  RUN_TEST(test_auto_sync);
+#endif
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
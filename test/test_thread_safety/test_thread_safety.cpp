@@ -0,0 +1,332 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <RcuCell.h>
+#include <unity.h>
+
+#ifndef ARDUINO
+#include <pthread.h>
+#include <atomic>
+#endif
+
+static const int64_t T_BASE_US = 1669680000LL * 1000000;  // 2022-11-29
+static const char* TZ_CET = "CET-1CEST,M3.5.0,M10.5.0/3";
+static const char* TZ_JST = "JST-9";
+
+struct Pair {
+  int32_t a;
+  int32_t b;
+};
+
+void test_rcu_cell() {
+  RcuCell<Pair> cell({1, 2});
+  TEST_ASSERT_EQUAL(1, cell.get().a);
+  TEST_ASSERT_TRUE(cell.update([](Pair& next) {
+    next.a = 10;
+    return true;
+  }));
+  {
+    RcuCell<Pair>::Reader r(cell);
+    TEST_ASSERT_EQUAL(10, r->a);
+    TEST_ASSERT_EQUAL(2, r->b);
+  }
+  // discarded copy keeps the published value
+  TEST_ASSERT_FALSE(cell.update([](Pair& next) {
+    next.a = 20;
+    return false;
+  }));
+  TEST_ASSERT_EQUAL(10, cell.get().a);
+  RcuCell<Pair> copy(cell);
+  cell.update([](Pair& next) {
+    next.b = 30;
+    return true;
+  });
+  TEST_ASSERT_EQUAL(2, copy.get().b);
+  copy = cell;
+  TEST_ASSERT_EQUAL(30, copy.get().b);
+}
+
+// readers and tryUpdate() never wait for the writer flag, taking it here
+// would deadlock inside update()
+void test_readers_never_wait() {
+  RcuCell<Pair> cell({1, -1});
+  bool readInside = false;
+  cell.update([&cell, &readInside](Pair& next) {
+    RcuCell<Pair>::Reader r(cell);
+    readInside = r->a == 1 && cell.get().b == -1 &&
+                 !cell.tryUpdate([](Pair&) { return true; });
+    next.a = 2;
+    next.b = -2;
+    return true;
+  });
+  TEST_ASSERT_TRUE(readInside);
+  {
+    // a reader still pins the slot the next writer would reuse
+    RcuCell<Pair>::Reader old(cell);
+    cell.update([](Pair& next) {
+      next.a = 3;
+      return true;
+    });
+    TEST_ASSERT_FALSE(cell.tryUpdate([](Pair& next) {
+      next.a = 4;
+      return true;
+    }));
+    TEST_ASSERT_EQUAL(2, old->a);
+    TEST_ASSERT_EQUAL(3, cell.get().a);
+  }
+  TEST_ASSERT_TRUE(cell.tryUpdate([](Pair& next) {
+    next.a = 4;
+    return true;
+  }));
+  TEST_ASSERT_EQUAL(4, cell.get().a);
+}
+
+void test_shared_offset_at() {
+  TimeZoneRule cached(TZ_CET);
+  TimeZoneRule shared(TZ_CET);
+  // prime the cache with 2022, other years are computed on the stack
+  shared.offsetAt(1669680000);
+  for (time_t t = 1500000000; t < 1700000000; t += 86400 * 7 + 3599) {
+    int8_t d1, d2;
+    TEST_ASSERT_EQUAL(cached.offsetAt(t, &d1), shared.sharedOffsetAt(t, &d2));
+    TEST_ASSERT_EQUAL(d1, d2);
+  }
+  TimeZoneRule fixed(TZ_JST);
+  TEST_ASSERT_EQUAL(32400, fixed.sharedOffsetAt(1574985600));
+}
+
+void test_snapshot_getters() {
+  DateTimeClass d(T_BASE_US / 1000000, TZ_CET);
+  auto p = d.getParts(T_BASE_US);
+  TEST_ASSERT_EQUAL(3600, p.getOffset());
+  TEST_ASSERT_EQUAL_STRING(TZ_CET, p.getTimeZone());
+  TEST_ASSERT_TRUE(d.setTimeZone(TZ_JST));
+  TEST_ASSERT_FALSE(d.setTimeZone(TZ_JST));
+  TEST_ASSERT_FALSE(d.setTimeZone("bad"));
+  TEST_ASSERT_EQUAL_STRING(TZ_JST, d.getTimeZone());
+  TEST_ASSERT_EQUAL(32400, d.getTimeZoneRule().getStdOffset());
+  TEST_ASSERT_EQUAL(32400, d.getParts(T_BASE_US).getOffset());
+  d.setServer("a.test", "b.test", "c.test");
+  TEST_ASSERT_EQUAL_STRING("a.test", d.getServer());
+  // operators copy the published settings
+  DateTimeClass later = d + 60;
+  TEST_ASSERT_EQUAL_STRING(TZ_JST, later.getTimeZone());
+  TEST_ASSERT_EQUAL_STRING("a.test", later.getServer());
+  const DateTimeClass copy = later;
+  TEST_ASSERT_TRUE(copy == later);
+  later += 3600;
+  TEST_ASSERT_TRUE(copy != later);
+}
+
+#ifndef ARDUINO
+struct StressState {
+  RcuCell<Pair>* cell;
+  DateTimeClass* dateTime;
+  std::atomic<bool> done;
+  std::atomic<long> reads;
+  std::atomic<long> writes;
+  std::atomic<long> errors;
+};
+
+static void* pairReader(void* arg) {
+  StressState* s = (StressState*)arg;
+  while (!s->done.load()) {
+    RcuCell<Pair>::Reader r(*s->cell);
+    if (r->b != -r->a) {
+      s->errors++;
+    }
+    s->reads++;
+  }
+  return nullptr;
+}
+
+static void* pairWriter(void* arg) {
+  StressState* s = (StressState*)arg;
+  for (int32_t i = 1; !s->done.load(); i++) {
+    s->cell->update([i](Pair& next) {
+      next.a = i;
+      next.b = -i;
+      return true;
+    });
+    s->writes++;
+  }
+  return nullptr;
+}
+
+// pairs are always published whole, b == -a
+void test_rcu_cell_stress() {
+  RcuCell<Pair> cell({0, 0});
+  StressState s;
+  s.cell = &cell;
+  s.done = false;
+  s.reads = 0;
+  s.writes = 0;
+  s.errors = 0;
+  pthread_t readers[3], writers[2];
+  for (pthread_t& t : readers) {
+    pthread_create(&t, nullptr, pairReader, &s);
+  }
+  for (pthread_t& t : writers) {
+    pthread_create(&t, nullptr, pairWriter, &s);
+  }
+  delay(300);
+  s.done = true;
+  for (pthread_t& t : readers) {
+    pthread_join(t, nullptr);
+  }
+  for (pthread_t& t : writers) {
+    pthread_join(t, nullptr);
+  }
+  TEST_ASSERT_EQUAL(0, s.errors.load());
+  TEST_ASSERT_TRUE(s.reads.load() > 1000);
+  TEST_ASSERT_TRUE(s.writes.load() > 100);
+}
+
+static void* dateTimeReader(void* arg) {
+  StressState* s = (StressState*)arg;
+  char buf[32];
+  while (!s->done.load()) {
+    // zone string and offset come from the same snapshot
+    const DateTimeParts p = s->dateTime->getParts(T_BASE_US);
+    const bool cet = strcmp(p.getTimeZone(), TZ_CET) == 0;
+    const bool jst = strcmp(p.getTimeZone(), TZ_JST) == 0;
+    if (!(cet && p.getOffset() == 3600) && !(jst && p.getOffset() == 32400)) {
+      s->errors++;
+    }
+    const size_t len = p.formatTo(buf, sizeof(buf), DateFormatter::ISO8601);
+    if (len != 24 || strcmp(buf + 19, cet ? "+0100" : "+0900") != 0) {
+      s->errors++;
+    }
+    const char* server = s->dateTime->getServer();
+    if (strcmp(server, "a.test") != 0 && strcmp(server, "x.test") != 0) {
+      s->errors++;
+    }
+    if (!s->dateTime->isTimeValid()) {
+      s->errors++;
+    }
+    s->dateTime->formatTo(buf, sizeof(buf), DateFormatter::SIMPLE);
+    s->reads++;
+  }
+  return nullptr;
+}
+
+static void* dateTimeWriter(void* arg) {
+  StressState* s = (StressState*)arg;
+  for (long i = 0; !s->done.load(); i++) {
+    s->dateTime->setTimeZone(i % 2 ? TZ_JST : TZ_CET);
+    s->dateTime->setServer(i % 3 ? "a.test" : "x.test");
+    s->dateTime->setTime(T_BASE_US / 1000000 + i);
+    s->writes++;
+  }
+  return nullptr;
+}
+
+void test_date_time_stress() {
+  DateTimeClass d(T_BASE_US / 1000000, TZ_CET, "a.test");
+  StressState s;
+  s.dateTime = &d;
+  s.done = false;
+  s.reads = 0;
+  s.writes = 0;
+  s.errors = 0;
+  pthread_t readers[3], writer;
+  for (pthread_t& t : readers) {
+    pthread_create(&t, nullptr, dateTimeReader, &s);
+  }
+  pthread_create(&writer, nullptr, dateTimeWriter, &s);
+  delay(500);
+  s.done = true;
+  for (pthread_t& t : readers) {
+    pthread_join(t, nullptr);
+  }
+  pthread_join(writer, nullptr);
+  TEST_ASSERT_EQUAL(0, s.errors.load());
+  TEST_ASSERT_TRUE(s.reads.load() > 1000);
+  TEST_ASSERT_TRUE(s.writes.load() > 100);
+}
+
+// stamps of different years in the two zones, expected offsets worked out
+// single threaded before the readers start
+static const time_t ZONE_STAMPS[] = {1500000000, 1669680000, 1719792000,
+                                     2000000000};
+static int32_t zoneOffsets[2][4];
+
+struct ZoneReader {
+  StressState* state;
+  uint8_t first;
+};
+
+static void* zoneReader(void* arg) {
+  StressState* s = ((ZoneReader*)arg)->state;
+  const uint8_t first = ((ZoneReader*)arg)->first;
+  const char* zones[] = {TZ_CET, TZ_JST};
+  for (uint32_t i = 0; !s->done.load(); i++) {
+    // the readers walk the zones in opposite order, so the cache misses
+    const uint8_t z = (i + first) % 2;
+    const uint8_t y = (i / 2) % 4;
+    const time_t ts = ZONE_STAMPS[y];
+    if (DateTimeParts::from(ts, zones[z]).getOffset() != zoneOffsets[z][y] ||
+        s->dateTime->getParts(ts * 1000000LL).getOffset() !=
+            zoneOffsets[0][y]) {
+      s->errors++;
+    }
+    s->reads++;
+  }
+  return nullptr;
+}
+
+// readers switching zones and years never wait for each other
+void test_zone_cache_stress() {
+  DateTimeClass d(T_BASE_US / 1000000, TZ_CET);
+  const char* zones[] = {TZ_CET, TZ_JST};
+  for (uint8_t z = 0; z < 2; z++) {
+    const TimeZoneRule rule(zones[z]);
+    for (uint8_t y = 0; y < 4; y++) {
+      zoneOffsets[z][y] = rule.offsetAt(ZONE_STAMPS[y]);
+    }
+  }
+  StressState s;
+  s.dateTime = &d;
+  s.done = false;
+  s.reads = 0;
+  s.writes = 0;
+  s.errors = 0;
+  pthread_t readers[2];
+  ZoneReader args[2] = {{&s, 0}, {&s, 1}};
+  for (uint8_t i = 0; i < 2; i++) {
+    pthread_create(&readers[i], nullptr, zoneReader, &args[i]);
+  }
+  delay(300);
+  s.done = true;
+  for (pthread_t& t : readers) {
+    pthread_join(t, nullptr);
+  }
+  TEST_ASSERT_EQUAL(0, s.errors.load());
+  TEST_ASSERT_TRUE(s.reads.load() > 1000);
+  // no reader primed the shared rule for a stamp of another year
+  TEST_ASSERT_TRUE(d.getTimeZoneRule().isCacheExpired(ZONE_STAMPS[3]));
+}
+#endif
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_rcu_cell);
+  RUN_TEST(test_readers_never_wait);
+  RUN_TEST(test_shared_offset_at);
+  RUN_TEST(test_snapshot_getters);
+#ifndef ARDUINO
+  RUN_TEST(test_rcu_cell_stress);
+  RUN_TEST(test_date_time_stress);
+  RUN_TEST(test_zone_cache_stress);
+#endif
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,222 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <TimeSource.h>
+#include <unity.h>
+
+// 2022-11-29 12:34:56 UTC, a Tuesday
+static const int64_t BASE_SECS = 1669725296LL;
+
+// register map of one chip, the seconds register ticks after some reads
+class FakeI2CBus : public I2CBus {
+ public:
+  uint8_t address;
+  uint8_t secondsReg;
+  uint8_t regs[32];
+  int reads = 0;
+  int tickAfter = 0;
+  FakeI2CBus(const uint8_t _address, const uint8_t _secondsReg)
+      : address(_address), secondsReg(_secondsReg) {
+    memset(regs, 0, sizeof(regs));
+  }
+  bool readRegisters(const uint8_t addr, const uint8_t reg, uint8_t* buf,
+                     const size_t len) override {
+    if (addr != address || reg + len > sizeof(regs)) {
+      return false;
+    }
+    if (++reads == tickAfter) {
+      // BCD increment, no carry past 59 needed here
+      uint8_t& s = regs[secondsReg];
+      s = (s & 0x0F) == 9 ? (uint8_t)((s & 0xF0) + 0x10) : (uint8_t)(s + 1);
+    }
+    memcpy(buf, regs + reg, len);
+    return true;
+  }
+  bool writeRegisters(const uint8_t addr, const uint8_t reg,
+                      const uint8_t* data, const size_t len) override {
+    if (addr != address || reg + len > sizeof(regs)) {
+      return false;
+    }
+    memcpy(regs + reg, data, len);
+    return true;
+  }
+  void set(const uint8_t* time) { memcpy(regs + secondsReg, time, 7); }
+};
+
+// 12:34:56, Tuesday 29 November 2022
+static const uint8_t DS_TIME[] = {0x56, 0x34, 0x12, 0x03, 0x29, 0x11, 0x22};
+static const uint8_t PCF_TIME[] = {0x56, 0x34, 0x12, 0x29, 0x02, 0x11, 0x22};
+
+void test_read() {
+  FakeI2CBus bus(DS3231TimeSource::ADDRESS, 0);
+  DS3231TimeSource rtc(bus);
+  rtc.setWaitEdge(false);
+  int64_t utcUs = 0;
+  TEST_ASSERT_FALSE(rtc.read(&utcUs));
+  bus.set(DS_TIME);
+  TEST_ASSERT_TRUE(rtc.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs == BASE_SECS * 1000000 + 500000);
+  // 12 hour mode, 12:34 PM and 1:34 PM
+  bus.regs[2] = 0x40 | 0x20 | 0x12;
+  TEST_ASSERT_TRUE(rtc.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs == BASE_SECS * 1000000 + 500000);
+  bus.regs[2] = 0x40 | 0x20 | 0x01;
+  TEST_ASSERT_TRUE(rtc.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs == (BASE_SECS + 3600) * 1000000 + 500000);
+  // oscillator stopped after power loss
+  bus.set(DS_TIME);
+  bus.regs[0x0F] = 0x80;
+  TEST_ASSERT_FALSE(rtc.read(&utcUs));
+  bus.regs[0x0F] = 0;
+  // 30 February
+  bus.regs[4] = 0x30;
+  bus.regs[5] = 0x02;
+  TEST_ASSERT_FALSE(rtc.read(&utcUs));
+  TEST_ASSERT_EQUAL_STRING("DS3231", rtc.getName());
+  TEST_ASSERT_EQUAL(2, rtc.getAccuracyPpm());
+
+  FakeI2CBus pcfBus(PCF8563TimeSource::ADDRESS, 2);
+  PCF8563TimeSource pcf(pcfBus);
+  pcf.setWaitEdge(false);
+  pcfBus.set(PCF_TIME);
+  TEST_ASSERT_TRUE(pcf.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs == BASE_SECS * 1000000 + 500000);
+  // voltage low, the time is not reliable
+  pcfBus.regs[2] |= 0x80;
+  TEST_ASSERT_FALSE(pcf.read(&utcUs));
+
+  FakeI2CBus dsBus(DS1307TimeSource::ADDRESS, 0);
+  DS1307TimeSource ds1307(dsBus);
+  ds1307.setWaitEdge(false);
+  dsBus.set(DS_TIME);
+  TEST_ASSERT_TRUE(ds1307.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs == BASE_SECS * 1000000 + 500000);
+  // clock halted
+  dsBus.regs[0] |= 0x80;
+  TEST_ASSERT_FALSE(ds1307.read(&utcUs));
+  // no device
+  FakeI2CBus other(0x50, 0);
+  DS1307TimeSource missing(other);
+  TEST_ASSERT_FALSE(missing.read(&utcUs));
+}
+
+void test_read_edge() {
+  FakeI2CBus bus(DS3231TimeSource::ADDRESS, 0);
+  DS3231TimeSource rtc(bus);
+  bus.set(DS_TIME);
+  bus.tickAfter = 5;
+  int64_t utcUs = 0;
+  // the time at the seconds tick, no rounding
+  TEST_ASSERT_TRUE(rtc.read(&utcUs));
+  TEST_ASSERT_TRUE(utcUs == (BASE_SECS + 1) * 1000000);
+  TEST_ASSERT_TRUE(bus.reads > 5);
+  // a stopped chip never ticks
+  bus.tickAfter = 0;
+  const uint32_t startMs = millis();
+  TEST_ASSERT_FALSE(rtc.read(&utcUs));
+  TEST_ASSERT_TRUE(millis() - startMs >= 1000);
+}
+
+void test_write() {
+  const int64_t utcUs = BASE_SECS * 1000000 + 400000;
+  int64_t back = 0;
+
+  FakeI2CBus bus(DS3231TimeSource::ADDRESS, 0);
+  bus.regs[0x0F] = 0x88;
+  DS3231TimeSource rtc(bus);
+  rtc.setWaitEdge(false);
+  TEST_ASSERT_TRUE(rtc.write(utcUs));
+  TEST_ASSERT_EQUAL_MEMORY(DS_TIME, bus.regs, 7);
+  // oscillator stop flag cleared, other status bits kept
+  TEST_ASSERT_EQUAL_HEX8(0x08, bus.regs[0x0F]);
+  TEST_ASSERT_TRUE(rtc.read(&back));
+  TEST_ASSERT_TRUE(back == BASE_SECS * 1000000 + 500000);
+  // nearest second
+  TEST_ASSERT_TRUE(rtc.write(utcUs + 200000));
+  TEST_ASSERT_EQUAL_HEX8(0x57, bus.regs[0]);
+  // two digit years only
+  TEST_ASSERT_FALSE(rtc.write(4102444800LL * 1000000));
+
+  FakeI2CBus pcfBus(PCF8563TimeSource::ADDRESS, 2);
+  pcfBus.regs[2] = 0x80;
+  PCF8563TimeSource pcf(pcfBus);
+  TEST_ASSERT_TRUE(pcf.write(utcUs));
+  TEST_ASSERT_EQUAL_MEMORY(PCF_TIME, pcfBus.regs + 2, 7);
+
+  FakeI2CBus dsBus(DS1307TimeSource::ADDRESS, 0);
+  dsBus.regs[0] = 0x80;
+  DS1307TimeSource ds1307(dsBus);
+  TEST_ASSERT_TRUE(ds1307.write(utcUs));
+  TEST_ASSERT_EQUAL_MEMORY(DS_TIME, dsBus.regs, 7);
+}
+
+#ifndef ARDUINO
+void test_date_time_sources() {
+  FakeI2CBus dsBus(DS1307TimeSource::ADDRESS, 0);
+  DS1307TimeSource ds1307(dsBus);
+  dsBus.set(DS_TIME);
+  dsBus.tickAfter = 3;
+  // preferred, but lost its time
+  FakeI2CBus bus(DS3231TimeSource::ADDRESS, 0);
+  DS3231TimeSource ds3231(bus);
+  bus.regs[0x0F] = 0x80;
+
+  DateTimeClass d(0, "UTC0");
+  TEST_ASSERT_TRUE(d.addTimeSource(&ds1307));
+  TEST_ASSERT_TRUE(d.addTimeSource(&ds3231));
+  TEST_ASSERT_TRUE(d.begin());
+  TEST_ASSERT_TRUE(d.isTimeRestored());
+  TEST_ASSERT_TRUE(d.isSyncing());
+  TEST_ASSERT_TRUE(d.getTime() >= BASE_SECS + 1);
+  TEST_ASSERT_TRUE(d.getTime() <= BASE_SECS + 2);
+
+  // host builds have a valid system clock, the sync completes at once
+  NTPSync::State state = d.poll();
+  for (int i = 0; i < 10 && state == NTPSync::SYNCING; i++) {
+    delay(10);
+    state = d.poll();
+  }
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, state);
+  TEST_ASSERT_FALSE(d.isTimeRestored());
+  // the synced time is written near the start of a second
+  for (int i = 0; i < 2000 && bus.regs[0x0F] != 0; i++) {
+    delay(1);
+    d.poll();
+  }
+  TEST_ASSERT_EQUAL_HEX8(0, bus.regs[0x0F]);
+  ds3231.setWaitEdge(false);
+  int64_t utcUs;
+  TEST_ASSERT_TRUE(ds3231.read(&utcUs));
+  TEST_ASSERT_TRUE(abs(utcUs / 1000000 - time(nullptr)) <= 1);
+  dsBus.tickAfter = 0;
+  ds1307.setWaitEdge(false);
+  TEST_ASSERT_TRUE(ds1307.read(&utcUs));
+  TEST_ASSERT_TRUE(abs(utcUs / 1000000 - time(nullptr)) <= 1);
+
+  for (int i = 2; i < DateTimeClass::MAX_TIME_SOURCES; i++) {
+    TEST_ASSERT_TRUE(d.addTimeSource(&ds1307));
+  }
+  TEST_ASSERT_FALSE(d.addTimeSource(&ds1307));
+  TEST_ASSERT_FALSE(d.addTimeSource(nullptr));
+}
+#endif
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_read);
+  RUN_TEST(test_read_edge);
+  RUN_TEST(test_write);
+#ifndef ARDUINO
+  RUN_TEST(test_date_time_sources);
+#endif
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
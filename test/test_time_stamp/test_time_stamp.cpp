@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <TimeStamp.h>
+#include <unity.h>
+
+#ifndef ARDUINO
+#include <atomic>
+#include <thread>
+#endif
+
+static const int64_t T_BASE_US = 1574985600LL * 1000000;  // 2019-11-29
+
+void test_anchor_initial() {
+  StampAnchor anchor;
+  int64_t epochUs = -1;
+  uint32_t monoUs = 1;
+  TEST_ASSERT_EQUAL(0, anchor.read(&epochUs, &monoUs));
+  TEST_ASSERT_TRUE(epochUs == 0);
+  TEST_ASSERT_EQUAL(0, monoUs);
+  // before the first publish stamps count from boot
+  TEST_ASSERT_TRUE(anchor.at(12345) == 12345);
+}
+
+void test_anchor_publish() {
+  StampAnchor anchor;
+  TEST_ASSERT_TRUE(anchor.publish(T_BASE_US, 1000));
+  TEST_ASSERT_TRUE(anchor.at(1000) == T_BASE_US);
+  TEST_ASSERT_TRUE(anchor.at(2500) == T_BASE_US + 1500);
+  // micros() wrapped after the anchor
+  TEST_ASSERT_TRUE(anchor.publish(T_BASE_US, 0xFFFFFF00UL));
+  TEST_ASSERT_TRUE(anchor.at(0x100) == T_BASE_US + 0x200);
+  int64_t epochUs;
+  uint32_t monoUs;
+  TEST_ASSERT_EQUAL(2, anchor.read(&epochUs, &monoUs));
+  StampAnchor copy(anchor);
+  TEST_ASSERT_TRUE(copy.at(0x100) == T_BASE_US + 0x200);
+}
+
+void test_capture_stamp() {
+  DateTimeClass d(0, "CST-8");
+  const int64_t now = d.nowUs();
+  const int64_t stamp = d.captureStamp();
+  TEST_ASSERT_TRUE(stamp - now >= 0 && stamp - now < 10000);
+  int64_t last = stamp;
+  for (int i = 0; i < 1000; i++) {
+    const int64_t s = d.captureStamp();
+    TEST_ASSERT_TRUE(s >= last);
+    last = s;
+  }
+  // deferred formatting in the object time zone
+  auto p = d.getParts(T_BASE_US + 250000);
+  TEST_ASSERT_EQUAL(8, p.getHours());
+  TEST_ASSERT_EQUAL(250, p.getMilliseconds());
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T08:00:00.250+0800",
+                           p.format(DateFormatter::ISO8601_MS).c_str());
+}
+
+#ifndef ARDUINO
+// pairs published by the writer always satisfy epoch = BASE + mono * 3
+void test_concurrent_publish_read() {
+  StampAnchor anchor;
+  std::atomic<bool> done(false);
+  std::atomic<long> reads(0);
+  std::atomic<long> torn(0);
+  std::atomic<long> publishes(0);
+  auto writer = [&](uint32_t start) {
+    for (uint32_t m = start; !done.load(); m += 2) {
+      if (anchor.publish(T_BASE_US + (int64_t)m * 3, m)) {
+        publishes++;
+      }
+    }
+  };
+  auto reader = [&]() {
+    while (!done.load()) {
+      int64_t epochUs;
+      uint32_t monoUs;
+      if (anchor.read(&epochUs, &monoUs) != 0 &&
+          epochUs != T_BASE_US + (int64_t)monoUs * 3) {
+        torn++;
+      }
+      reads++;
+    }
+  };
+  std::thread w1(writer, 1), w2(writer, 2);
+  std::thread r1(reader), r2(reader), r3(reader);
+  const unsigned long start = millis();
+  while (millis() - start < 500) {
+    delay(10);
+  }
+  done = true;
+  w1.join();
+  w2.join();
+  r1.join();
+  r2.join();
+  r3.join();
+  TEST_ASSERT_EQUAL(0, torn.load());
+  TEST_ASSERT_TRUE(reads.load() > 1000);
+  TEST_ASSERT_TRUE(publishes.load() > 1000);
+}
+
+void test_concurrent_capture() {
+  DateTimeClass d(0, "UTC0");
+  std::atomic<bool> done(false);
+  std::atomic<long> errors(0);
+  std::thread writer([&]() {
+    while (!done.load()) {
+      d.setTime(time(nullptr));
+    }
+  });
+  auto reader = [&]() {
+    while (!done.load()) {
+      struct timeval tv;
+      gettimeofday(&tv, nullptr);
+      const int64_t sys = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+      const int64_t stamp = d.captureStamp();
+      // a torn pair is off by ~71 minutes, preemption only by a time slice
+      if (stamp - sys < -1000000 || stamp - sys > 1000000) {
+        errors++;
+      }
+    }
+  };
+  std::thread r1(reader), r2(reader);
+  delay(300);
+  done = true;
+  writer.join();
+  r1.join();
+  r2.join();
+  TEST_ASSERT_EQUAL(0, errors.load());
+}
+#endif
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_anchor_initial);
+  RUN_TEST(test_anchor_publish);
+  RUN_TEST(test_capture_stamp);
+#ifndef ARDUINO
+  RUN_TEST(test_concurrent_publish_read);
+  RUN_TEST(test_concurrent_capture);
+#endif
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,280 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <TimeStorage.h>
+#include <unity.h>
+
+static const int64_t BASE_US = 1669680000LL * 1000000;
+
+// stand-in for RTC memory or EEPROM, a record that may be left unwritten
+class RamTimeStorage : public TimeStorage {
+ public:
+  uint8_t data[TimeRecord::SIZE];
+  int writes = 0;
+  RamTimeStorage() { memset(data, 0xFF, sizeof(data)); }
+  bool read(uint8_t* buf, const size_t len) override {
+    memcpy(buf, data, len);
+    return true;
+  }
+  bool write(const uint8_t* buf, const size_t len) override {
+    memcpy(data, buf, len);
+    writes++;
+    return true;
+  }
+};
+
+#ifndef ARDUINO
+#include <stdio.h>
+
+// flash stand-in, survives the object like a record survives a reboot
+class FileTimeStorage : public TimeStorage {
+ public:
+  explicit FileTimeStorage(const char* _path) : path(_path) {}
+  bool read(uint8_t* buf, const size_t len) override {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+      return false;
+    }
+    const bool ok = fread(buf, 1, len, f) == len;
+    fclose(f);
+    return ok;
+  }
+  bool write(const uint8_t* buf, const size_t len) override {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+      return false;
+    }
+    const bool ok = fwrite(buf, 1, len, f) == len;
+    fclose(f);
+    return ok;
+  }
+
+ private:
+  const char* path;
+};
+#endif
+
+void test_record() {
+  TimeRecord r;
+  memset(&r, 0, sizeof(r));
+  r.epochUs = BASE_US + 123456;
+  r.monoUs = 987654321LL;
+  r.freqPpb = -12345;
+  strcpy(r.timeZone, "CET-1CEST,M3.5.0,M10.5.0/3");
+  r.flags = TimeRecord::FLAG_SLEEP | TimeRecord::FLAG_RTC;
+  r.sleepUs = 600LL * 1000000;
+  r.rtcUs = -1;
+  uint8_t buf[TimeRecord::SIZE];
+  r.encode(buf);
+  TimeRecord d;
+  TEST_ASSERT_TRUE(d.decode(buf, sizeof(buf)));
+  TEST_ASSERT_TRUE(d.epochUs == r.epochUs);
+  TEST_ASSERT_TRUE(d.monoUs == r.monoUs);
+  TEST_ASSERT_EQUAL(-12345, d.freqPpb);
+  TEST_ASSERT_EQUAL_STRING(r.timeZone, d.timeZone);
+  TEST_ASSERT_EQUAL(r.flags, d.flags);
+  TEST_ASSERT_TRUE(d.sleepUs == r.sleepUs);
+  TEST_ASSERT_TRUE(d.rtcUs == -1);
+  // little endian, independent of the host
+  TEST_ASSERT_EQUAL('E', buf[0]);
+  TEST_ASSERT_EQUAL('D', buf[1]);
+  TEST_ASSERT_EQUAL(TimeRecord::VERSION, buf[4]);
+  // standard check value
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926UL,
+                          TimeRecord::crc32((const uint8_t*)"123456789", 9));
+}
+
+void test_record_corrupt() {
+  TimeRecord r;
+  memset(&r, 0, sizeof(r));
+  r.epochUs = BASE_US;
+  uint8_t buf[TimeRecord::SIZE];
+  r.encode(buf);
+  TimeRecord d;
+  TEST_ASSERT_FALSE(d.decode(buf, sizeof(buf) - 1));
+  // every single bit flip is caught
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] ^= 0x10;
+    TEST_ASSERT_FALSE(d.decode(buf, sizeof(buf)));
+    buf[i] ^= 0x10;
+  }
+  TEST_ASSERT_TRUE(d.decode(buf, sizeof(buf)));
+  // erased flash and zeroed memory
+  memset(buf, 0xFF, sizeof(buf));
+  TEST_ASSERT_FALSE(d.decode(buf, sizeof(buf)));
+  memset(buf, 0, sizeof(buf));
+  TEST_ASSERT_FALSE(d.decode(buf, sizeof(buf)));
+}
+
+void test_save_restore() {
+  RamTimeStorage ram;
+  DateTimeClass a(0, "UTC0");
+  TEST_ASSERT_FALSE(a.saveTime(ram));
+  TEST_ASSERT_EQUAL(0, ram.writes);
+  a.setTime(1669680000);
+  a.setTimeZone("EST5EDT,M3.2.0,M11.1.0");
+  TEST_ASSERT_TRUE(a.saveTime(ram));
+  const int64_t saved = a.nowUs();
+
+  DateTimeClass b(0, "UTC0");
+  TEST_ASSERT_FALSE(b.isTimeValid());
+  TEST_ASSERT_TRUE(b.restoreTime(ram));
+  TEST_ASSERT_TRUE(b.isTimeValid());
+  TEST_ASSERT_TRUE(b.isTimeRestored());
+  // never earlier than the save, at most the uptime later
+  const int64_t restored = b.nowUs();
+  TEST_ASSERT_TRUE(restored >= saved - 1000);
+  TEST_ASSERT_TRUE(restored <= saved + (int64_t)MonoClock::micros64());
+  TEST_ASSERT_EQUAL_STRING("EST5EDT,M3.2.0,M11.1.0", b.getTimeZone());
+  TEST_ASSERT_EQUAL(a.getParts().getOffset(), b.getParts().getOffset());
+  // a valid time is never replaced
+  TEST_ASSERT_FALSE(b.restoreTime(ram));
+  b.setTime(1669680000);
+  TEST_ASSERT_FALSE(b.isTimeRestored());
+
+  DateTimeClass c(0, "UTC0");
+  TEST_ASSERT_TRUE(c.restoreTime(ram, false));
+  TEST_ASSERT_EQUAL_STRING("UTC0", c.getTimeZone());
+  // nothing saved yet
+  RamTimeStorage empty;
+  DateTimeClass e(0, "UTC0");
+  TEST_ASSERT_FALSE(e.restoreTime(empty));
+  TEST_ASSERT_FALSE(e.isTimeValid());
+}
+
+void test_drift_prior() {
+  ClockDrift drift;
+  drift.restore(1000, BASE_US, 20e-6);
+  TEST_ASSERT_TRUE(drift.getModel().valid);
+  TEST_ASSERT_EQUAL(0, drift.getCount());
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 20, drift.getPpm());
+  // the first sync steps the restored time, the prior stays
+  const int64_t hour = 3600LL * 1000000;
+  TEST_ASSERT_TRUE(drift.addSample(hour, BASE_US + 5 * hour));
+  TEST_ASSERT_EQUAL(1, drift.getCount());
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 20, drift.getPpm());
+  const int64_t predicted = BASE_US + 6 * hour + hour / 50000;
+  TEST_ASSERT_TRUE(abs(drift.getModel().utcAt(2 * hour) - predicted) <= 1);
+  // clamped like a fit
+  drift.restore(0, BASE_US, 0.01);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 500, drift.getPpm());
+
+  // the frequency survives a save and restore
+  RamTimeStorage ram;
+  TimeRecord r;
+  memset(&r, 0, sizeof(r));
+  r.epochUs = BASE_US;
+  r.freqPpb = 15000;
+  r.encode(ram.data);
+  DateTimeClass d(0, "UTC0");
+  TEST_ASSERT_TRUE(d.restoreTime(ram));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 15, d.getDriftPpm());
+  TEST_ASSERT_TRUE(d.saveTime(ram));
+  TimeRecord s;
+  TEST_ASSERT_TRUE(s.decode(ram.data, sizeof(ram.data)));
+  TEST_ASSERT_EQUAL(15000, s.freqPpb);
+}
+
+#ifndef ARDUINO
+void test_sleep() {
+  RamTimeStorage ram;
+  const int64_t sleepUs = 60LL * 1000000;
+  DateTimeClass none(0, "UTC0");
+  none.setTime(1669680000);
+  TEST_ASSERT_FALSE(none.prepareSleep(sleepUs));
+  DateTimeClass a(0, "UTC0");
+  a.setStorage(&ram);
+  TEST_ASSERT_FALSE(a.prepareSleep(sleepUs));
+  a.setTime(1669680000);
+  TEST_ASSERT_TRUE(a.prepareSleep(sleepUs));
+  const int64_t saved = a.nowUs();
+  TimeRecord r;
+  TEST_ASSERT_TRUE(r.decode(ram.data, sizeof(ram.data)));
+  // host builds have no RTC timer, the requested duration is used
+  TEST_ASSERT_EQUAL(TimeRecord::FLAG_SLEEP, r.flags);
+  TEST_ASSERT_TRUE(r.sleepUs == sleepUs);
+
+  // wake up, no sync needed
+  DateTimeClass b(0, "UTC0");
+  b.setStorage(&ram);
+  TEST_ASSERT_TRUE(b.begin());
+  TEST_ASSERT_FALSE(b.isSyncing());
+  TEST_ASSERT_TRUE(b.isTimeRestored());
+  const int64_t resumed = b.nowUs();
+  TEST_ASSERT_TRUE(resumed >= saved + sleepUs - 1000);
+  TEST_ASSERT_TRUE(resumed <=
+                   saved + sleepUs + (int64_t)MonoClock::micros64());
+  // the record is used once
+  TEST_ASSERT_TRUE(r.decode(ram.data, sizeof(ram.data)));
+  TEST_ASSERT_EQUAL(0, r.flags);
+  DateTimeClass c(0, "UTC0");
+  c.setStorage(&ram);
+  TEST_ASSERT_FALSE(c.resumeFromSleep());
+  TEST_ASSERT_TRUE(c.restoreTime(ram));
+  // the pre-sleep epoch plus the uptime, the sleep is not counted
+  TEST_ASSERT_TRUE(c.nowUs() - (int64_t)MonoClock::micros64() <= saved);
+}
+
+void test_begin_fallback() {
+  const char* path = "time_storage.bin";
+  remove(path);
+  RamTimeStorage rtc;
+  FileTimeStorage flash(path);
+  {
+    DateTimeClass a(0, "UTC0");
+    a.setTime(1669680000);
+    TEST_ASSERT_TRUE(a.saveTime(flash));
+  }
+  // power loss: rtc memory is garbage, the file record is used
+  DateTimeClass d(0, "UTC0");
+  d.setStorage(&rtc, &flash);
+  TEST_ASSERT_TRUE(d.begin());
+  TEST_ASSERT_TRUE(d.isTimeRestored());
+  TEST_ASSERT_TRUE(d.getTime() >= 1669680000);
+  // host builds have a valid system clock, the refine completes at once
+  NTPSync::State state = d.poll();
+  for (int i = 0; i < 10 && state == NTPSync::SYNCING; i++) {
+    delay(10);
+    state = d.poll();
+  }
+  TEST_ASSERT_EQUAL(NTPSync::SYNCED, state);
+  TEST_ASSERT_FALSE(d.isTimeRestored());
+  TEST_ASSERT_TRUE(abs(d.getTime() - time(nullptr)) <= 1);
+  // the sync saved to both, then to the fallback only once a day
+  TEST_ASSERT_EQUAL(1, rtc.writes);
+  TimeRecord r;
+  TEST_ASSERT_TRUE(r.decode(rtc.data, sizeof(rtc.data)));
+  TEST_ASSERT_TRUE(abs(r.epochUs / 1000000 - time(nullptr)) <= 1);
+  uint8_t buf[TimeRecord::SIZE];
+  TEST_ASSERT_TRUE(flash.read(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_MEMORY(rtc.data, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(d.forceUpdate());
+  TEST_ASSERT_EQUAL(2, rtc.writes);
+  TEST_ASSERT_TRUE(flash.read(buf, sizeof(buf)));
+  TEST_ASSERT_TRUE(r.decode(buf, sizeof(buf)));
+  TEST_ASSERT_FALSE(memcmp(rtc.data, buf, sizeof(buf)) == 0);
+  remove(path);
+}
+#endif
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_record);
+  RUN_TEST(test_record_corrupt);
+  RUN_TEST(test_save_restore);
+  RUN_TEST(test_drift_prior);
+#ifndef ARDUINO
+  RUN_TEST(test_sleep);
+  RUN_TEST(test_begin_fallback);
+#endif
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
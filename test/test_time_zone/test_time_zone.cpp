@@ -0,0 +1,179 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <TimeZoneRule.h>
+#include <unity.h>
+
+#ifdef ARDUINO
+static const time_t ZONE_STEP = 86400L * 3 + 3593;
+#else
+static const time_t ZONE_STEP = 3593;
+#endif
+
+static const char* const ZONES[] = {
+    "UTC0",
+    "CST-8",
+    "<+0545>-5:45",
+    "CET-1CEST,M3.5.0,M10.5.0/3",
+    "EST5EDT,M3.2.0,M11.1.0",
+    "AEST-10AEDT,M10.1.0,M4.1.0/3",
+    "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0",
+    "NZST-12NZDT,M9.5.0,M4.1.0/3",
+    "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1",
+    "<+0330>-3:30<+0430>,J79/24,J263/24",
+    "IST-1GMT0,M10.5.0,M3.5.0/1",
+    "<-01>1<+00>,80/2,300/3",
+};
+
+static void useTimeZone(const char* tz) {
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+void test_parse() {
+  TimeZoneRule cst("CST-8");
+  TEST_ASSERT_TRUE(cst.isValid());
+  TEST_ASSERT_FALSE(cst.hasDst());
+  TEST_ASSERT_EQUAL(8 * 3600, cst.getStdOffset());
+  TEST_ASSERT_EQUAL_STRING("CST", cst.getName());
+
+  TimeZoneRule cet("CET-1CEST,M3.5.0,M10.5.0/3");
+  TEST_ASSERT_TRUE(cet.isValid());
+  TEST_ASSERT_TRUE(cet.hasDst());
+  TEST_ASSERT_EQUAL(3600, cet.getStdOffset());
+  TEST_ASSERT_EQUAL(7200, cet.getDstOffset());
+  TEST_ASSERT_EQUAL_STRING("CEST", cet.getName(true));
+
+  TimeZoneRule nst("<-0330>3:30");
+  TEST_ASSERT_TRUE(nst.isValid());
+  TEST_ASSERT_EQUAL(-(3 * 3600 + 1800), nst.getStdOffset());
+  TEST_ASSERT_EQUAL_STRING("-0330", nst.getName());
+}
+
+void test_parse_invalid() {
+  TEST_ASSERT_FALSE(TimeZoneRule(nullptr).isValid());
+  TEST_ASSERT_FALSE(TimeZoneRule("").isValid());
+  TEST_ASSERT_FALSE(TimeZoneRule("C-8").isValid());
+  TEST_ASSERT_FALSE(TimeZoneRule("CST").isValid());
+  TEST_ASSERT_FALSE(TimeZoneRule("CET-1CEST,M3.5.0").isValid());
+  TEST_ASSERT_FALSE(TimeZoneRule("CET-1CEST,M13.5.0,M10.5.0").isValid());
+  TEST_ASSERT_FALSE(TimeZoneRule("CET-1CEST,M3.5.0,M10.5.0/3x").isValid());
+  TEST_ASSERT_FALSE(TimeZoneRule("<+01-1").isValid());
+}
+
+void test_transitions() {
+  TimeZoneRule cet("CET-1CEST,M3.5.0,M10.5.0/3");
+  int64_t start, end;
+  cet.transitions(2021, &start, &end);
+  // 2021-03-28 01:00:00 UTC, 2021-10-31 01:00:00 UTC
+  TEST_ASSERT_EQUAL(1616893200LL, start);
+  TEST_ASSERT_EQUAL(1635642000LL, end);
+  int8_t isdst;
+  TEST_ASSERT_EQUAL(3600, cet.offsetAt(1616893199, &isdst));
+  TEST_ASSERT_EQUAL(0, isdst);
+  TEST_ASSERT_EQUAL(7200, cet.offsetAt(1616893200, &isdst));
+  TEST_ASSERT_EQUAL(1, isdst);
+  TEST_ASSERT_EQUAL(7200, cet.offsetAt(1635641999));
+  TEST_ASSERT_EQUAL(3600, cet.offsetAt(1635642000));
+  // no rules means US rules, like newlib
+  TimeZoneRule est("EST5EDT");
+  est.transitions(2021, &start, &end);
+  // 2021-03-14 07:00:00 UTC, 2021-11-07 06:00:00 UTC
+  TEST_ASSERT_EQUAL(1615705200LL, start);
+  TEST_ASSERT_EQUAL(1636264800LL, end);
+}
+
+void test_offsets_match_libc() {
+  for (const char* tz : ZONES) {
+    useTimeZone(tz);
+    TimeZoneRule rule(tz);
+    TEST_ASSERT_TRUE_MESSAGE(rule.isValid(), tz);
+    for (time_t ts = 0; ts < 0xFFFFFFFFLL - ZONE_STEP; ts += ZONE_STEP) {
+      struct tm t;
+      localtime_r(&ts, &t);
+      int8_t isdst;
+      int32_t offset = rule.offsetAt(ts, &isdst);
+      auto p = DateTimeParts::from(ts, rule);
+      TEST_ASSERT_EQUAL_MESSAGE(t.tm_isdst > 0, isdst, tz);
+      TEST_ASSERT_EQUAL_MESSAGE(t.tm_hour, p.getHours(), tz);
+      TEST_ASSERT_EQUAL_MESSAGE(t.tm_min, p.getMinutes(), tz);
+      TEST_ASSERT_EQUAL_MESSAGE(t.tm_mday, p.getMonthDay(), tz);
+      TEST_ASSERT_EQUAL_MESSAGE(t.tm_yday, p.getYearDay(), tz);
+      TEST_ASSERT_EQUAL_MESSAGE(offset, p.getOffset(), tz);
+    }
+  }
+}
+
+void test_per_object_time_zone() {
+  useTimeZone("UTC0");
+  // 2019-11-29 15:29:55 UTC
+  DateTimeClass d(1575041395, "CST-8");
+  TEST_ASSERT_EQUAL(8 * 3600, d.getTimeZoneRule().getStdOffset());
+  auto p = DateTimeParts::from(1575041395, "CST-8");
+  TEST_ASSERT_EQUAL(23, p.getHours());
+  TEST_ASSERT_EQUAL_STRING("2019-11-29T23:29:55+0800",
+                           p.format(DateFormatter::ISO8601).c_str());
+  TEST_ASSERT_FALSE(d.setTimeZone("not a zone"));
+  TEST_ASSERT_EQUAL_STRING("CST-8", d.getTimeZone());
+  TEST_ASSERT_TRUE(d.setTimeZone("JST-9"));
+  TEST_ASSERT_EQUAL(9 * 3600, d.getTimeZoneRule().getStdOffset());
+}
+
+void test_parsed_rule_cache() {
+  useTimeZone("UTC0");
+  // 2019-11-29 15:29:55 UTC
+  const time_t ts = 1575041395;
+  char tz[32] = "CST-8";
+  TEST_ASSERT_EQUAL(23, DateTimeParts::from(ts, tz).getHours());
+  TEST_ASSERT_EQUAL(23, DateTimeParts::from(ts, tz).getHours());
+  // same buffer, another zone
+  strcpy(tz, "JST-9");
+  TEST_ASSERT_EQUAL(0, DateTimeParts::from(ts, tz).getHours());
+  TEST_ASSERT_EQUAL(9 * 3600, DateTimeParts::fromUs(ts * 1000000LL, tz)
+                                  .getOffset());
+  // other years are computed without priming the cached rule
+  strcpy(tz, "CET-1CEST,M3.5.0,M10.5.0/3");
+  TEST_ASSERT_EQUAL(3600, DateTimeParts::from(ts, tz).getOffset());
+  TEST_ASSERT_EQUAL(7200,
+                    DateTimeParts::from(ts + 200 * 86400, tz).getOffset());
+  TEST_ASSERT_EQUAL(3600,
+                    DateTimeParts::from(ts + 366 * 86400, tz).getOffset());
+  TEST_ASSERT_EQUAL(3600, DateTimeParts::from(ts, tz).getOffset());
+}
+
+void test_shared_rule_new_year() {
+  // 2024-12-31 22:59:00 UTC, a minute before new year in CET
+  DateTimeClass d(1735685940, "CET-1CEST,M3.5.0,M10.5.0/3");
+  const int64_t stampUs = 1735685940LL * 1000000;
+  TEST_ASSERT_FALSE(d.getTimeZoneRule().isCacheExpired(1735685940));
+  // a stamp years after the clock does not prime the shared rule
+  const time_t later = 2000000000;
+  TEST_ASSERT_EQUAL(18, d.getParts(later * 1000000LL).getMonthDay());
+  TEST_ASSERT_TRUE(d.getTimeZoneRule().isCacheExpired(later));
+  // primed for the year of the clock, readers take the fast path
+  TEST_ASSERT_FALSE(d.getTimeZoneRule().isCacheExpired(d.getTime()));
+  // older stamps do not prime it back
+  TEST_ASSERT_EQUAL(31, d.getParts(stampUs).getMonthDay());
+  TEST_ASSERT_FALSE(d.getTimeZoneRule().isCacheExpired(d.getTime()));
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse);
+  RUN_TEST(test_parse_invalid);
+  RUN_TEST(test_transitions);
+  RUN_TEST(test_offsets_match_libc);
+  RUN_TEST(test_per_object_time_zone);
+  RUN_TEST(test_parsed_rule_cache);
+  RUN_TEST(test_shared_rule_new_year);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,88 @@
+#include <Arduino.h>
+#include <DateTime.h>
+#include <TimeZoneDB.h>
+#include <unity.h>
+#include "tz_macros.h"
+
+static const size_t MACRO_COUNT = sizeof(TZ_MACROS) / sizeof(TZ_MACROS[0]);
+
+void test_count_matches_macros() {
+  TEST_ASSERT_EQUAL(MACRO_COUNT, TimeZoneDB::count());
+}
+
+void test_lookup_matches_macros() {
+  char name[64];
+  char rule[64];
+  for (size_t i = 0; i < MACRO_COUNT; i++) {
+    strcpy(name, TZ_MACROS[i][0]);
+    const char* found = TimeZoneDB::lookupZone(name);
+    TEST_ASSERT_NOT_NULL(found);
+    strcpy_P(rule, found);
+    TEST_ASSERT_EQUAL_MESSAGE(0, strcmp_P(rule, TZ_MACROS[i][1]), name);
+  }
+}
+
+void test_names_sorted() {
+  char prev[64];
+  char cur[64];
+  strcpy_P(prev, TimeZoneDB::nameAt(0));
+  for (size_t i = 1; i < TimeZoneDB::count(); i++) {
+    strcpy_P(cur, TimeZoneDB::nameAt(i));
+    TEST_ASSERT_TRUE(strcmp(prev, cur) < 0);
+    strcpy(prev, cur);
+  }
+  TEST_ASSERT_NULL(TimeZoneDB::nameAt(TimeZoneDB::count()));
+  TEST_ASSERT_NULL(TimeZoneDB::ruleAt(TimeZoneDB::count()));
+}
+
+void test_lookup() {
+  char rule[64];
+  strcpy_P(rule, TimeZoneDB::lookupZone("Europe/Berlin"));
+  TEST_ASSERT_EQUAL_STRING("CET-1CEST,M3.5.0,M10.5.0/3", rule);
+  strcpy_P(rule, TimeZoneDB::lookupZone("America/Argentina/Buenos_Aires"));
+  TEST_ASSERT_EQUAL_STRING("<-03>3", rule);
+  strcpy_P(rule, TimeZoneDB::lookupZone("Etc/GMT-8"));
+  TEST_ASSERT_EQUAL_STRING("<+08>-8", rule);
+  strcpy_P(rule, TimeZoneDB::lookupZone("America/Port-au-Prince"));
+  TEST_ASSERT_EQUAL_STRING("EST5EDT,M3.2.0,M11.1.0", rule);
+  TEST_ASSERT_NULL(TimeZoneDB::lookupZone("Europe/Atlantis"));
+  TEST_ASSERT_NULL(TimeZoneDB::lookupZone("Europe/berlin"));
+  TEST_ASSERT_NULL(TimeZoneDB::lookupZone(""));
+  TEST_ASSERT_NULL(TimeZoneDB::lookupZone(nullptr));
+}
+
+void test_set_time_zone_by_name() {
+  DateTimeClass d(1575041395);
+  TEST_ASSERT_TRUE(d.setTimeZone(TimeZoneDB::lookupZone("Asia/Shanghai")));
+  TEST_ASSERT_EQUAL(8 * 3600, d.getTimeZoneRule().getStdOffset());
+  TEST_ASSERT_FALSE(d.setTimeZone(TimeZoneDB::lookupZone("Asia/Atlantis")));
+  TEST_ASSERT_EQUAL(8 * 3600, d.getTimeZoneRule().getStdOffset());
+}
+
+void test_all_rules_parse() {
+  for (size_t i = 0; i < TimeZoneDB::count(); i++) {
+    TimeZoneRule rule(TimeZoneDB::ruleAt(i));
+    TEST_ASSERT_TRUE(rule.isValid());
+  }
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_count_matches_macros);
+  RUN_TEST(test_lookup_matches_macros);
+  RUN_TEST(test_names_sorted);
+  RUN_TEST(test_lookup);
+  RUN_TEST(test_set_time_zone_by_name);
+  RUN_TEST(test_all_rules_parse);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);
+  runUnityTests();
+}
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
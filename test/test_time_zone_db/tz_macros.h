@@ -0,0 +1,466 @@
+// autogenerated by tools/tzdb_gen.py from src/DateTimeTZ.h
+
+#include <DateTimeTZ.h>
+
+static const char* const TZ_MACROS[][2] = {
+    {"Africa/Abidjan", TZ_Africa_Abidjan},
+    {"Africa/Accra", TZ_Africa_Accra},
+    {"Africa/Addis_Ababa", TZ_Africa_Addis_Ababa},
+    {"Africa/Algiers", TZ_Africa_Algiers},
+    {"Africa/Asmara", TZ_Africa_Asmara},
+    {"Africa/Bamako", TZ_Africa_Bamako},
+    {"Africa/Bangui", TZ_Africa_Bangui},
+    {"Africa/Banjul", TZ_Africa_Banjul},
+    {"Africa/Bissau", TZ_Africa_Bissau},
+    {"Africa/Blantyre", TZ_Africa_Blantyre},
+    {"Africa/Brazzaville", TZ_Africa_Brazzaville},
+    {"Africa/Bujumbura", TZ_Africa_Bujumbura},
+    {"Africa/Cairo", TZ_Africa_Cairo},
+    {"Africa/Casablanca", TZ_Africa_Casablanca},
+    {"Africa/Ceuta", TZ_Africa_Ceuta},
+    {"Africa/Conakry", TZ_Africa_Conakry},
+    {"Africa/Dakar", TZ_Africa_Dakar},
+    {"Africa/Dar_es_Salaam", TZ_Africa_Dar_es_Salaam},
+    {"Africa/Djibouti", TZ_Africa_Djibouti},
+    {"Africa/Douala", TZ_Africa_Douala},
+    {"Africa/El_Aaiun", TZ_Africa_El_Aaiun},
+    {"Africa/Freetown", TZ_Africa_Freetown},
+    {"Africa/Gaborone", TZ_Africa_Gaborone},
+    {"Africa/Harare", TZ_Africa_Harare},
+    {"Africa/Johannesburg", TZ_Africa_Johannesburg},
+    {"Africa/Juba", TZ_Africa_Juba},
+    {"Africa/Kampala", TZ_Africa_Kampala},
+    {"Africa/Khartoum", TZ_Africa_Khartoum},
+    {"Africa/Kigali", TZ_Africa_Kigali},
+    {"Africa/Kinshasa", TZ_Africa_Kinshasa},
+    {"Africa/Lagos", TZ_Africa_Lagos},
+    {"Africa/Libreville", TZ_Africa_Libreville},
+    {"Africa/Lome", TZ_Africa_Lome},
+    {"Africa/Luanda", TZ_Africa_Luanda},
+    {"Africa/Lubumbashi", TZ_Africa_Lubumbashi},
+    {"Africa/Lusaka", TZ_Africa_Lusaka},
+    {"Africa/Malabo", TZ_Africa_Malabo},
+    {"Africa/Maputo", TZ_Africa_Maputo},
+    {"Africa/Maseru", TZ_Africa_Maseru},
+    {"Africa/Mbabane", TZ_Africa_Mbabane},
+    {"Africa/Mogadishu", TZ_Africa_Mogadishu},
+    {"Africa/Monrovia", TZ_Africa_Monrovia},
+    {"Africa/Nairobi", TZ_Africa_Nairobi},
+    {"Africa/Ndjamena", TZ_Africa_Ndjamena},
+    {"Africa/Niamey", TZ_Africa_Niamey},
+    {"Africa/Nouakchott", TZ_Africa_Nouakchott},
+    {"Africa/Ouagadougou", TZ_Africa_Ouagadougou},
+    {"Africa/PortomNovo", TZ_Africa_PortomNovo},
+    {"Africa/Sao_Tome", TZ_Africa_Sao_Tome},
+    {"Africa/Tripoli", TZ_Africa_Tripoli},
+    {"Africa/Tunis", TZ_Africa_Tunis},
+    {"Africa/Windhoek", TZ_Africa_Windhoek},
+    {"America/Adak", TZ_America_Adak},
+    {"America/Anchorage", TZ_America_Anchorage},
+    {"America/Anguilla", TZ_America_Anguilla},
+    {"America/Antigua", TZ_America_Antigua},
+    {"America/Araguaina", TZ_America_Araguaina},
+    {"America/Argentina/Buenos_Aires", TZ_America_Argentina_Buenos_Aires},
+    {"America/Argentina/Catamarca", TZ_America_Argentina_Catamarca},
+    {"America/Argentina/Cordoba", TZ_America_Argentina_Cordoba},
+    {"America/Argentina/Jujuy", TZ_America_Argentina_Jujuy},
+    {"America/Argentina/La_Rioja", TZ_America_Argentina_La_Rioja},
+    {"America/Argentina/Mendoza", TZ_America_Argentina_Mendoza},
+    {"America/Argentina/Rio_Gallegos", TZ_America_Argentina_Rio_Gallegos},
+    {"America/Argentina/Salta", TZ_America_Argentina_Salta},
+    {"America/Argentina/San_Juan", TZ_America_Argentina_San_Juan},
+    {"America/Argentina/San_Luis", TZ_America_Argentina_San_Luis},
+    {"America/Argentina/Tucuman", TZ_America_Argentina_Tucuman},
+    {"America/Argentina/Ushuaia", TZ_America_Argentina_Ushuaia},
+    {"America/Aruba", TZ_America_Aruba},
+    {"America/Asuncion", TZ_America_Asuncion},
+    {"America/Atikokan", TZ_America_Atikokan},
+    {"America/Bahia", TZ_America_Bahia},
+    {"America/Bahia_Banderas", TZ_America_Bahia_Banderas},
+    {"America/Barbados", TZ_America_Barbados},
+    {"America/Belem", TZ_America_Belem},
+    {"America/Belize", TZ_America_Belize},
+    {"America/Blanc-Sablon", TZ_America_BlancmSablon},
+    {"America/Boa_Vista", TZ_America_Boa_Vista},
+    {"America/Bogota", TZ_America_Bogota},
+    {"America/Boise", TZ_America_Boise},
+    {"America/Cambridge_Bay", TZ_America_Cambridge_Bay},
+    {"America/Campo_Grande", TZ_America_Campo_Grande},
+    {"America/Cancun", TZ_America_Cancun},
+    {"America/Caracas", TZ_America_Caracas},
+    {"America/Cayenne", TZ_America_Cayenne},
+    {"America/Cayman", TZ_America_Cayman},
+    {"America/Chicago", TZ_America_Chicago},
+    {"America/Chihuahua", TZ_America_Chihuahua},
+    {"America/Costa_Rica", TZ_America_Costa_Rica},
+    {"America/Creston", TZ_America_Creston},
+    {"America/Cuiaba", TZ_America_Cuiaba},
+    {"America/Curacao", TZ_America_Curacao},
+    {"America/Danmarkshavn", TZ_America_Danmarkshavn},
+    {"America/Dawson", TZ_America_Dawson},
+    {"America/Dawson_Creek", TZ_America_Dawson_Creek},
+    {"America/Denver", TZ_America_Denver},
+    {"America/Detroit", TZ_America_Detroit},
+    {"America/Dominica", TZ_America_Dominica},
+    {"America/Edmonton", TZ_America_Edmonton},
+    {"America/Eirunepe", TZ_America_Eirunepe},
+    {"America/El_Salvador", TZ_America_El_Salvador},
+    {"America/Fort_Nelson", TZ_America_Fort_Nelson},
+    {"America/Fortaleza", TZ_America_Fortaleza},
+    {"America/Glace_Bay", TZ_America_Glace_Bay},
+    {"America/Godthab", TZ_America_Godthab},
+    {"America/Goose_Bay", TZ_America_Goose_Bay},
+    {"America/Grand_Turk", TZ_America_Grand_Turk},
+    {"America/Grenada", TZ_America_Grenada},
+    {"America/Guadeloupe", TZ_America_Guadeloupe},
+    {"America/Guatemala", TZ_America_Guatemala},
+    {"America/Guayaquil", TZ_America_Guayaquil},
+    {"America/Guyana", TZ_America_Guyana},
+    {"America/Halifax", TZ_America_Halifax},
+    {"America/Havana", TZ_America_Havana},
+    {"America/Hermosillo", TZ_America_Hermosillo},
+    {"America/Indiana/Indianapolis", TZ_America_Indiana_Indianapolis},
+    {"America/Indiana/Knox", TZ_America_Indiana_Knox},
+    {"America/Indiana/Marengo", TZ_America_Indiana_Marengo},
+    {"America/Indiana/Petersburg", TZ_America_Indiana_Petersburg},
+    {"America/Indiana/Tell_City", TZ_America_Indiana_Tell_City},
+    {"America/Indiana/Vevay", TZ_America_Indiana_Vevay},
+    {"America/Indiana/Vincennes", TZ_America_Indiana_Vincennes},
+    {"America/Indiana/Winamac", TZ_America_Indiana_Winamac},
+    {"America/Inuvik", TZ_America_Inuvik},
+    {"America/Iqaluit", TZ_America_Iqaluit},
+    {"America/Jamaica", TZ_America_Jamaica},
+    {"America/Juneau", TZ_America_Juneau},
+    {"America/Kentucky/Louisville", TZ_America_Kentucky_Louisville},
+    {"America/Kentucky/Monticello", TZ_America_Kentucky_Monticello},
+    {"America/Kralendijk", TZ_America_Kralendijk},
+    {"America/La_Paz", TZ_America_La_Paz},
+    {"America/Lima", TZ_America_Lima},
+    {"America/Los_Angeles", TZ_America_Los_Angeles},
+    {"America/Lower_Princes", TZ_America_Lower_Princes},
+    {"America/Maceio", TZ_America_Maceio},
+    {"America/Managua", TZ_America_Managua},
+    {"America/Manaus", TZ_America_Manaus},
+    {"America/Marigot", TZ_America_Marigot},
+    {"America/Martinique", TZ_America_Martinique},
+    {"America/Matamoros", TZ_America_Matamoros},
+    {"America/Mazatlan", TZ_America_Mazatlan},
+    {"America/Menominee", TZ_America_Menominee},
+    {"America/Merida", TZ_America_Merida},
+    {"America/Metlakatla", TZ_America_Metlakatla},
+    {"America/Mexico_City", TZ_America_Mexico_City},
+    {"America/Miquelon", TZ_America_Miquelon},
+    {"America/Moncton", TZ_America_Moncton},
+    {"America/Monterrey", TZ_America_Monterrey},
+    {"America/Montevideo", TZ_America_Montevideo},
+    {"America/Montreal", TZ_America_Montreal},
+    {"America/Montserrat", TZ_America_Montserrat},
+    {"America/Nassau", TZ_America_Nassau},
+    {"America/New_York", TZ_America_New_York},
+    {"America/Nipigon", TZ_America_Nipigon},
+    {"America/Nome", TZ_America_Nome},
+    {"America/Noronha", TZ_America_Noronha},
+    {"America/North_Dakota/Beulah", TZ_America_North_Dakota_Beulah},
+    {"America/North_Dakota/Center", TZ_America_North_Dakota_Center},
+    {"America/North_Dakota/New_Salem", TZ_America_North_Dakota_New_Salem},
+    {"America/Ojinaga", TZ_America_Ojinaga},
+    {"America/Panama", TZ_America_Panama},
+    {"America/Pangnirtung", TZ_America_Pangnirtung},
+    {"America/Paramaribo", TZ_America_Paramaribo},
+    {"America/Phoenix", TZ_America_Phoenix},
+    {"America/Port-au-Prince", TZ_America_PortmaumPrince},
+    {"America/Port_of_Spain", TZ_America_Port_of_Spain},
+    {"America/Porto_Velho", TZ_America_Porto_Velho},
+    {"America/Puerto_Rico", TZ_America_Puerto_Rico},
+    {"America/Punta_Arenas", TZ_America_Punta_Arenas},
+    {"America/Rainy_River", TZ_America_Rainy_River},
+    {"America/Rankin_Inlet", TZ_America_Rankin_Inlet},
+    {"America/Recife", TZ_America_Recife},
+    {"America/Regina", TZ_America_Regina},
+    {"America/Resolute", TZ_America_Resolute},
+    {"America/Rio_Branco", TZ_America_Rio_Branco},
+    {"America/Santarem", TZ_America_Santarem},
+    {"America/Santiago", TZ_America_Santiago},
+    {"America/Santo_Domingo", TZ_America_Santo_Domingo},
+    {"America/Sao_Paulo", TZ_America_Sao_Paulo},
+    {"America/Scoresbysund", TZ_America_Scoresbysund},
+    {"America/Sitka", TZ_America_Sitka},
+    {"America/St_Barthelemy", TZ_America_St_Barthelemy},
+    {"America/St_Johns", TZ_America_St_Johns},
+    {"America/St_Kitts", TZ_America_St_Kitts},
+    {"America/St_Lucia", TZ_America_St_Lucia},
+    {"America/St_Thomas", TZ_America_St_Thomas},
+    {"America/St_Vincent", TZ_America_St_Vincent},
+    {"America/Swift_Current", TZ_America_Swift_Current},
+    {"America/Tegucigalpa", TZ_America_Tegucigalpa},
+    {"America/Thule", TZ_America_Thule},
+    {"America/Thunder_Bay", TZ_America_Thunder_Bay},
+    {"America/Tijuana", TZ_America_Tijuana},
+    {"America/Toronto", TZ_America_Toronto},
+    {"America/Tortola", TZ_America_Tortola},
+    {"America/Vancouver", TZ_America_Vancouver},
+    {"America/Whitehorse", TZ_America_Whitehorse},
+    {"America/Winnipeg", TZ_America_Winnipeg},
+    {"America/Yakutat", TZ_America_Yakutat},
+    {"America/Yellowknife", TZ_America_Yellowknife},
+    {"Antarctica/Casey", TZ_Antarctica_Casey},
+    {"Antarctica/Davis", TZ_Antarctica_Davis},
+    {"Antarctica/DumontDUrville", TZ_Antarctica_DumontDUrville},
+    {"Antarctica/Macquarie", TZ_Antarctica_Macquarie},
+    {"Antarctica/Mawson", TZ_Antarctica_Mawson},
+    {"Antarctica/McMurdo", TZ_Antarctica_McMurdo},
+    {"Antarctica/Palmer", TZ_Antarctica_Palmer},
+    {"Antarctica/Rothera", TZ_Antarctica_Rothera},
+    {"Antarctica/Syowa", TZ_Antarctica_Syowa},
+    {"Antarctica/Troll", TZ_Antarctica_Troll},
+    {"Antarctica/Vostok", TZ_Antarctica_Vostok},
+    {"Arctic/Longyearbyen", TZ_Arctic_Longyearbyen},
+    {"Asia/Aden", TZ_Asia_Aden},
+    {"Asia/Almaty", TZ_Asia_Almaty},
+    {"Asia/Amman", TZ_Asia_Amman},
+    {"Asia/Anadyr", TZ_Asia_Anadyr},
+    {"Asia/Aqtau", TZ_Asia_Aqtau},
+    {"Asia/Aqtobe", TZ_Asia_Aqtobe},
+    {"Asia/Ashgabat", TZ_Asia_Ashgabat},
+    {"Asia/Atyrau", TZ_Asia_Atyrau},
+    {"Asia/Baghdad", TZ_Asia_Baghdad},
+    {"Asia/Bahrain", TZ_Asia_Bahrain},
+    {"Asia/Baku", TZ_Asia_Baku},
+    {"Asia/Bangkok", TZ_Asia_Bangkok},
+    {"Asia/Barnaul", TZ_Asia_Barnaul},
+    {"Asia/Beirut", TZ_Asia_Beirut},
+    {"Asia/Bishkek", TZ_Asia_Bishkek},
+    {"Asia/Brunei", TZ_Asia_Brunei},
+    {"Asia/Chita", TZ_Asia_Chita},
+    {"Asia/Choibalsan", TZ_Asia_Choibalsan},
+    {"Asia/Colombo", TZ_Asia_Colombo},
+    {"Asia/Damascus", TZ_Asia_Damascus},
+    {"Asia/Dhaka", TZ_Asia_Dhaka},
+    {"Asia/Dili", TZ_Asia_Dili},
+    {"Asia/Dubai", TZ_Asia_Dubai},
+    {"Asia/Dushanbe", TZ_Asia_Dushanbe},
+    {"Asia/Famagusta", TZ_Asia_Famagusta},
+    {"Asia/Gaza", TZ_Asia_Gaza},
+    {"Asia/Hebron", TZ_Asia_Hebron},
+    {"Asia/Ho_Chi_Minh", TZ_Asia_Ho_Chi_Minh},
+    {"Asia/Hong_Kong", TZ_Asia_Hong_Kong},
+    {"Asia/Hovd", TZ_Asia_Hovd},
+    {"Asia/Irkutsk", TZ_Asia_Irkutsk},
+    {"Asia/Jakarta", TZ_Asia_Jakarta},
+    {"Asia/Jayapura", TZ_Asia_Jayapura},
+    {"Asia/Jerusalem", TZ_Asia_Jerusalem},
+    {"Asia/Kabul", TZ_Asia_Kabul},
+    {"Asia/Kamchatka", TZ_Asia_Kamchatka},
+    {"Asia/Karachi", TZ_Asia_Karachi},
+    {"Asia/Kathmandu", TZ_Asia_Kathmandu},
+    {"Asia/Khandyga", TZ_Asia_Khandyga},
+    {"Asia/Kolkata", TZ_Asia_Kolkata},
+    {"Asia/Krasnoyarsk", TZ_Asia_Krasnoyarsk},
+    {"Asia/Kuala_Lumpur", TZ_Asia_Kuala_Lumpur},
+    {"Asia/Kuching", TZ_Asia_Kuching},
+    {"Asia/Kuwait", TZ_Asia_Kuwait},
+    {"Asia/Macau", TZ_Asia_Macau},
+    {"Asia/Magadan", TZ_Asia_Magadan},
+    {"Asia/Makassar", TZ_Asia_Makassar},
+    {"Asia/Manila", TZ_Asia_Manila},
+    {"Asia/Muscat", TZ_Asia_Muscat},
+    {"Asia/Nicosia", TZ_Asia_Nicosia},
+    {"Asia/Novokuznetsk", TZ_Asia_Novokuznetsk},
+    {"Asia/Novosibirsk", TZ_Asia_Novosibirsk},
+    {"Asia/Omsk", TZ_Asia_Omsk},
+    {"Asia/Oral", TZ_Asia_Oral},
+    {"Asia/Phnom_Penh", TZ_Asia_Phnom_Penh},
+    {"Asia/Pontianak", TZ_Asia_Pontianak},
+    {"Asia/Pyongyang", TZ_Asia_Pyongyang},
+    {"Asia/Qatar", TZ_Asia_Qatar},
+    {"Asia/Qyzylorda", TZ_Asia_Qyzylorda},
+    {"Asia/Riyadh", TZ_Asia_Riyadh},
+    {"Asia/Sakhalin", TZ_Asia_Sakhalin},
+    {"Asia/Samarkand", TZ_Asia_Samarkand},
+    {"Asia/Seoul", TZ_Asia_Seoul},
+    {"Asia/Shanghai", TZ_Asia_Shanghai},
+    {"Asia/Singapore", TZ_Asia_Singapore},
+    {"Asia/Srednekolymsk", TZ_Asia_Srednekolymsk},
+    {"Asia/Taipei", TZ_Asia_Taipei},
+    {"Asia/Tashkent", TZ_Asia_Tashkent},
+    {"Asia/Tbilisi", TZ_Asia_Tbilisi},
+    {"Asia/Tehran", TZ_Asia_Tehran},
+    {"Asia/Thimphu", TZ_Asia_Thimphu},
+    {"Asia/Tokyo", TZ_Asia_Tokyo},
+    {"Asia/Tomsk", TZ_Asia_Tomsk},
+    {"Asia/Ulaanbaatar", TZ_Asia_Ulaanbaatar},
+    {"Asia/Urumqi", TZ_Asia_Urumqi},
+    {"Asia/Ust-Nera", TZ_Asia_UstmNera},
+    {"Asia/Vientiane", TZ_Asia_Vientiane},
+    {"Asia/Vladivostok", TZ_Asia_Vladivostok},
+    {"Asia/Yakutsk", TZ_Asia_Yakutsk},
+    {"Asia/Yangon", TZ_Asia_Yangon},
+    {"Asia/Yekaterinburg", TZ_Asia_Yekaterinburg},
+    {"Asia/Yerevan", TZ_Asia_Yerevan},
+    {"Atlantic/Azores", TZ_Atlantic_Azores},
+    {"Atlantic/Bermuda", TZ_Atlantic_Bermuda},
+    {"Atlantic/Canary", TZ_Atlantic_Canary},
+    {"Atlantic/Cape_Verde", TZ_Atlantic_Cape_Verde},
+    {"Atlantic/Faroe", TZ_Atlantic_Faroe},
+    {"Atlantic/Madeira", TZ_Atlantic_Madeira},
+    {"Atlantic/Reykjavik", TZ_Atlantic_Reykjavik},
+    {"Atlantic/South_Georgia", TZ_Atlantic_South_Georgia},
+    {"Atlantic/St_Helena", TZ_Atlantic_St_Helena},
+    {"Atlantic/Stanley", TZ_Atlantic_Stanley},
+    {"Australia/Adelaide", TZ_Australia_Adelaide},
+    {"Australia/Brisbane", TZ_Australia_Brisbane},
+    {"Australia/Broken_Hill", TZ_Australia_Broken_Hill},
+    {"Australia/Currie", TZ_Australia_Currie},
+    {"Australia/Darwin", TZ_Australia_Darwin},
+    {"Australia/Eucla", TZ_Australia_Eucla},
+    {"Australia/Hobart", TZ_Australia_Hobart},
+    {"Australia/Lindeman", TZ_Australia_Lindeman},
+    {"Australia/Lord_Howe", TZ_Australia_Lord_Howe},
+    {"Australia/Melbourne", TZ_Australia_Melbourne},
+    {"Australia/Perth", TZ_Australia_Perth},
+    {"Australia/Sydney", TZ_Australia_Sydney},
+    {"Etc/GMT", TZ_Etc_GMT},
+    {"Etc/GMT+0", TZ_Etc_GMTp0},
+    {"Etc/GMT+1", TZ_Etc_GMTp1},
+    {"Etc/GMT+10", TZ_Etc_GMTp10},
+    {"Etc/GMT+11", TZ_Etc_GMTp11},
+    {"Etc/GMT+12", TZ_Etc_GMTp12},
+    {"Etc/GMT+2", TZ_Etc_GMTp2},
+    {"Etc/GMT+3", TZ_Etc_GMTp3},
+    {"Etc/GMT+4", TZ_Etc_GMTp4},
+    {"Etc/GMT+5", TZ_Etc_GMTp5},
+    {"Etc/GMT+6", TZ_Etc_GMTp6},
+    {"Etc/GMT+7", TZ_Etc_GMTp7},
+    {"Etc/GMT+8", TZ_Etc_GMTp8},
+    {"Etc/GMT+9", TZ_Etc_GMTp9},
+    {"Etc/GMT-0", TZ_Etc_GMTm0},
+    {"Etc/GMT-1", TZ_Etc_GMTm1},
+    {"Etc/GMT-10", TZ_Etc_GMTm10},
+    {"Etc/GMT-11", TZ_Etc_GMTm11},
+    {"Etc/GMT-12", TZ_Etc_GMTm12},
+    {"Etc/GMT-13", TZ_Etc_GMTm13},
+    {"Etc/GMT-14", TZ_Etc_GMTm14},
+    {"Etc/GMT-2", TZ_Etc_GMTm2},
+    {"Etc/GMT-3", TZ_Etc_GMTm3},
+    {"Etc/GMT-4", TZ_Etc_GMTm4},
+    {"Etc/GMT-5", TZ_Etc_GMTm5},
+    {"Etc/GMT-6", TZ_Etc_GMTm6},
+    {"Etc/GMT-7", TZ_Etc_GMTm7},
+    {"Etc/GMT-8", TZ_Etc_GMTm8},
+    {"Etc/GMT-9", TZ_Etc_GMTm9},
+    {"Etc/GMT0", TZ_Etc_GMT0},
+    {"Etc/Greenwich", TZ_Etc_Greenwich},
+    {"Etc/UCT", TZ_Etc_UCT},
+    {"Etc/UTC", TZ_Etc_UTC},
+    {"Etc/Universal", TZ_Etc_Universal},
+    {"Etc/Zulu", TZ_Etc_Zulu},
+    {"Europe/Amsterdam", TZ_Europe_Amsterdam},
+    {"Europe/Andorra", TZ_Europe_Andorra},
+    {"Europe/Astrakhan", TZ_Europe_Astrakhan},
+    {"Europe/Athens", TZ_Europe_Athens},
+    {"Europe/Belgrade", TZ_Europe_Belgrade},
+    {"Europe/Berlin", TZ_Europe_Berlin},
+    {"Europe/Bratislava", TZ_Europe_Bratislava},
+    {"Europe/Brussels", TZ_Europe_Brussels},
+    {"Europe/Bucharest", TZ_Europe_Bucharest},
+    {"Europe/Budapest", TZ_Europe_Budapest},
+    {"Europe/Busingen", TZ_Europe_Busingen},
+    {"Europe/Chisinau", TZ_Europe_Chisinau},
+    {"Europe/Copenhagen", TZ_Europe_Copenhagen},
+    {"Europe/Dublin", TZ_Europe_Dublin},
+    {"Europe/Gibraltar", TZ_Europe_Gibraltar},
+    {"Europe/Guernsey", TZ_Europe_Guernsey},
+    {"Europe/Helsinki", TZ_Europe_Helsinki},
+    {"Europe/Isle_of_Man", TZ_Europe_Isle_of_Man},
+    {"Europe/Istanbul", TZ_Europe_Istanbul},
+    {"Europe/Jersey", TZ_Europe_Jersey},
+    {"Europe/Kaliningrad", TZ_Europe_Kaliningrad},
+    {"Europe/Kiev", TZ_Europe_Kiev},
+    {"Europe/Kirov", TZ_Europe_Kirov},
+    {"Europe/Lisbon", TZ_Europe_Lisbon},
+    {"Europe/Ljubljana", TZ_Europe_Ljubljana},
+    {"Europe/London", TZ_Europe_London},
+    {"Europe/Luxembourg", TZ_Europe_Luxembourg},
+    {"Europe/Madrid", TZ_Europe_Madrid},
+    {"Europe/Malta", TZ_Europe_Malta},
+    {"Europe/Mariehamn", TZ_Europe_Mariehamn},
+    {"Europe/Minsk", TZ_Europe_Minsk},
+    {"Europe/Monaco", TZ_Europe_Monaco},
+    {"Europe/Moscow", TZ_Europe_Moscow},
+    {"Europe/Oslo", TZ_Europe_Oslo},
+    {"Europe/Paris", TZ_Europe_Paris},
+    {"Europe/Podgorica", TZ_Europe_Podgorica},
+    {"Europe/Prague", TZ_Europe_Prague},
+    {"Europe/Riga", TZ_Europe_Riga},
+    {"Europe/Rome", TZ_Europe_Rome},
+    {"Europe/Samara", TZ_Europe_Samara},
+    {"Europe/San_Marino", TZ_Europe_San_Marino},
+    {"Europe/Sarajevo", TZ_Europe_Sarajevo},
+    {"Europe/Saratov", TZ_Europe_Saratov},
+    {"Europe/Simferopol", TZ_Europe_Simferopol},
+    {"Europe/Skopje", TZ_Europe_Skopje},
+    {"Europe/Sofia", TZ_Europe_Sofia},
+    {"Europe/Stockholm", TZ_Europe_Stockholm},
+    {"Europe/Tallinn", TZ_Europe_Tallinn},
+    {"Europe/Tirane", TZ_Europe_Tirane},
+    {"Europe/Ulyanovsk", TZ_Europe_Ulyanovsk},
+    {"Europe/Uzhgorod", TZ_Europe_Uzhgorod},
+    {"Europe/Vaduz", TZ_Europe_Vaduz},
+    {"Europe/Vatican", TZ_Europe_Vatican},
+    {"Europe/Vienna", TZ_Europe_Vienna},
+    {"Europe/Vilnius", TZ_Europe_Vilnius},
+    {"Europe/Volgograd", TZ_Europe_Volgograd},
+    {"Europe/Warsaw", TZ_Europe_Warsaw},
+    {"Europe/Zagreb", TZ_Europe_Zagreb},
+    {"Europe/Zaporozhye", TZ_Europe_Zaporozhye},
+    {"Europe/Zurich", TZ_Europe_Zurich},
+    {"Indian/Antananarivo", TZ_Indian_Antananarivo},
+    {"Indian/Chagos", TZ_Indian_Chagos},
+    {"Indian/Christmas", TZ_Indian_Christmas},
+    {"Indian/Cocos", TZ_Indian_Cocos},
+    {"Indian/Comoro", TZ_Indian_Comoro},
+    {"Indian/Kerguelen", TZ_Indian_Kerguelen},
+    {"Indian/Mahe", TZ_Indian_Mahe},
+    {"Indian/Maldives", TZ_Indian_Maldives},
+    {"Indian/Mauritius", TZ_Indian_Mauritius},
+    {"Indian/Mayotte", TZ_Indian_Mayotte},
+    {"Indian/Reunion", TZ_Indian_Reunion},
+    {"Pacific/Apia", TZ_Pacific_Apia},
+    {"Pacific/Auckland", TZ_Pacific_Auckland},
+    {"Pacific/Bougainville", TZ_Pacific_Bougainville},
+    {"Pacific/Chatham", TZ_Pacific_Chatham},
+    {"Pacific/Chuuk", TZ_Pacific_Chuuk},
+    {"Pacific/Easter", TZ_Pacific_Easter},
+    {"Pacific/Efate", TZ_Pacific_Efate},
+    {"Pacific/Enderbury", TZ_Pacific_Enderbury},
+    {"Pacific/Fakaofo", TZ_Pacific_Fakaofo},
+    {"Pacific/Fiji", TZ_Pacific_Fiji},
+    {"Pacific/Funafuti", TZ_Pacific_Funafuti},
+    {"Pacific/Galapagos", TZ_Pacific_Galapagos},
+    {"Pacific/Gambier", TZ_Pacific_Gambier},
+    {"Pacific/Guadalcanal", TZ_Pacific_Guadalcanal},
+    {"Pacific/Guam", TZ_Pacific_Guam},
+    {"Pacific/Honolulu", TZ_Pacific_Honolulu},
+    {"Pacific/Kiritimati", TZ_Pacific_Kiritimati},
+    {"Pacific/Kosrae", TZ_Pacific_Kosrae},
+    {"Pacific/Kwajalein", TZ_Pacific_Kwajalein},
+    {"Pacific/Majuro", TZ_Pacific_Majuro},
+    {"Pacific/Marquesas", TZ_Pacific_Marquesas},
+    {"Pacific/Midway", TZ_Pacific_Midway},
+    {"Pacific/Nauru", TZ_Pacific_Nauru},
+    {"Pacific/Niue", TZ_Pacific_Niue},
+    {"Pacific/Norfolk", TZ_Pacific_Norfolk},
+    {"Pacific/Noumea", TZ_Pacific_Noumea},
+    {"Pacific/Pago_Pago", TZ_Pacific_Pago_Pago},
+    {"Pacific/Palau", TZ_Pacific_Palau},
+    {"Pacific/Pitcairn", TZ_Pacific_Pitcairn},
+    {"Pacific/Pohnpei", TZ_Pacific_Pohnpei},
+    {"Pacific/Port_Moresby", TZ_Pacific_Port_Moresby},
+    {"Pacific/Rarotonga", TZ_Pacific_Rarotonga},
+    {"Pacific/Saipan", TZ_Pacific_Saipan},
+    {"Pacific/Tahiti", TZ_Pacific_Tahiti},
+    {"Pacific/Tarawa", TZ_Pacific_Tarawa},
+    {"Pacific/Tongatapu", TZ_Pacific_Tongatapu},
+    {"Pacific/Wake", TZ_Pacific_Wake},
+    {"Pacific/Wallis", TZ_Pacific_Wallis},
+};
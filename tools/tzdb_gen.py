@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Generate the compact time zone database from src/DateTimeTZ.h.
+
+Writes src/TimeZoneDBData.h (PROGMEM rule pool, name pool and sorted index
+used by TimeZoneDB::lookupZone) and test/test_time_zone_db/tz_macros.h
+(IANA name to TZ_* macro pairs used to check the database).
+
+Usage: python3 tools/tzdb_gen.py
+"""
+
+import os
+import re
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "src", "DateTimeTZ.h")
+OUTPUT = os.path.join(ROOT, "src", "TimeZoneDBData.h")
+TEST_OUTPUT = os.path.join(ROOT, "test", "test_time_zone_db", "tz_macros.h")
+
+# zones with one more path level, America/Argentina/Buenos_Aires
+SUB_REGIONS = ("Argentina", "Indiana", "Kentucky", "North_Dakota")
+# TZupdate.sh maps '-' to 'm' and '+' to 'p', restore the known names
+SPECIAL_NAMES = {
+    "America_BlancmSablon": "America/Blanc-Sablon",
+    "America_PortmaumPrince": "America/Port-au-Prince",
+    "Asia_UstmNera": "Asia/Ust-Nera",
+}
+
+MACRO = re.compile(r'^#define\s+TZ_(\w+)\s+PSTR\("([^"]*)"\)')
+
+
+def zone_name(macro):
+    if macro in SPECIAL_NAMES:
+        return SPECIAL_NAMES[macro]
+    m = re.match(r"^Etc_GMT([mp])(\d+)$", macro)
+    if m:
+        return "Etc/GMT%s%s" % ("-" if m.group(1) == "m" else "+", m.group(2))
+    region, _, rest = macro.partition("_")
+    if not rest:
+        return region
+    for sub in SUB_REGIONS:
+        if region == "America" and rest.startswith(sub + "_"):
+            return "%s/%s/%s" % (region, sub, rest[len(sub) + 1:])
+    return "%s/%s" % (region, rest)
+
+
+def c_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '\\0"'
+
+
+def main():
+    zones = []
+    with open(SOURCE) as f:
+        for line in f:
+            m = MACRO.match(line)
+            if m:
+                zones.append((zone_name(m.group(1)), m.group(1), m.group(2)))
+    zones.sort(key=lambda z: z[0].encode())
+    names = [z[0] for z in zones]
+    assert len(set(names)) == len(names), "duplicate zone names"
+
+    rules = []
+    rule_offsets = {}
+    offset = 0
+    for _, _, rule in zones:
+        if rule not in rule_offsets:
+            rule_offsets[rule] = offset
+            rules.append(rule)
+            offset += len(rule) + 1
+    rule_pool_size = offset
+
+    name_offsets = []
+    offset = 0
+    for name in names:
+        name_offsets.append(offset)
+        offset += len(name) + 1
+    name_pool_size = offset
+    assert name_pool_size < 65536 and rule_pool_size < 65536
+
+    out = []
+    out.append("// autogenerated by tools/tzdb_gen.py from src/DateTimeTZ.h")
+    out.append("// do not edit, run python3 tools/tzdb_gen.py instead")
+    out.append("")
+    out.append("#ifndef ESP_DATE_TIME_TIME_ZONE_DB_DATA_H")
+    out.append("#define ESP_DATE_TIME_TIME_ZONE_DB_DATA_H")
+    out.append("")
+    out.append("// %d zones, %d unique rules" % (len(zones), len(rules)))
+    out.append("#define TZDB_ZONE_COUNT %d" % len(zones))
+    out.append("")
+    out.append("static const char TZDB_RULES[] PROGMEM =")
+    for rule in rules:
+        out.append("    %s" % c_string(rule))
+    out[-1] += ";"
+    out.append("")
+    out.append("static const char TZDB_NAMES[] PROGMEM =")
+    for name in names:
+        out.append("    %s" % c_string(name))
+    out[-1] += ";"
+    out.append("")
+    out.append("// {name offset, rule offset}, sorted by name")
+    out.append("static const uint16_t TZDB_INDEX[TZDB_ZONE_COUNT][2] PROGMEM = {")
+    for (name, _, rule), name_offset in zip(zones, name_offsets):
+        out.append("    {%d, %d},  // %s" % (name_offset, rule_offsets[rule], name))
+    out.append("};")
+    out.append("")
+    out.append("#endif")
+    with open(OUTPUT, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+    test = []
+    test.append("// autogenerated by tools/tzdb_gen.py from src/DateTimeTZ.h")
+    test.append("")
+    test.append("#include <DateTimeTZ.h>")
+    test.append("")
+    test.append("static const char* const TZ_MACROS[][2] = {")
+    for name, macro, _ in zones:
+        test.append('    {"%s", TZ_%s},' % (name, macro))
+    test.append("};")
+    os.makedirs(os.path.dirname(TEST_OUTPUT), exist_ok=True)
+    with open(TEST_OUTPUT, "w") as f:
+        f.write("\n".join(test) + "\n")
+    print("%d zones, %d unique rules, %d + %d + %d bytes" %
+          (len(zones), len(rules), rule_pool_size, name_pool_size,
+           len(zones) * 4))
+
+
+if __name__ == "__main__":
+    main()